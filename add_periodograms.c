@@ -7,48 +7,79 @@
 
 // User defined libraries
 #include "equalstrings.h"
+#include "periodogram.h"
 
 #define TRUE 1
 #define FALSE 0
 
-#define HEADER_SIZE 13
+// combination modes
+#define COMBINE_SUM 1
+#define COMBINE_MAX 2
+#define COMBINE_MEAN 3
 
-// Program to interpolate and add GNUPLOT format periodograms generated by FFANCY
+// longest file name accepted from a -list file
+#define LIST_LINE_SIZE 4096
+
+// Program to interpolate and combine any number of periodograms generated by FFANCY
 // Written by Andrew Cameron
-// Version 0.2 - Last updated 11/09/2016
+// Version 0.3 - Last updated 19/10/2026
 
 /*
 
 CHANGELOG:
 - v0.2 - Updated the help menu for publication
+- v0.3 - Combines any number of periodograms (text or binary, see periodogram.h) in a single streaming pass, keeping only two rows of each input in memory
+       - Added -f (repeatable) and -list to name the inputs (-f1 and -f2 still work), -mode to choose between sum, max and weighted mean, -w to weight an input,
+         and -binary to write a binary periodogram
+       - Output periodograms now start with the standard header, and take their downsampling columns from the inputs rather than writing zeroes
+       - Interpolated values are counted and reported once at the end, rather than announced for every row
 
 */
 
+// ***** DATA TYPES *****
+
+// one input periodogram, read one row at a time
+// prev and current are the last two rows read - the combiner only ever needs to interpolate between them
+typedef struct periodogramCursor {
+  FILE* file;
+  char* name;
+  int format;
+  double weight;
+  long rowsread; // prev only holds a row once two have been read
+  int finished; // TRUE once the end of the file has been reached
+  periodogramRow prev;
+  periodogramRow current;
+} periodogramCursor;
+
 // ***** FUNCTION PROTOTYPES *****
 
 // prints out an explanation of how to use the command line interface
 void help();
 
-// strips the header from a file
-void header_strip(FILE* file);
+// adds an input periodogram to the end of the cursor list, growing it if needed, and returns the new input count
+int add_input(periodogramCursor** cursors, int* capacity, int inputs, char* name);
 
-// copies the header from one file into another file
-void header_copy(FILE *infile, FILE *outfile);
+// adds every file named (one per line) in a list file as an input, and returns the new input count
+int add_input_list(periodogramCursor** cursors, int* capacity, int inputs, char* listname);
 
-// determines the number of data-containing lines in a file
-int data_lines(FILE *file);
+// moves a cursor on by one row, keeping the row it was on as prev
+void advance_cursor(periodogramCursor* cursor);
 
-// reads a file into the sample and data arrays
-void array_reader(FILE *file, double *sample_array, double *data_array, int size);
+// returns the value of a cursor's periodogram at the given period, which must lie in [prev.period, current.period]
+// counts the value as interpolated if it does not fall exactly on a row
+double cursor_value(periodogramCursor* cursor, double period, long* interpolated);
 
 // ***** MAIN FUNCTION *****
 
 int main(int argc, char** argv) {
 
   // declare variables and initialise with defaults
-  FILE *inputfile1 = NULL;
-  FILE *inputfile2 = NULL;
   FILE *outputfile = NULL;
+  periodogramCursor* cursors = NULL;
+  int capacity = 0;
+  int inputs = 0;
+  int mode = COMBINE_SUM;
+  int output_format = PERIODOGRAM_TEXT;
 
   int ii; // counter
 
@@ -62,12 +93,24 @@ int main(int argc, char** argv) {
   if (argc > 1) {
     ii=1;
     while (ii < argc) {
-      if (equal_strings(argv[ii],"-f1")) {
+      if (equal_strings(argv[ii],"-f") || equal_strings(argv[ii],"-f1") || equal_strings(argv[ii],"-f2")) {
+	ii++;
+	inputs = add_input(&cursors, &capacity, inputs, argv[ii]);
+      } else if (equal_strings(argv[ii],"-list")) {
 	ii++;
-        inputfile1 = fopen(argv[ii], "r");
-      } else if (equal_strings(argv[ii],"-f2")) {
+	inputs = add_input_list(&cursors, &capacity, inputs, argv[ii]);
+      } else if (equal_strings(argv[ii],"-w")) {
 	ii++;
-	inputfile2 = fopen(argv[ii], "r");
+	if (inputs == 0) {
+	  printf("-w must follow the input it weights.\n");
+	  exit(0);
+	}
+	cursors[inputs - 1].weight = atof(argv[ii]);
+      } else if (equal_strings(argv[ii],"-mode")) {
+	ii++;
+	mode = atoi(argv[ii]);
+      } else if (equal_strings(argv[ii],"-binary")) {
+	output_format = PERIODOGRAM_BINARY;
       } else if (equal_strings(argv[ii],"-o")) {
 	ii++;
 	outputfile = fopen(argv[ii], "w+");
@@ -83,236 +126,243 @@ int main(int argc, char** argv) {
   }
 
   // test for valid input
-  assert(inputfile1 != NULL);
-  assert(inputfile2 != NULL);
   assert(outputfile != NULL);
+  if (inputs < 2) {
+    printf("At least two input periodograms are required!\n");
+    exit(0);
+  }
+  if (mode != COMBINE_SUM && mode != COMBINE_MAX && mode != COMBINE_MEAN) {
+    printf("Invalid combination mode!\n");
+    exit(0);
+  }
 
-  // get size of the two input files
-  int file1_size = data_lines(inputfile1);
-  int file2_size = data_lines(inputfile2);
-  printf("Size of file 1 is %d lines | Size of file 2 is %d lines.\n", file1_size, file2_size);
-
-  // allocate sample and data arrays
-  double* sample_array1 = (double*)malloc(sizeof(double) * file1_size);
-  double* data_array1 = (double*)malloc(sizeof(double) * file1_size);
-
-  double* sample_array2 = (double*)malloc(sizeof(double) * file2_size);
-  double* data_array2 = (double*)malloc(sizeof(double) * file2_size);
-  printf("Arrays allocated.\n");
-
-  // read into the arrays
-  array_reader(inputfile1, sample_array1, data_array1, file1_size);
-  array_reader(inputfile2, sample_array2, data_array2, file2_size);
-  printf("Arrays initialised with values.\n");
-
-  // copy the header of one file into the output file
-  // header_copy(inputfile1, outputfile);
-  // printf("Header copied to output file.\n");
-
-  // PREPARATION COMPLETE
-  // can now close out the input files
-  fclose(inputfile1);
-  fclose(inputfile2);
-
-  // Now comes the main body of the program, scrolling through both array pairs and interpolating as needed, then writing out to the final file
-  // set starting counters for both array sets
-  int counter1 = 0;
-  int counter2 = 0;
-
-  // determine which array has the earlier starting period, and scroll it forward until it is equal to or greater than the starting period of the other
-  printf("Winding arrays into position for addition...\n");
-
-  if (sample_array1[counter1] < sample_array2[counter2]) {
-    // wind counter1 forward
-    while(sample_array1[counter1] < sample_array2[counter2]) {
-      counter1++;
+  double weightsum = 0;
+  for (ii = 0; ii < inputs; ii++) {
+    weightsum = weightsum + cursors[ii].weight;
+  }
+  if ((mode == COMBINE_MEAN) && (weightsum <= 0)) {
+    printf("Weights must sum to more than zero for a weighted mean!\n");
+    exit(0);
+  }
+
+  // read the header and first row of every input
+  // the periodograms only overlap from the latest of their first periods onwards
+  double start = -HUGE_VAL;
+  for (ii = 0; ii < inputs; ii++) {
+    cursors[ii].format = readPeriodogramHeader(cursors[ii].file);
+    advance_cursor(&cursors[ii]);
+    if (cursors[ii].finished == TRUE) {
+      printf("ERROR: %s contains no periodogram rows.\n", cursors[ii].name);
+      exit(EXIT_FAILURE);
     }
-  } else if (sample_array1[counter1] > sample_array2[counter2]) {
-    // wind counter 2 forward
-    while(sample_array1[counter1] > sample_array2[counter2]) {
-      counter2++;
+    if (cursors[ii].current.period > start) {
+      start = cursors[ii].current.period;
     }
   }
+  printf("%d periodograms opened.\n", inputs);
 
+  // wind every input forward until it reaches the common region
+  printf("Winding periodograms into position for addition...\n");
+  for (ii = 0; ii < inputs; ii++) {
+    while ((cursors[ii].finished == FALSE) && (cursors[ii].current.period < start)) {
+      advance_cursor(&cursors[ii]);
+    }
+  }
   printf("Initial winding complete.\n");
 
-  // we have now reached a region which is common to both periodograms
-  // begin the addition algorithm
-  while ((counter1 < file1_size) && (counter2 < file2_size)) {
-  
-      if (sample_array1[counter1] == sample_array2[counter2]) {
-
-	// the easy case - just add and write out
-	fprintf(outputfile, "%.10lf 0 0 %.10lf\n", sample_array1[counter1], data_array1[counter1] + data_array2[counter2]);
-	counter1++;
-	counter2++;
-	
-      } else if (sample_array1[counter1] < sample_array2[counter2]) {
-
-	// need to interpolate a value in array 2 to add to the array 1 value
-	// accessing invalid earlier data should be elliminated by the earlier winding procedure
-
-	printf("Interpolating elements in second file...\n");
+  writePeriodogramHeader(outputfile, output_format);
 
-	double interpolated_value = ((data_array2[counter2] - data_array2[counter2-1])/(sample_array2[counter2] - sample_array2[counter2-1]))*(sample_array1[counter1] - sample_array2[counter2 - 1]) + data_array2[counter2-1];
+  // k-way merge - every trial period of every input is written out once, using the inputs that land exactly on it and interpolating the rest
+  // inputs sharing the same trial periods never need interpolating, and are combined row by row whatever order their rows are in
+  long rows = 0;
+  long interpolated = 0;
+  int running = TRUE;
 
-	// write out to file
-	fprintf(outputfile, "%.10lf 0 0 %.10lf\n", sample_array1[counter1], interpolated_value + data_array1[counter1]);
+  while (running == TRUE) {
 
-	// increment counter 1 only
-	counter1++;
-	
-      } else if (sample_array1[counter1] > sample_array2[counter2]) {
-	
-	// need to interpolate a value in array 1 to add to the array 2 value
-	// accessing invalid earlier data should be elliminated by the earlier winding procedure
-
-	printf("Interpolating elements in first file...\n");
+    // the next period to write is the lowest current period, and stops at the end of the first input to finish
+    periodogramCursor* lowest = NULL;
+    for (ii = 0; ii < inputs; ii++) {
+      if (cursors[ii].finished == TRUE) {
+	running = FALSE;
+	break;
+      }
+      if ((lowest == NULL) || (cursors[ii].current.period < lowest->current.period)) {
+	lowest = &cursors[ii];
+      }
+    }
+    if (running == FALSE) {
+      break;
+    }
 
-	double interpolated_value = ((data_array1[counter1] - data_array1[counter1-1])/(sample_array1[counter1] - sample_array1[counter1-1]))*(sample_array2[counter2] - sample_array1[counter1 - 1]) + data_array1[counter1-1];
+    double period = lowest->current.period;
+    double combined = 0;
+
+    for (ii = 0; ii < inputs; ii++) {
+      double value = cursor_value(&cursors[ii], period, &interpolated);
+      if (mode == COMBINE_SUM) {
+	combined = combined + value;
+      } else if (mode == COMBINE_MEAN) {
+	combined = combined + cursors[ii].weight*value;
+      } else if ((ii == 0) || (value > combined)) {
+	combined = value;
+      }
+    }
+    if (mode == COMBINE_MEAN) {
+      combined = combined/weightsum;
+    }
 
-	// write out to file
-	fprintf(outputfile, "%.10lf 0 0 %.10lf\n", sample_array2[counter2], interpolated_value + data_array2[counter2]);
+    // downsampling columns come from the input that set this period
+    periodogramRow row = lowest->current;
+    row.metric = combined;
+    writePeriodogramRow(outputfile, output_format, &row);
+    rows++;
 
-	// increment counter 2 only
-	counter2++;
-	
+    // move on every input that has now been written up to
+    for (ii = 0; ii < inputs; ii++) {
+      if (cursors[ii].current.period == period) {
+	advance_cursor(&cursors[ii]);
       }
+    }
   }
 
-  printf("Addition complete.\n");
+  printf("Combination complete - %ld rows written, %ld values interpolated.\n", rows, interpolated);
 
-  // close the output file
+  // close the files and free allocated memory
   fclose(outputfile);
-
-  // free allocated memory
-  free(sample_array1);
-  free(data_array1);
-
-  free(sample_array2);
-  free(data_array2);
+  for (ii = 0; ii < inputs; ii++) {
+    fclose(cursors[ii].file);
+    free(cursors[ii].name);
+  }
+  free(cursors);
 
   // program complete
-  
+
   return 0;
-  
+
 }
 
 // ***** FUNCTION BODIES *****
 
-void header_strip(FILE* file) {
+int add_input(periodogramCursor** cursors, int* capacity, int inputs, char* name) {
 
-  assert(file != NULL);
-  
-  // assumes a standard header size as defined by a constant
+  assert(cursors != NULL);
+  assert(capacity != NULL);
+  assert(name != NULL);
 
-  int ii = 0;
-  char buffer[100];
-  while (ii < HEADER_SIZE) {
-    fscanf(file, "%s", buffer);
-    ii++;
+  if (inputs == *capacity) {
+    *capacity = (*capacity == 0) ? 16 : 2*(*capacity);
+    *cursors = (periodogramCursor*)realloc(*cursors, sizeof(periodogramCursor)*(*capacity));
+    assert(*cursors != NULL);
   }
-  
-  return;
-  
-}
 
-int data_lines(FILE *file) {
+  periodogramCursor* cursor = &(*cursors)[inputs];
+  cursor->file = fopen(name, "rb");
+  if (cursor->file == NULL) {
+    printf("ERROR: Unable to open input periodogram %s.\n", name);
+    exit(EXIT_FAILURE);
+  }
+  cursor->name = strdup(name);
+  cursor->format = PERIODOGRAM_TEXT;
+  cursor->weight = 1.0;
+  cursor->rowsread = 0;
+  cursor->finished = FALSE;
 
-  assert(file != NULL);
+  return inputs + 1;
 
-  // go to start of file
-  rewind(file);
+}
+
+int add_input_list(periodogramCursor** cursors, int* capacity, int inputs, char* listname) {
 
-  // strip header
-  header_strip(file);
+  assert(listname != NULL);
 
-  // loop through lines and increment
-  int ii = 0;
-  double samples;
-  int ds_factor;
-  double ds_samples;
-  double snr;
-  while (fscanf(file, "%lf %d %lf %lf", &samples, &ds_factor, &ds_samples, &snr) != EOF) {
-    // do nothing but increment
-    ii++;
+  FILE* listfile = fopen(listname, "r");
+  if (listfile == NULL) {
+    printf("ERROR: Unable to open input list %s.\n", listname);
+    exit(EXIT_FAILURE);
   }
 
-  // reset file
-  rewind(file);
-  
-  return ii;
-  
-}
+  char line[LIST_LINE_SIZE];
+  while (fgets(line, LIST_LINE_SIZE, listfile) != NULL) {
+    // strip the line ending and skip blank lines
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0] != '\0') {
+      inputs = add_input(cursors, capacity, inputs, line);
+    }
+  }
 
-void header_copy(FILE *infile, FILE *outfile) {
+  fclose(listfile);
 
-  assert(infile != NULL);
-  assert(outfile != NULL);
+  return inputs;
 
-  // assumes a standard header size as defined by a constant
+}
+
+void advance_cursor(periodogramCursor* cursor) {
 
-  // rewind the infile
-  rewind(infile);
+  assert(cursor != NULL);
+
+  if (cursor->finished == TRUE) {
+    return;
+  }
 
-  int ii = 0;
-  char buffer[100];
-  while (ii < HEADER_SIZE) {
-    fscanf(infile, "%s", buffer);
-    fprintf(outfile, "%s ", buffer);
-    ii++;
+  periodogramRow next;
+  if (readPeriodogramRow(cursor->file, cursor->format, &next) != TRUE) {
+    cursor->finished = TRUE;
+    return;
   }
 
-  // tidy up
-  fprintf (outfile, "\n");
-  
+  cursor->prev = cursor->current;
+  cursor->current = next;
+  cursor->rowsread++;
+
   return;
-  
+
 }
 
-void array_reader(FILE *file, double *sample_array, double *data_array, int size) {
-
-  assert(file != NULL);
-  assert(sample_array != NULL);
-  assert(data_array != NULL);
-
-  // go to start of file
-  rewind(file);
-
-  // strip header
-  header_strip(file);
-
-  // loop through lines and increment
-  int ii = 0;
-  double samples;
-  int ds_factor;
-  double ds_samples;
-  double snr;
-  while ((fscanf(file, "%lf %d %lf %lf", &samples, &ds_factor, &ds_samples, &snr) != EOF) && (ii < size)) {
-    // seed arrays
-    sample_array[ii] = samples;
-    data_array[ii] = snr;
-    ii++;
+double cursor_value(periodogramCursor* cursor, double period, long* interpolated) {
+
+  assert(cursor != NULL);
+
+  if (cursor->current.period == period) {
+    return cursor->current.metric;
   }
-  
-  return;
-  
+
+  // between prev and current - accessing rows before the common region should be eliminated by the initial winding
+  if ((cursor->rowsread < 2) || (cursor->prev.period > period)) {
+    printf("ERROR: Trial periods of %s are out of order near %.10f - inputs with different trial periods must be sorted by period.\n", cursor->name, period);
+    exit(EXIT_FAILURE);
+  }
+
+  (*interpolated)++;
+
+  return ((cursor->current.metric - cursor->prev.metric)/(cursor->current.period - cursor->prev.period))*(period - cursor->prev.period) + cursor->prev.metric;
+
 }
 
 void help() {
 
-  printf("\nADD_PERIODOGRAMS - Adds two GNUPLOT format periodograms as produced by FFAncy.\n");
-  printf("Version 0.1, last updated 24/03/2016.\n");
+  printf("\nADD_PERIODOGRAMS - Combines periodograms as produced by FFAncy.\n");
+  printf("Version 0.3, last updated 19/10/2026.\n");
   printf("Written by Andrew Cameron, MPIFR IMPRS PhD Student.\n");
-  printf("\nProgram will only add two periodograms together over their region of common overlap in sample space.\n");
-  printf("In the event that trial period values do not precisely coincide, different sets of period trials are\nadded together by interpolating between values in a given periodogram.\n");
+  printf("\nProgram will only combine periodograms over their region of common overlap in sample space.\n");
+  printf("In the event that trial period values do not precisely coincide, different sets of period trials are\ncombined by interpolating between values in a given periodogram (such inputs must be sorted by period).\n");
+  printf("Inputs are streamed, so any number of periodograms may be combined in constant memory.\n");
   printf("\n*****\n\n");
   printf("Input options:\n");
 
   printf("\n----- File Input/Output -----\n");
-  printf("-f1 [file]     Name of the first file to be added together.\n");
-  printf("-f2 [file]     Name of the second file to be added together.\n");
+  printf("-f [file]      Name of a periodogram (text or binary) to be combined. May be given any number of times.\n");
+  printf("-f1 / -f2      Same as -f, kept for compatibility.\n");
+  printf("-list [file]   Name of a file listing periodograms to be combined, one per line.\n");
   printf("-o [file]      Name of the output file.\n");
+  printf("-binary        Writes the output in the binary periodogram format rather than as text.\n");
+
+  printf("\n----- Combination -----\n");
+  printf("-mode [int]    How the periodograms are combined:\n");
+  printf("               1 = Sum of the metrics (DEFAULT).\n");
+  printf("               2 = Maximum of the metrics.\n");
+  printf("               3 = Weighted mean of the metrics.\n");
+  printf("-w [double]    Weight of the input named just before it, for -mode 3 (default = 1).\n");
 
   printf("\n----- Miscellaneous -----\n");
   printf("-h / --help    Displays this useful and informative help menu.\n\n");
@@ -320,16 +370,3 @@ void help() {
   return;
 
 }
-
-
-
-
-
-
-
-
-
-
-
-
-
@@ -16,17 +16,38 @@
 // 15/04/2016 - Downsampling routine no longer includes automatic de-reddening. This must be applied separately.
 // 06/06/2016 - Added SIGPYPROC read/write functionality
 // 19/09/2016 - Updated noise generation code
+// 19/10/2026 - Added fractionalPulsarDataArray
+// 19/10/2026 - Added synthDataArray, filling a data array from a synthetic series (see synthseries.h)
+// 19/10/2026 - Added preprocessDataArray. Downsampling by 2^n is a sum over blocks of 2^n source samples (each truncated to an integer, as
+//              downsampleDataArray does), so it is computed straight from the source and fed through the running median as it goes,
+//              with no intermediate arrays. Threads each take a slice of the output and prime their own running median with the samples before it.
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <math.h>
 #include <string.h>
+#include <limits.h>
+#include <pthread.h>
 #include "ffadata.h"
 #include "paddedarray.h"
 #include "dataarray.h"
 #include "whitenoise.h"
 #include "runningmedian.h"
+#include "synthseries.h"
+
+// one thread's share of preprocessDataArray
+typedef struct preprocessJob {
+  ffadata* source;
+  int sourcesize; // source samples that can be read - anything past this is zero padding
+  int factor; // source samples per output sample
+  ffadata* output;
+  int start;
+  int end;
+  int window; // running median window in output samples, or 0 for no de-reddening
+} preprocessJob;
+
+static void* preprocessWorker(void* arg);
 
 paddedArray* basicPulsarDataArray(int rawsize, int pulseperiod, int pulsewidth) {
 
@@ -74,6 +95,71 @@ paddedArray* basicPulsarDataArray(int rawsize, int pulseperiod, int pulsewidth)
 
 }
 
+paddedArray* fractionalPulsarDataArray(int rawsize, double pulseperiod, double pulsewidth) {
+
+  // Validity Checks
+  assert(pulseperiod > 0 && pulsewidth > 0);
+  assert(pulseperiod > pulsewidth);
+
+  // Build paddedArray with fullsize = rawsize*ARRAY_PADDING, as a multiple of two
+  int paddedsize = (int)ceil(rawsize*ARRAY_PADDING);
+  if ((paddedsize % 2) != 0) {
+    paddedsize++;
+  }
+
+  paddedArray* sourcedata = createPaddedArray(rawsize, paddedsize);
+  ffadata* array = getPaddedArrayDataArray(sourcedata);
+
+  int i;
+  for (i = 0; i < paddedsize; i++) {
+    if (i >= rawsize) {
+      // padding region
+      array[i] = generateZeroPadding();
+    } else if (fmod((double)i, pulseperiod) < pulsewidth) {
+      array[i] = PULSE;
+    } else {
+      array[i] = NO_PULSE;
+    }
+  }
+
+  return sourcedata;
+
+}
+
+paddedArray* synthDataArray(synthSeries* series) {
+
+  // Validity Checks
+  assert(series != NULL);
+  assert(series->samples > 0 && series->samples <= INT_MAX/ARRAY_PADDING - 1);
+
+  int rawsize = (int)series->samples;
+
+  // Build paddedArray with fullsize = rawsize*ARRAY_PADDING, as a multiple of two
+  int paddedsize = (int)ceil(rawsize*ARRAY_PADDING);
+  if ((paddedsize % 2) != 0) {
+    paddedsize++;
+  }
+
+  paddedArray* sourcedata = createPaddedArray(rawsize, paddedsize);
+  ffadata* array = getPaddedArrayDataArray(sourcedata);
+
+  // the series is generated straight into the data section
+  startSynthSeries(series);
+  long filled = 0;
+  long generated;
+  while ((generated = nextSynthChunk(series, &array[filled], rawsize - filled)) > 0) {
+    filled = filled + generated;
+  }
+  assert(filled == rawsize);
+
+  int i;
+  for (i = rawsize; i < paddedsize; i++) {
+    array[i] = generateZeroPadding();
+  }
+
+  return sourcedata;
+
+}
 
 paddedArray* readASCIIDataArray(FILE *inputfile) {
 
@@ -443,6 +529,155 @@ paddedArray* dereddenDataArray(paddedArray* sourcedata) {
 
 }
 
+void downsampledSizes(paddedArray* sourcedata, int downsamples, int* datasize, int* fullsize) {
+
+  assert(sourcedata != NULL);
+  assert(downsamples >= 0);
+
+  // the same rounding as downsampleDataArray, applied once per downsample
+  int data = getPaddedArrayDataSize(sourcedata);
+  int full = getPaddedArrayFullSize(sourcedata);
+  int d;
+  for (d = 0; d < downsamples; d++) {
+    if (data % 2 != 0) {
+      data = data + 1;
+    }
+    if (full % 2 != 0) {
+      full = full + 1;
+    }
+    data = data/2;
+    full = full/2;
+    while (full < data * ARRAY_PADDING) {
+      full = full + 2;
+    }
+  }
+
+  *datasize = data;
+  *fullsize = full;
+
+  return;
+}
+
+void preprocessDataArray(paddedArray* sourcedata, paddedArray* outdata, int downsamples, int window, int threads) {
+
+  assert(sourcedata != NULL);
+  assert(outdata != NULL);
+  assert(outdata != sourcedata);
+  assert(downsamples >= 0 && downsamples < 31);
+  assert(threads > 0);
+
+  int datasize, fullsize;
+  downsampledSizes(sourcedata, downsamples, &datasize, &fullsize);
+  assert(fullsize <= outdata->fullsize);
+
+  outdata->datasize = datasize;
+  outdata->fullsize = fullsize;
+  outdata->scalefactor = sourcedata->scalefactor * (1 << downsamples);
+  outdata->redflag = sourcedata->redflag;
+  outdata->window = sourcedata->window;
+
+  // the same window as dereddenDataArray would use on the downsampled data
+  int downwindow = 0;
+  if (getRedFlag(sourcedata) == TRUE) {
+    downwindow = (int)ceil(((double)window)/((double)outdata->scalefactor));
+  }
+
+  // each thread takes an equal slice of the output
+  if (threads > datasize/PREPROCESS_MIN_SLICE) {
+    threads = datasize/PREPROCESS_MIN_SLICE;
+  }
+  if (threads < 1) {
+    threads = 1;
+  }
+  preprocessJob jobs[threads];
+  int t;
+  for (t = 0; t < threads; t++) {
+    jobs[t].source = sourcedata->dataarray;
+    jobs[t].sourcesize = sourcedata->fullsize;
+    jobs[t].factor = 1 << downsamples;
+    jobs[t].output = outdata->dataarray;
+    jobs[t].start = (int)(((long)datasize * t)/threads);
+    jobs[t].end = (int)(((long)datasize * (t + 1))/threads);
+    jobs[t].window = downwindow;
+  }
+
+  if (threads == 1) {
+    preprocessWorker(&jobs[0]);
+  } else {
+    pthread_t workers[threads];
+    for (t = 0; t < threads; t++) {
+      int error = pthread_create(&workers[t], NULL, preprocessWorker, &jobs[t]);
+      assert(error == 0);
+    }
+    for (t = 0; t < threads; t++) {
+      pthread_join(workers[t], NULL);
+    }
+  }
+
+  int i;
+  for (i = datasize; i < fullsize; i++) {
+    outdata->dataarray[i] = generateZeroPadding();
+  }
+
+  return;
+}
+
+// a downsampled sample - the sum of a block of source samples, each truncated to an integer by the repeated halving in downsampleDataArray
+static inline ffadata preprocessSample(preprocessJob* job, int index) {
+
+  if (job->factor == 1) {
+    return job->source[index];
+  }
+
+  long first = (long)index * job->factor;
+  long last = first + job->factor;
+  if (last > job->sourcesize) {
+    last = job->sourcesize;
+  }
+
+  ffadata sum = 0;
+  long j;
+  for (j = first; j < last; j++) {
+    sum = sum + (int)job->source[j];
+  }
+
+  return sum;
+}
+
+static void* preprocessWorker(void* arg) {
+
+  preprocessJob* job = (preprocessJob*)arg;
+  int i;
+
+  if (job->window == 0) {
+    for (i = job->start; i < job->end; i++) {
+      job->output[i] = preprocessSample(job, i);
+    }
+    return NULL;
+  }
+
+  // once full, the running median only depends on the last [window] samples, so priming it with the samples before this slice
+  // gives the same medians as running it from the start of the data
+  Mediator* m = MediatorNew(job->window);
+  int first = job->start - job->window;
+  if (first < 0) {
+    first = 0;
+  }
+  for (i = first; i < job->start; i++) {
+    MediatorInsert(m, preprocessSample(job, i));
+  }
+
+  for (i = job->start; i < job->end; i++) {
+    ffadata value = preprocessSample(job, i);
+    MediatorInsert(m, value);
+    job->output[i] = value - (ffadata) MediatorMedian(m);
+  }
+
+  free(m);
+
+  return NULL;
+}
+
 void seedNoisyPadding() {
 
   startseed();
@@ -4,12 +4,16 @@
 // 08/03/2016 - Added function to read Float data for sake of PRESTO
 // 06/06/2016 - Added function for float data in SIGPYPROC format - a hybrid of SIGPROC and PRESTO - LARGELY UNTESTED - USE WITH CAUTION
 // 19/09/2016 - Updated noise generation code
+// 19/10/2026 - Added fractionalPulsarDataArray for test pulsars whose period is not a whole number of samples
+// 19/10/2026 - Added synthDataArray for noisy test data with any number of pulsars
+// 19/10/2026 - Added preprocessDataArray, which downsamples and de-reddens in one pass into a reusable array
 
 #include <stdio.h>
 #include <stdlib.h>
 #include "ffadata.h"
 #include "paddedarray.h"
 #include "whitenoise.h"
+#include "synthseries.h"
 
 #ifndef DATAARRAY_H
 #define DATAARRAY_H
@@ -21,11 +25,21 @@
 #define NO_PULSE 0
 #define ZERO_PADDING 0
 
+// preprocessDataArray gives each thread at least this many output samples
+#define PREPROCESS_MIN_SLICE 65536
+
 // ***** FUNCTION PROTOTYPES *****
 
 // creates an initialised padded array, with the datasize of the array being equal to the nearest power of 2 to rawsize and the padded size being determined by the scaling factor ARRAY_PADDING
 paddedArray* basicPulsarDataArray(int rawsize, int pulseperiod, int pulsewidth);
 
+// as basicPulsarDataArray, but the pulse period and width can be fractional numbers of samples - a sample is on pulse if its phase falls within the pulse
+paddedArray* fractionalPulsarDataArray(int rawsize, double pulseperiod, double pulsewidth);
+
+// creates a padded array holding a whole synthetic series (white / red noise and pulsars, see synthseries.h), generated straight into the array
+// the series is started from its beginning, and must fit in a data array
+paddedArray* synthDataArray(synthSeries* series);
+
 // reads in data from an ASCII file in order to seed the data array
 paddedArray* readASCIIDataArray(FILE *inputfile);
 
@@ -50,6 +64,15 @@ paddedArray* downsampleDataArray(paddedArray* sourcedata);
 // takes an existing filled PaddedArray struct and returns a new one that has been dereddened according to its internal specifications
 paddedArray* dereddenDataArray(paddedArray* sourcedata);
 
+// gives the data and full sizes of the array produced by downsampling sourcedata the given number of times with downsampleDataArray
+void downsampledSizes(paddedArray* sourcedata, int downsamples, int* datasize, int* fullsize);
+
+// downsamples sourcedata the given number of times and then, if its red flag is set, de-reddens it with a window of [window] original samples,
+// writing the result into outdata - the data matches that of downsampleDataArray followed by dereddenDataArray, but is produced in a single pass
+// without intermediate arrays. outdata must be at least as large as the result (see downsampledSizes) and is resized to it, so one array created for
+// the smallest number of downsamples can be reused for every larger number. The padding of outdata is zeroed.
+void preprocessDataArray(paddedArray* sourcedata, paddedArray* outdata, int downsamples, int window, int threads);
+
 // generates noise for padding purposes
 void seedNoisyPadding();
 
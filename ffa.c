@@ -1,6 +1,6 @@
 // C file for fucntions directly related to FFA execution
 // Andrew Cameron, MPIFR, 02/03/2015
-// Last modified 14/04/2016
+// Last modified 19/10/2026
 
 // Changelog
 // 06/02/2015 - Modified singleFFA so that it now produces a copy of the sourcearray for each execution, so that elements in last row can be modified to handle zero padding
@@ -12,6 +12,34 @@
 //            - This should only affect executions of the code which use pre-downsampling, and will prevent mathematically incorrect attempts by the code to run fractional
 //              search periods into singleFFA
 //            - Also added functionality into massFFA and singleFFA to allow them to be told to do dump MAD normalised profiles as opposed to just regular profiles
+// 19/10/2026 - singleFFA now runs its addition stages depth-first through blockedFFA, completing every stage on a cache-sized block of rows before moving on,
+//              rather than sweeping the full array once per stage. Profiles are evaluated once the final stage is complete.
+//            - Added a selectable bin-major layout for the stage arrays, in which groups of FFA_INTERLEAVE profiles are interleaved bin by bin.
+//              Metrics with an interleaved version score a whole group at once, otherwise each profile is gathered before evaluation.
+//            - singleFFA no longer copies the full source array for every base period. The first addition stage reads the source rows in place,
+//              and the partially filled row at the end of the data is blanked by reading it from a row of zeroes instead.
+//            - Added the ffaPlan workspace. A plan owns aligned, pre-faulted buffers sized for the worst case over a range of base periods and is reused
+//              for every base period in it, so the FFA itself no longer allocates. massFFA builds one plan per octave and singleFFA wraps a one-off plan.
+//              The addition stages now alternate between two buffers rather than keeping one array per stage.
+//            - Plan buffers are allocated through hugeAlloc() (huge pages where available) and first touched by the thread creating the plan.
+//            - massFFA now hands each octave of base periods to rangeFFA, which can split them across threads. Each worker runs its own plan and writes
+//              into in-memory fragments, which a merger thread writes back out in base period order, so threaded output matches serial output exactly.
+//            - The optional MAD time series normalisation is now applied once per octave, straight after downsampling, rather than before every base period.
+//            - Periodograms can now be written in the binary format described in periodogram.h.
+//            - Added a half-step mode, which runs a second FFA for each base period with its source rows spaced half a sample further apart,
+//              so that its trial periods fall halfway between those of the standard FFA (the trials of the second pass follow those of the first).
+//              Every source row from the end of the data onwards is now read as zeroes, rather than only the partially filled one.
+//            - Split runFFAPlan into foldFFAPlan (the addition stages) and the evaluation of the folded profiles.
+//            - massFFA can split the data into equal length segments and search them incoherently through segmentedFFA (see segmentffa.h).
+//            - The per-octave MAD normalisation runs through parallelMad() with the -threads threads.
+//            - massFFA builds each octave's data with preprocessDataArray(), downsampling and de-reddening in one pass into a single array
+//              reused for every octave, rather than through a chain of intermediate arrays.
+//            - massFFA now follows a searchPlan (see searchplan.h), an explicit list of octaves, instead of stepping through the period range itself.
+//              The old -lp / -hp / -ds behaviour is reproduced by legacySearchPlan(). The "lowperiod must be a multiple of the scalefactor" check moved there.
+//            - Plans can skip the last trial of each base period, which repeats the first trial of the next one (trimFFAPlan()).
+//            - Half-step trials are now written in period order among the standard trials. The half-step fold of a base period tests half a period
+//              past its end, so each base period now takes the half-step trials within its own range from its own half-step fold and that of the
+//              base period before it, whose fold is carried over from the previous base period where possible.
 
 
 
@@ -19,6 +47,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <pthread.h>
 #include <math.h>
 #include "ffadata.h"
 #include "power2resizer.h"
@@ -26,34 +55,231 @@
 #include "dataarray.h"
 #include "ffa.h"
 #include "mad.h"
+#include "metrics.h"
+#include "hugealloc.h"
+#include "periodogram.h"
+#include "fragmentmerge.h"
+#include "segmentffa.h"
+
+// scores a group of interleaved profiles with the interleaved version of a metric - returns FALSE if the metric only exists in profile-major form
+static int interleavedMetric(double (*metric)(ffadata*, int, int), ffadata* grouparray, int subsize, int lanes, double* scores);
+
+// a folded FFA pass whose profiles are being evaluated - group is the interleaved group last scored (-1 for none), with its scores
+typedef struct ffaPass {
+  ffadata* finalarray;
+  int baseperiod;
+  int branches;
+  int group;
+  int scored;
+  double scores[FFA_INTERLEAVE];
+} ffaPass;
+
+// folds one pass of a base period (source rows baseperiod + rowshift samples apart) through foldFFAPlan()
+static void foldFFAPass(ffaPlan* plan, paddedArray* sourcedata, int baseperiod, double rowshift, ffaPass* pass);
+
+// swaps the plan working buffer holding array with *keep, so that later folds leave array alone
+static void keepFFAPlanBuffer(ffaPlan* plan, ffadata* array, ffadata** keep);
+
+// the trial period tested by a row of a half-step fold
+static double halfStepPeriod(ffaPass* pass, int row);
+
+// evaluates one row of a folded pass as the given trial period
+static void evaluateFFAPass(ffaPlan* plan, ffaPass* pass, int row, double period, paddedArray* sourcedata, FILE* outputfile, FILE* profilefile, FILE* normprofilefile, double (*metric)(ffadata*, int, int), int mfsize);
+
+// reports the base period about to be run - only from serial runs, as threads running base periods at once would interleave their reports
+static void printFFAPlanPeriod(paddedArray* sourcedata, int baseperiod);
+
+// the work done by each thread of a threaded rangeFFA
+typedef struct ffaWorker {
+  fragmentMerger* merger;
+  int worker;
+  int workers;
+  paddedArray* sourcedata;
+  int firstperiod;
+  int trials;
+  double (*metric)(ffadata*, int, int);
+  int mfsize;
+  int layout;
+  int format;
+  int oversample;
+  int trim;
+} ffaWorker;
+
+// runs the base periods of a threaded rangeFFA assigned to one worker, handing the output of each one to the merger
+static void* runFFAWorker(void* arg);
 
 void slideAdd(ffadata* sourcearray, ffadata* resultarray, int sourcesubstartpos1, int sourcesubstartpos2, int resultsubstart, int subsize, int slide) {
 
   assert(sourcearray != NULL);
   assert(resultarray != NULL);
 
+  // profile-major rows are contiguous
+  stridedSlideAdd(&sourcearray[sourcesubstartpos1], &sourcearray[sourcesubstartpos2], 1, &resultarray[resultsubstart], 1, subsize, slide);
+
+  return;
+}
+
+void stridedSlideAdd(ffadata* source1, ffadata* source2, int sourcestride, ffadata* result, int resultstride, int subsize, int slide) {
+
+  assert(source1 != NULL);
+  assert(source2 != NULL);
+  assert(result != NULL);
+
   // scroll through the elements of the result sub array, and add in the required elements of the source sub arrays, with the appropriate slide
-  int i, j;
+  // the position in the second source sub array is i + slide, modulated by the subsize - rather than taking the modulus of every element,
+  // the loop is split at the point where the slid index wraps around to the start of the sub array
+  int i;
+  int wrap = subsize - (slide % subsize);
 
-  for (i = 0; i < subsize; i++) {
+  if ((sourcestride == 1) && (resultstride == 1)) {
+    // contiguous rows - kept separate so that the compiler can vectorise it
+    for (i = 0; i < wrap; i++) {
+      result[i] = add(source1[i], source2[i + subsize - wrap]);
+    }
+    for (i = wrap; i < subsize; i++) {
+      result[i] = add(source1[i], source2[i - wrap]);
+    }
+  } else {
+    for (i = 0; i < wrap; i++) {
+      result[i*resultstride] = add(source1[i*sourcestride], source2[(i + subsize - wrap)*sourcestride]);
+    }
+    for (i = wrap; i < subsize; i++) {
+      result[i*resultstride] = add(source1[i*sourcestride], source2[(i - wrap)*sourcestride]);
+    }
+  }
+
+  return;
+}
+
+int ffaArraySize(int layout, int branches, int baseperiod) {
+
+  assert(layout == FFA_LAYOUT_ROW || layout == FFA_LAYOUT_INTERLEAVED);
+
+  if (layout == FFA_LAYOUT_INTERLEAVED) {
+    // the last group is always stored in full, even if it is only partly used
+    return ((branches + FFA_INTERLEAVE - 1)/FFA_INTERLEAVE) * FFA_INTERLEAVE * baseperiod;
+  }
+
+  return branches * baseperiod;
+}
+
+ffadata* ffaRow(ffadata* array, int layout, int row, int baseperiod) {
+
+  assert(array != NULL);
+
+  if (layout == FFA_LAYOUT_INTERLEAVED) {
+    // groups of FFA_INTERLEAVE profiles are stored bin by bin - row picks the group, then the lane within it
+    return &array[(row/FFA_INTERLEAVE)*FFA_INTERLEAVE*baseperiod + row%FFA_INTERLEAVE];
+  }
+
+  return &array[row*baseperiod];
+}
+
+ffadata* ffaSourceRow(ffadata* array, int layout, int row, int baseperiod, double rowshift) {
+
+  assert(array != NULL);
+
+  if (rowshift == 0) {
+    return ffaRow(array, layout, row, baseperiod);
+  }
+
+  // rows spaced a fractional number of samples apart start at the sample they fall in
+  return &array[(long)floor(row*(baseperiod + rowshift))];
+}
+
+int ffaDataRows(int datasize, int baseperiod, double rowshift) {
+
+  if (datasize < baseperiod) {
+    return 0;
+  }
+
+  if (rowshift == 0) {
+    return datasize/baseperiod;
+  }
+
+  // count the rows that end within the data
+  int rows = (int)((datasize - baseperiod)/(baseperiod + rowshift)) + 1;
+  while ((rows > 0) && ((long)floor((rows - 1)*(baseperiod + rowshift)) + baseperiod > datasize)) {
+    rows--;
+  }
+  while ((long)floor(rows*(baseperiod + rowshift)) + baseperiod <= datasize) {
+    rows++;
+  }
+
+  return rows;
+}
+
+int ffaStride(int layout) {
+
+  if (layout == FFA_LAYOUT_INTERLEAVED) {
+    return FFA_INTERLEAVE;
+  }
+
+  return 1;
+}
+
+void ffaStage(ffadata* startarray, int startlayout, ffadata* endarray, int endlayout, int baseperiod, int stage, int firstrow, int rows, int datarows, double rowshift, ffadata* zerorow) {
 
-    // result element is i
-    // the position in the first source sub array will just be i
-    // the position in the second source sub array will be i + slide, modulated by the subsize
-    j = (i + slide) % subsize;
+  assert(startarray != NULL);
+  assert(endarray != NULL);
+  assert((datarows < 0) || (zerorow != NULL));
+  assert((rowshift == 0) || (startlayout == FFA_LAYOUT_ROW));
 
-    int sourcesubpos1 = i + sourcesubstartpos1;
-    int sourcesubpos2 = j + sourcesubstartpos2;
+  // a segment represents the self-contained module of array elements that are adding together at each addition step
+  int segmentsize = 1 << stage;
+  int segments = rows/segmentsize;
+  int j, k;
 
-    // now add
-    resultarray[i + resultsubstart] = add(sourcearray[sourcesubpos1], sourcearray[sourcesubpos2]);
+  for (j = 0; j < segments; j++) {
 
+    int segmentstart = firstrow + j*segmentsize;
+
+    for (k = 0; k < segmentsize; k++) {
+      int slide = (int)ceil((float)k/2);
+      int sourcerow1 = (int)floor((float)k/2) + segmentstart;
+      int sourcerow2 = sourcerow1 + segmentsize/2;
+      ffadata* source1 = ((datarows >= 0) && (sourcerow1 >= datarows)) ? zerorow : ffaSourceRow(startarray, startlayout, sourcerow1, baseperiod, rowshift);
+      ffadata* source2 = ((datarows >= 0) && (sourcerow2 >= datarows)) ? zerorow : ffaSourceRow(startarray, startlayout, sourcerow2, baseperiod, rowshift);
+
+      // we have now honed in on the result cell, and have enough information to select the source cells to use in the addition and the slide amount
+      // add sub array cells (the zero row is always contiguous, so masking is only allowed on a profile-major start array)
+      stridedSlideAdd(source1, source2, ffaStride(startlayout), ffaRow(endarray, endlayout, k + segmentstart, baseperiod), ffaStride(endlayout), baseperiod, slide);
+    }
   }
 
   return;
 }
 
-void massFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, int lowperiod, int highperiod, double (*metric)(ffadata*, int, int), int mfsize,  int prelim_ds, FILE* redfile, int PRESTO_flag, int timenorm_flag) {
+void blockedFFA(ffadata** sumarrays, int layout, int baseperiod, int stage, int firstrow, int datarows, double rowshift, ffadata* zerorow) {
+
+  assert(sumarrays != NULL);
+
+  // Stage s of a segment of 2^s rows only depends on stage s-1 of the same rows, so the FFA can be run depth-first:
+  // once a segment (across all the stage arrays it touches) fits in cache, run all of its stages back to back before moving on,
+  // otherwise bring both halves of the segment up to stage s-1 first and then run the final addition over the whole segment
+  // The source rows in sumarrays[0] are always profile-major, later stages use the requested layout
+  // Only the first stage reads the source rows, so it is the only one that needs to know where the data ends
+  int rows = 1 << stage;
+  int s;
+
+  if (stage == 0) {
+    return;
+  }
+
+  if ((double)rows * baseperiod * sizeof(ffadata) * (stage + 1) <= FFA_BLOCK_BYTES) {
+    for (s = 1; s <= stage; s++) {
+      ffaStage(sumarrays[s-1], (s == 1) ? FFA_LAYOUT_ROW : layout, sumarrays[s], layout, baseperiod, s, firstrow, rows, (s == 1) ? datarows : -1, (s == 1) ? rowshift : 0, zerorow);
+    }
+  } else {
+    blockedFFA(sumarrays, layout, baseperiod, stage - 1, firstrow, datarows, rowshift, zerorow);
+    blockedFFA(sumarrays, layout, baseperiod, stage - 1, firstrow + rows/2, datarows, rowshift, zerorow);
+    ffaStage(sumarrays[stage-1], (stage == 1) ? FFA_LAYOUT_ROW : layout, sumarrays[stage], layout, baseperiod, stage, firstrow, rows, (stage == 1) ? datarows : -1, (stage == 1) ? rowshift : 0, zerorow);
+  }
+
+  return;
+}
+
+void massFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, searchPlan* searchplan, double (*metric)(ffadata*, int, int), int mfsize, FILE* redfile, int PRESTO_flag, int timenorm_flag, int layout, int format, int oversample, int threads, int segments, int segmode) {
 
   // UPDATE - THIS SCRIPT MUST REFER ANY DE-REDDENING AND RESULTANT DOWNSAMPLING BACK TO THE ORIGINAL SOURCEDATA ARRAY FOR COMPUTATIONAL CORRECTNESS
   // DOUBLE UPDATE 15/04/2016 - THE DOWNSAMPLING FUNCTION NO LONGER INCLUDES AUTOMATIC DE-REDDENING
@@ -62,37 +288,28 @@ void massFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedA
   // validity checks
   assert(outputfile != NULL);
   assert(sourcedata != NULL);
-  
-  if (fmod(lowperiod, getPaddedArrayScaleFactor(sourcedata)) != 0) {
-    printf("ERROR: Low search period (%d) must be integer multiple of initial downsampling factor (%d).\nPlease correct and try again.\n", lowperiod, getPaddedArrayScaleFactor(sourcedata));
-    exit(EXIT_FAILURE);
-  }
+  assert(searchplan != NULL && searchplan->noctaves > 0);
 
-  // This function needs to generate all the base periods to test, re-scale the array for each base period, and then execute the individual FFA algorithm for each base period
-  // Function also needs to oversee downsampling by a factor of 2 each time the lowperiod is doubled.
+  // This function needs to run every octave of base periods in the plan, re-scaling the array whenever the octave's downsampling changes
+  // (the octaves of a plan only ever downsample further, and the first has the fewest downsamples)
 
-  int i = lowperiod;
   paddedArray* workingdata = sourcedata;
-  paddedArray* tempdata;
-  int loopscalefactor = 0; //used for controlling the downsampling during FFA operation
+  paddedArray* preprocessed = NULL; // downsampled / de-reddened data for the current octave
+  int firstdownsamples = searchplan->octaves[0].downsamples;
+  int o;
+
+  writePeriodogramHeader(outputfile, format);
 
-  fprintf(outputfile, "# Period (original samples) | Downsample factor | Period (downsampled samples) | Metric\n");
+  for (o = 0; o < searchplan->noctaves; o++) {
 
-  while (i < highperiod) {
+    searchOctave* octave = &searchplan->octaves[o];
+    int i = octave->firstperiod * octave->scalefactor;
+    int loopscalefactor = octave->downsamples - firstdownsamples; // octaves of downsampling since the start of the search
 
-    if (i == lowperiod*((int)pow(2, loopscalefactor))) {
+    if ((o == 0) || (octave->downsamples != searchplan->octaves[o-1].downsamples)) {
       // this means that we have either just started the scan, or have reached a downsampling point
       printf("\nDownsampling initiated: i = %d\n", i);
       
-      // the process will first involve de-reddening the datarray (but only if de-reddening is selected
-      // clean up the current workingdata - it is no longer needed
-      if (workingdata != sourcedata) {
-	deletePaddedArray(workingdata);
-      }
-
-      // reset to sourcedata
-      workingdata = sourcedata;
-
       /*if (getRedFlag(sourcedata) == TRUE) {
 	// the de-reddening window needs to be increased with each downsample loop
 	int old_window = getWindow(sourcedata);
@@ -118,43 +335,32 @@ void massFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedA
         workingdata = sourcedata;
 	}*/
 
-      // array has been de-reddened, now downsample according to the correct number of loops
-      int jj = 0;
-      
-      while (jj < prelim_ds + loopscalefactor) {
-	tempdata = downsampleDataArray(workingdata);
-	// we need to clean up the old workingdata struct
-	if (workingdata != sourcedata) {
-	  deletePaddedArray(workingdata);
+      // downsample and de-redden (if required) sourcedata in a single pass, into an array reused for every octave
+      // (the first octave has the fewest downsamples, so its array is large enough for all the rest)
+      int downsamples = octave->downsamples;
+      if ((downsamples == 0) && (getRedFlag(sourcedata) == FALSE)) {
+	workingdata = sourcedata;
+      } else {
+	if (preprocessed == NULL) {
+	  int datasize, fullsize;
+	  downsampledSizes(sourcedata, downsamples, &datasize, &fullsize);
+	  preprocessed = createPaddedArray(datasize, fullsize);
 	}
-	workingdata = tempdata;
 
-	jj++;
-	printf("Downsample loop %d completed.\n", jj);
-      }
-      
-      printf("Downsample factor: %d\n", prelim_ds + loopscalefactor);
-
-      // NEW SECTION - NOW DEREDDEN, IF NECCESSARY
-      if (getRedFlag(workingdata) == TRUE) {
 	// the de-reddening window needs to be increased with each downsample loop
-	int old_window = getWindow(workingdata);
-	int new_window = old_window*((int)pow(2, loopscalefactor));
-	printf("Dereddening with window of %d original samples...\n", new_window);
-	setWindow(workingdata, new_window); // this will need to be reset once a new paddedarray is created
-
-	// de-redden
-	tempdata = dereddenDataArray(workingdata);
-	// cleanup
-	if (workingdata != sourcedata) {
-	  deletePaddedArray(workingdata);
+	int new_window = getWindow(sourcedata)*((int)pow(2, loopscalefactor));
+	if (getRedFlag(sourcedata) == TRUE) {
+	  printf("Dereddening with window of %d original samples...\n", new_window);
 	}
-	workingdata = tempdata;
-	// reset sourcedata's window
-	setWindow(workingdata, old_window);
+	preprocessDataArray(sourcedata, preprocessed, downsamples, new_window, threads);
+	workingdata = preprocessed;
+      }
 
+      printf("Downsample factor: %d\n", downsamples);
+
+      if (getRedFlag(workingdata) == TRUE) {
 	// if this is the first pass through, and the file is set, now is the time to write the file
-	if ((redfile != NULL) && (i == lowperiod)) {
+	if ((redfile != NULL) && (o == 0)) {
 	  if (PRESTO_flag == FALSE) {
 	    writeASCIIDataArray(redfile, workingdata);
 	  } else if (PRESTO_flag == TRUE) {
@@ -164,144 +370,534 @@ void massFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedA
 	printf("De-reddened copy of data written to file.\n");
       }
 
-      // modify the internal scale factor
-      loopscalefactor++;
+      // perform new normalisation pass using MAD if required
+      // every base period up to the next downsampling point runs on this same data, so this only needs doing once per octave
+      if (timenorm_flag == TRUE) {
+	parallelMad(getPaddedArrayDataArray(workingdata), getPaddedArrayDataSize(workingdata), threads);
+	printf("Downsampled time-series normalised via MAD.\n");
+      }
 
     }
 
     // downsampling, if neccessary, is now complete
-    
-    // perform new normalisation pass using MAD if required
-    if (timenorm_flag == TRUE) {
-      mad(getPaddedArrayDataArray(workingdata), getPaddedArrayDataSize(workingdata));
-      printf("Downsampled time-series normalised via MAD.\n");
-    }
-    
-    // we now need to pass the relevant parameters to the singleFFA function
-    // baseperiod must be calculated to match with the current downsampling
-    printf("\nCalling single FFA search for a period of %d original samples...\n", i);
-    singleFFA(outputfile, profilefile, normprofilefile, workingdata, i/getPaddedArrayScaleFactor(workingdata), metric, mfsize);
 
-    // increment i according to the scale factor
-    i = i + getPaddedArrayScaleFactor(workingdata);
+    // run every base period of the octave on the current workingdata
+    assert(getPaddedArrayScaleFactor(workingdata) == octave->scalefactor);
+    printf("\nCalling FFA search for %d base periods, starting from a period of %d original samples...\n", octave->trials, i);
+    if (segments > 1) {
+      segmentedFFA(outputfile, profilefile, normprofilefile, workingdata, segments, segmode, octave->firstperiod, octave->trials, metric, mfsize, layout, format, oversample, threads, octave->trim);
+    } else {
+      rangeFFA(outputfile, profilefile, normprofilefile, workingdata, octave->firstperiod, octave->trials, metric, mfsize, layout, format, oversample, threads, octave->trim);
+    }
 
   }
 
   // final clean up
-  if ((workingdata != sourcedata) && (workingdata != NULL)) {
-      deletePaddedArray(workingdata);
+  if (preprocessed != NULL) {
+    deletePaddedArray(preprocessed);
   }
 
   return;
 }
 
-void singleFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, int baseperiod, double (*metric)(ffadata*, int, int), int mfsize) {
+void rangeFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, int firstperiod, int trials, double (*metric)(ffadata*, int, int), int mfsize, int layout, int format, int oversample, int threads, int trim) {
 
-  // basic validity checks
+  // validity checks
   assert(outputfile != NULL);
   assert(sourcedata != NULL);
+  assert(threads >= 1);
+
+  if (trials <= 0) {
+    return;
+  }
+
+  int t;
+
+  if (threads == 1) {
+    // serial run - write straight to the output files through a single plan
+    ffaPlan* plan = createFFAPlan(getPaddedArrayDataSize(sourcedata), firstperiod, firstperiod + trials, layout, format, oversample);
+    trimFFAPlan(plan, trim, firstperiod + trials - 1);
+    for (t = 0; t < trials; t++) {
+      printFFAPlanPeriod(sourcedata, firstperiod + t);
+      runFFAPlan(plan, outputfile, profilefile, normprofilefile, sourcedata, firstperiod + t, metric, mfsize);
+    }
+    deleteFFAPlan(plan);
+    return;
+  }
+
+  // threaded run - base period firstperiod + t is run by worker t % threads, and the merger puts the output back in order
+  if (threads > trials) {
+    threads = trials;
+  }
+
+  FILE* outputs[FRAGMENT_STREAMS] = {outputfile, profilefile, normprofilefile};
+  fragmentMerger* merger = startFragmentMerger(threads, trials, outputs);
+
+  pthread_t workers[threads];
+  ffaWorker jobs[threads];
+
+  for (t = 0; t < threads; t++) {
+    jobs[t].merger = merger;
+    jobs[t].worker = t;
+    jobs[t].workers = threads;
+    jobs[t].sourcedata = sourcedata;
+    jobs[t].firstperiod = firstperiod;
+    jobs[t].trials = trials;
+    jobs[t].metric = metric;
+    jobs[t].mfsize = mfsize;
+    jobs[t].layout = layout;
+    jobs[t].format = format;
+    jobs[t].oversample = oversample;
+    jobs[t].trim = trim;
+    int error = pthread_create(&workers[t], NULL, runFFAWorker, &jobs[t]);
+    assert(error == 0);
+  }
+
+  for (t = 0; t < threads; t++) {
+    pthread_join(workers[t], NULL);
+  }
+  finishFragmentMerger(merger);
+
+  return;
+}
+
+static void printFFAPlanPeriod(paddedArray* sourcedata, int baseperiod) {
 
   printf("Entered singleFFA with baseperiod of %d samples and a scalefactor of %d...\n", baseperiod, getPaddedArrayScaleFactor(sourcedata));
   // need the size of the array to use based on N/n = 2^x
   int size = power2Resizer(getPaddedArrayDataSize(sourcedata), baseperiod);
-  // double check that the array size is still within memory limits 
-  assert(size <= getPaddedArrayFullSize(sourcedata));
   printf("Array size rescaled from %d to %d (%.1f%% change).\n", getPaddedArrayDataSize(sourcedata), size, abs(getPaddedArrayDataSize(sourcedata) - size)*100/(float)(getPaddedArrayDataSize(sourcedata)));
 
-  // initialise counters
-  int i, j, k;
+  return;
+}
 
-  // setup variables controlling the scale of the FFA
-  int branches = (int)size/baseperiod;
-  int addition_iterations = (int)log2(branches);
-  double period_increment = (double)1/((double)(branches - 1));
+static void* runFFAWorker(void* arg) {
 
-  // build this many new arrays matching the original size to store the cumulative additions - the first should be the source array
-  ffadata* sumarrays[addition_iterations + 1];
+  ffaWorker* job = (ffaWorker*)arg;
+  fragment output;
+  int t;
 
-  for (i = 0; i <= addition_iterations; i++) {
-    if (i == 0) {
-      sumarrays[i] = copyPaddedArrayDataArray(sourcedata);
-    } else {
-      sumarrays[i] = (ffadata*)malloc(sizeof(ffadata)*size);
+  // the plan is built (and its buffers first touched) by the thread that uses it
+  ffaPlan* plan = createFFAPlan(getPaddedArrayDataSize(job->sourcedata), job->firstperiod, job->firstperiod + job->trials, job->layout, job->format, job->oversample);
+  trimFFAPlan(plan, job->trim, job->firstperiod + job->trials - 1);
+
+  for (t = job->worker; t < job->trials; t = t + job->workers) {
+    openFragment(job->merger, &output, t);
+    runFFAPlan(plan, output.streams[0], output.streams[1], output.streams[2], job->sourcedata, job->firstperiod + t, job->metric, job->mfsize);
+    pushFragment(job->merger, &output);
+  }
+
+  deleteFFAPlan(plan);
+
+  return NULL;
+}
+
+void singleFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, int baseperiod, double (*metric)(ffadata*, int, int), int mfsize, int layout) {
+
+  // basic validity checks
+  assert(outputfile != NULL);
+  assert(sourcedata != NULL);
+
+  // a plan covering just this one base period
+  ffaPlan* plan = createFFAPlan(getPaddedArrayDataSize(sourcedata), baseperiod, baseperiod + 1, layout, PERIODOGRAM_TEXT, 1);
+  printFFAPlanPeriod(sourcedata, baseperiod);
+  runFFAPlan(plan, outputfile, profilefile, normprofilefile, sourcedata, baseperiod, metric, mfsize);
+  deleteFFAPlan(plan);
+
+  return;
+}
+
+ffaPlan* createFFAPlan(int datasize, int lowperiod, int highperiod, int layout, int format, int oversample) {
+
+  // validity checks
+  assert(datasize > 0);
+  assert(lowperiod >= 1);
+  assert(highperiod > lowperiod);
+  assert(layout == FFA_LAYOUT_ROW || layout == FFA_LAYOUT_INTERLEAVED);
+  assert(format == PERIODOGRAM_TEXT || format == PERIODOGRAM_BINARY);
+  assert(oversample == 1 || oversample == 2);
+
+  ffaPlan* plan = (ffaPlan*)malloc(sizeof(ffaPlan));
+  assert(plan != NULL);
+
+  plan->layout = layout;
+  plan->format = format;
+  plan->oversample = oversample;
+  plan->trim = FALSE;
+  plan->keepperiod = -1;
+  plan->datasize = datasize;
+  plan->lowperiod = lowperiod;
+  plan->highperiod = highperiod;
+
+  // find the largest stage array needed by any base period in the range - neighbouring base periods can round up to different powers of 2
+  // the half-step trials of lowperiod come partly from a fold of lowperiod - 1
+  int baseperiod, branches, arraysize;
+  plan->arraysize = 0;
+  for (baseperiod = ((oversample == 2) && (lowperiod > 1)) ? lowperiod - 1 : lowperiod; baseperiod < highperiod; baseperiod++) {
+    branches = power2Resizer(datasize, baseperiod)/baseperiod;
+    arraysize = ffaArraySize(layout, branches, baseperiod);
+    if (arraysize > plan->arraysize) {
+      plan->arraysize = arraysize;
     }
   }
 
-  // NEW SECTION - HANDLES ZERO PADDING ISSUE
-  // If array has been padded out, then a branch of the sourcearray data will contain part data and part zeroes, causing baseline jumps and false detections
-  // This row must be entirely set to zeroes
-  for (i = 0; i < branches; i++) {
-    if ((((i + 1) * baseperiod) > getPaddedArrayDataSize(sourcedata)) && ((i * baseperiod) < getPaddedArrayDataSize(sourcedata))) {
-      // if we are a partial row of data, clean it out
-      for (j = i*baseperiod ; j < (i+1)*baseperiod ; j++) {
-	(sumarrays[0])[j] = generateZeroPadding();
+  // Stage s only ever reads stage s-1, and the source array is never written to, so the stages can alternate between two buffers
+  // All buffers are touched here, so that no page faults are taken once the plan is running
+  int i;
+  for (i = 0; i < 2; i++) {
+    plan->buffers[i] = ffaPlanBuffer(plan->arraysize);
+  }
+  plan->spare = (oversample == 2) ? ffaPlanBuffer(plan->arraysize) : NULL;
+  plan->carry = (oversample == 2) ? ffaPlanBuffer(plan->arraysize) : NULL;
+  plan->carryperiod = -1;
+  plan->carrysource = NULL;
+  plan->zerorow = ffaPlanBuffer(highperiod - 1);
+  plan->profile = ffaPlanBuffer(highperiod - 1);
+  plan->smootharray = ffaPlanBuffer(highperiod - 1);
+
+  for (i = 0; i < highperiod - 1; i++) {
+    plan->zerorow[i] = generateZeroPadding();
+  }
+
+  return plan;
+}
+
+void trimFFAPlan(ffaPlan* plan, int trim, int lastperiod) {
+
+  assert(plan != NULL);
+  assert(trim == FFA_TRIM_NONE || trim == FFA_TRIM_REPEATS || trim == FFA_TRIM_KEEP_END);
+
+  plan->trim = (trim != FFA_TRIM_NONE) ? TRUE : FALSE;
+  plan->keepperiod = (trim == FFA_TRIM_KEEP_END) ? lastperiod : -1;
+
+  return;
+}
+
+int ffaEvaluatedBranches(ffaPlan* plan, int baseperiod, int branches) {
+
+  if ((plan->trim == TRUE) && (baseperiod != plan->keepperiod)) {
+    return branches - 1;
+  }
+
+  return branches;
+}
+
+void ffaHalfStepRows(int branches, int upper, int* firstrow, int* lastrow) {
+
+  assert(firstrow != NULL && lastrow != NULL);
+
+  // row k of the half-step fold tests baseperiod + 0.5 + k/(branches - 1) - branches is a power of 2, so the rows up to branches/2 - 1 fall
+  // below baseperiod + 1, and the rest (bar the last, which repeats the first half-step trial of the next base period) above it
+  if (upper == TRUE) {
+    *firstrow = branches/2;
+    *lastrow = (branches > 1) ? branches - 1 : branches/2;
+  } else {
+    *firstrow = 0;
+    *lastrow = branches/2;
+  }
+
+  return;
+}
+
+int ffaHalfSteps(int datasize, int baseperiod) {
+
+  int firstrow, lastrow;
+  int halfsteps = 0;
+
+  if (baseperiod > 1) {
+    ffaHalfStepRows(power2Resizer(datasize, baseperiod - 1)/(baseperiod - 1), TRUE, &firstrow, &lastrow);
+    halfsteps = halfsteps + lastrow - firstrow;
+  }
+  ffaHalfStepRows(power2Resizer(datasize, baseperiod)/baseperiod, FALSE, &firstrow, &lastrow);
+  halfsteps = halfsteps + lastrow - firstrow;
+
+  return halfsteps;
+}
+
+void deleteFFAPlan(ffaPlan* plan) {
+
+  assert(plan != NULL);
+
+  hugeFree(plan->buffers[0]);
+  hugeFree(plan->buffers[1]);
+  hugeFree(plan->spare);
+  hugeFree(plan->carry);
+  hugeFree(plan->zerorow);
+  hugeFree(plan->profile);
+  hugeFree(plan->smootharray);
+  free(plan);
+
+  return;
+}
+
+ffadata* ffaPlanBuffer(int size) {
+
+  assert(size > 0);
+
+  // zeroed here so that every page is faulted in up front, on the NUMA node of the thread that creates (and so should run) the plan
+  ffadata* buffer = (ffadata*)hugeAlloc(sizeof(ffadata)*size);
+  hugeTouch(buffer, sizeof(ffadata)*size);
+
+  return buffer;
+}
+
+void runFFAPlan(ffaPlan* plan, FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, int baseperiod, double (*metric)(ffadata*, int, int), int mfsize) {
+
+  // basic validity checks
+  assert(plan != NULL);
+  assert(outputfile != NULL);
+  assert(sourcedata != NULL);
+
+  // initialise counters
+  int k, h;
+
+  ffaPass standard;
+  foldFFAPass(plan, sourcedata, baseperiod, 0, &standard);
+  double period_increment = (double)1/((double)(standard.branches - 1));
+  int evaluated = ffaEvaluatedBranches(plan, baseperiod, standard.branches);
+
+  // the half-step trials are rows lowfirst to lowlast - 1 of the half-step fold of baseperiod - 1, then rows highfirst to highlast - 1 of the half-step fold of baseperiod
+  ffaPass lower, upper;
+  int lowfirst = 0, lowlast = 0, highfirst = 0, highlast = 0;
+  upper.finalarray = NULL;
+
+  if (plan->oversample == 2) {
+    // the half-step folds run in the plan's working buffers, so the standard profiles move to the spare buffer until they have all been evaluated
+    keepFFAPlanBuffer(plan, standard.finalarray, &plan->spare);
+
+    if (baseperiod > 1) {
+      lower.baseperiod = baseperiod - 1;
+      lower.branches = power2Resizer(getPaddedArrayDataSize(sourcedata), lower.baseperiod)/lower.baseperiod;
+      ffaHalfStepRows(lower.branches, TRUE, &lowfirst, &lowlast);
+      if ((lowlast > lowfirst) && (plan->carryperiod == baseperiod - 1) && (plan->carrysource == sourcedata)) {
+	// folded as the upper half-step fold of the last base period run
+	lower.finalarray = plan->carry;
+	lower.group = -1;
+      } else if (lowlast > lowfirst) {
+	foldFFAPass(plan, sourcedata, lower.baseperiod, FFA_HALFSTEP_SHIFT, &lower);
       }
     }
+    ffaHalfStepRows(standard.branches, FALSE, &highfirst, &highlast);
   }
 
-  // for file output
-  double period;
+  // the standard and half-step trials are each in period order - merge them, so that the periodogram is too
+  int lowcount = lowlast - lowfirst;
+  int halfsteps = lowcount + highlast - highfirst;
+  k = 0;
+  h = 0;
 
-  // start counting through the addition steps
-  for (i = 1; i <= addition_iterations; i++) {
+  while ((k < evaluated) || (h < halfsteps)) {
+
+    ffaPass* pass = (h < lowcount) ? &lower : &upper;
+    int row = (h < lowcount) ? lowfirst + h : highfirst + h - lowcount;
+
+    if ((h == lowcount) && (h < halfsteps) && (upper.finalarray == NULL)) {
+      // the lower half-step trials are done with, so the working buffers are free for the upper half-step fold
+      foldFFAPass(plan, sourcedata, baseperiod, FFA_HALFSTEP_SHIFT, &upper);
+    }
+
+    if ((h < halfsteps) && ((k == evaluated) || (halfStepPeriod(pass, row) < k * period_increment + baseperiod))) {
+      evaluateFFAPass(plan, pass, row, halfStepPeriod(pass, row), sourcedata, outputfile, profilefile, normprofilefile, metric, mfsize);
+      h++;
+    } else {
+      evaluateFFAPass(plan, &standard, k, k * period_increment + baseperiod, sourcedata, outputfile, profilefile, normprofilefile, metric, mfsize);
+      k++;
+    }
+  }
 
-    ffadata* startarray = sumarrays[i-1];
-    ffadata* endarray = sumarrays[i];
+  if (upper.finalarray != NULL) {
+    // keep the upper half-step fold, whose remaining rows are the lower half-step trials of the next base period
+    keepFFAPlanBuffer(plan, upper.finalarray, &plan->carry);
+    plan->carryperiod = baseperiod;
+    plan->carrysource = sourcedata;
+  } else {
+    plan->carryperiod = -1;
+  }
 
-    // a segment represents the self-contained module of array elements that are adding together at each addition step
-    int segmentsize = (int)pow(2, i);
-    int segments = (int)branches/segmentsize;
+  // individual FFA execution should now be complete - all memory belongs to the plan or the paddedArray struct
+  return;
+}
 
-    for (j = 0; j < segments; j++) {
+static void foldFFAPass(ffaPlan* plan, paddedArray* sourcedata, int baseperiod, double rowshift, ffaPass* pass) {
 
-      for (k = 0; k < segmentsize; k++) {
-	int slide = (int)ceil((float)k/2);
-	int sourcecellpos1 = ((int)floor((float)k/2) + j*segmentsize)*baseperiod;
+  pass->finalarray = foldFFAPlan(plan, sourcedata, baseperiod, rowshift, &pass->branches);
+  pass->baseperiod = baseperiod;
+  pass->group = -1;
 
-	// we have now honed in on the result cell, and have enough information to select the source cells to use in the addition and the slide amount
-	// add sub array cells
-	slideAdd(startarray, endarray, sourcecellpos1, sourcecellpos1 + baseperiod*segmentsize/2, (k + j*segmentsize)*baseperiod, baseperiod, slide);
+  return;
+}
 
-	// if this is the last iteration of the FFA additions, we can output the metric now without having to re-scan the loop
-	if (i == addition_iterations) {
-	  period = k * period_increment + baseperiod; // this is the tested period in units of (downsampled) samples
+static void keepFFAPlanBuffer(ffaPlan* plan, ffadata* array, ffadata** keep) {
 
-	  // normalise the profile for post-MAD
-	  //postMadProfileNormaliser(sumarrays[i], (k + j*segmentsize)*baseperiod, baseperiod, (int)ceil(sourcedata->datasize/((double)baseperiod)));
-	  //postMadProfileNormaliser(sumarrays[i], (k + j*segmentsize)*baseperiod, baseperiod, branches);
-	  if (mfsize > 0) {
-	    mfsmoother(sumarrays[i], (k + j*segmentsize)*baseperiod, baseperiod, mfsize);
-	  }
-	  
-	  fprintf(outputfile, "%.10f %d %.10f %.10f\n", period*getPaddedArrayScaleFactor(sourcedata), getPaddedArrayScaleFactor(sourcedata), period, metric(sumarrays[i], (k + j*segmentsize)*baseperiod, baseperiod));
-	 
-	  // PROFILE DUMP
-	  if ((profilefile != NULL)) {
-	    profiledump(profilefile, period*getPaddedArrayScaleFactor(sourcedata), getPaddedArrayScaleFactor(sourcedata), sumarrays[i], (k + j*segmentsize)*baseperiod, baseperiod);
-	  }
-	  // Alternatively, dump normalised profiles (don't need to worry about copying the array as we're about to delete it anyway)
-	  if ((normprofilefile != NULL)) {
-	    // normalise the profiles using MAD
-	    mad(&sumarrays[i][(k + j*segmentsize)*baseperiod], baseperiod);
-	    profiledump(normprofilefile, period*getPaddedArrayScaleFactor(sourcedata), getPaddedArrayScaleFactor(sourcedata), sumarrays[i], (k + j*segmentsize)*baseperiod, baseperiod);
-	  }
-	}
-      }
+  int i = (plan->buffers[0] == array) ? 0 : 1;
+  assert(plan->buffers[i] == array);
+
+  plan->buffers[i] = *keep;
+  *keep = array;
+
+  return;
+}
 
+static double halfStepPeriod(ffaPass* pass, int row) {
+
+  double period_increment = (double)1/((double)(pass->branches - 1));
+
+  return row * period_increment + pass->baseperiod + FFA_HALFSTEP_SHIFT;
+}
+
+static void evaluateFFAPass(ffaPlan* plan, ffaPass* pass, int row, double period, paddedArray* sourcedata, FILE* outputfile, FILE* profilefile, FILE* normprofilefile, double (*metric)(ffadata*, int, int), int mfsize) {
+
+  int layout = plan->layout;
+  int baseperiod = pass->baseperiod;
+  int scalefactor = getPaddedArrayScaleFactor(sourcedata);
+  int j;
+
+  if (layout == FFA_LAYOUT_ROW) {
+    // profiles are already contiguous
+    evaluateProfile(outputfile, profilefile, normprofilefile, &pass->finalarray[row*baseperiod], baseperiod, period, scalefactor, metric, mfsize, NULL, plan->smootharray, plan->format);
+    return;
+  }
+
+  // profiles are interleaved by bin - score a whole group at once if the metric has an interleaved version, otherwise gather each profile in turn
+  // (the matched filter is applied to each profile individually, so it always takes the gather route)
+  // with fewer than FFA_INTERLEAVE branches the final group is only partly filled, and the lanes past branches are never written,
+  // so a partial group is gathered profile by profile rather than scoring lanes that hold no data
+  int group = row/FFA_INTERLEAVE;
+  int lane = row%FFA_INTERLEAVE;
+  ffadata* grouparray = ffaRow(pass->finalarray, layout, group*FFA_INTERLEAVE, baseperiod);
+
+  if (group != pass->group) {
+    pass->scored = (mfsize == 0) && ((group + 1)*FFA_INTERLEAVE <= pass->branches) && interleavedMetric(metric, grouparray, baseperiod, FFA_INTERLEAVE, pass->scores);
+    pass->group = group;
+  }
+
+  ffadata* profile = plan->profile;
+  if ((pass->scored == FALSE) || (profilefile != NULL) || (normprofilefile != NULL)) {
+    for (j = 0; j < baseperiod; j++) {
+      profile[j] = grouparray[j*FFA_INTERLEAVE + lane];
     }
+  }
+
+  evaluateProfile(outputfile, profilefile, normprofilefile, profile, baseperiod, period, scalefactor, metric, mfsize, pass->scored ? &pass->scores[lane] : NULL, plan->smootharray, plan->format);
+
+  return;
+}
+
+ffadata* foldFFAPlan(ffaPlan* plan, paddedArray* sourcedata, int baseperiod, double rowshift, int* branchcount) {
 
+  // basic validity checks
+  assert(plan != NULL);
+  assert(sourcedata != NULL);
+  assert(branchcount != NULL);
+  assert(getPaddedArrayDataSize(sourcedata) == plan->datasize);
+  assert((baseperiod >= plan->lowperiod - ((plan->oversample == 2) ? 1 : 0)) && (baseperiod < plan->highperiod));
+
+  int layout = plan->layout;
+  int datasize = getPaddedArrayDataSize(sourcedata);
+
+  // need the size of the array to use based on N/n = 2^x
+  int size = power2Resizer(datasize, baseperiod);
+  // only the rows within datasize are ever read from the source (the rest come from zerorow), so the source need not be padded out to size
+  // this lets segmentedFFA() present segments of a larger array as sources in their own right
+  assert(getPaddedArrayDataSize(sourcedata) <= getPaddedArrayFullSize(sourcedata));
+
+  int i, j;
+
+  // setup variables controlling the scale of the FFA
+  int branches = (int)size/baseperiod;
+  int addition_iterations = (int)log2(branches);
+
+  assert(ffaArraySize(layout, branches, baseperiod) <= plan->arraysize);
+
+  // the stage arrays - the first is the source array itself, which is only ever read, and the rest alternate between the two plan buffers
+  ffadata* sumarrays[addition_iterations + 1];
+
+  sumarrays[0] = getPaddedArrayDataArray(sourcedata);
+  for (i = 1; i <= addition_iterations; i++) {
+    sumarrays[i] = plan->buffers[i%2];
   }
 
-  // individual FFA execution should now be complete
+  // NEW SECTION - HANDLES ZERO PADDING ISSUE
+  // If array has been padded out, then a branch of the sourcearray data will contain part data and part zeroes, causing baseline jumps and false detections
+  // This row must be treated as entirely zeroes, as must every row after it - rather than modifying a copy of the source array,
+  // the first addition stage reads all rows from datarows onwards from a row of zeroes
+  int datarows = ffaDataRows(datasize, baseperiod, rowshift);
+
+  // run the addition stages depth-first over cache-sized blocks of rows (see blockedFFA)
+  blockedFFA(sumarrays, layout, baseperiod, addition_iterations, 0, datarows, rowshift, plan->zerorow);
+
+  // all addition stages are complete
+  ffadata* finalarray = sumarrays[addition_iterations];
+
+  if (addition_iterations == 0) {
+    // with a single branch there are no additions, and the final profile would be the source row itself
+    // evaluation can modify profiles in place, so work on a copy of it in the requested layout instead
+    ffadata* sourcerow = (datarows == 0) ? plan->zerorow : sumarrays[0];
+    finalarray = plan->buffers[0];
+    for (j = 0; j < baseperiod; j++) {
+      finalarray[j*ffaStride(layout)] = sourcerow[j];
+    }
+  }
 
-  // free memory - but don't delete the original array that is part of the paddedArray struct
+  *branchcount = branches;
+
+  return finalarray;
+}
 
-  for (i = 0; i <= addition_iterations; i++) {
-    free(sumarrays[i]);
+void evaluateProfile(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, ffadata* profile, int baseperiod, double period, int scalefactor, double (*metric)(ffadata*, int, int), int mfsize, double* score, ffadata* smootharray, int format) {
+
+  assert(outputfile != NULL);
+  assert(profile != NULL);
+
+  // period is the tested period in units of (downsampled) samples
+  double result;
+
+  if (score != NULL) {
+    // already evaluated as part of an interleaved group
+    result = *score;
+  } else {
+    // normalise the profile for post-MAD
+    //postMadProfileNormaliser(profile, 0, baseperiod, branches);
+    if (mfsize > 0) {
+      mfsmootherWork(profile, 0, baseperiod, mfsize, smootharray);
+    }
+    result = metric(profile, 0, baseperiod);
   }
+
+  periodogramRow row;
+  row.period = period*scalefactor;
+  row.scalefactor = scalefactor;
+  row.dsperiod = period;
+  row.metric = result;
+  writePeriodogramRow(outputfile, format, &row);
+
+  // PROFILE DUMP
+  if ((profilefile != NULL)) {
+    profiledump(profilefile, period*scalefactor, scalefactor, profile, 0, baseperiod);
+  }
+  // Alternatively, dump normalised profiles (don't need to worry about copying the profile as it is not used again)
+  if ((normprofilefile != NULL)) {
+    // normalise the profiles using MAD
+    mad(profile, baseperiod);
+    profiledump(normprofilefile, period*scalefactor, scalefactor, profile, 0, baseperiod);
+  }
+
   return;
 }
 
+static int interleavedMetric(double (*metric)(ffadata*, int, int), ffadata* grouparray, int subsize, int lanes, double* scores) {
+
+  if (metric == basicMetric) {
+    basicMetricInterleaved(grouparray, subsize, lanes, scores);
+  } else if (metric == maxminMetric) {
+    maxminMetricInterleaved(grouparray, subsize, lanes, scores);
+  } else {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
 // prints out the full profiles produced by an FFA folding sequence to specified filestream
 // Format will be "TrialPeriod(%.10f) ScaleFactor(%d) Bin1(%d) Bin2(%d) etc..."
 void profiledump(FILE* profilefile, double period, int scalefactor, ffadata* sourcearray, int startpos, int subsize) {
@@ -332,6 +928,21 @@ void mfsmoother(ffadata* sourcearray, int startpos, int subsize, int smoothsize)
   // need a copy of the array to store intermediate results
   ffadata* copyarray = (ffadata*)malloc(sizeof(ffadata) * subsize);
 
+  mfsmootherWork(sourcearray, startpos, subsize, smoothsize, copyarray);
+
+  // cleanup
+  free(copyarray);
+
+  return;
+
+}
+
+void mfsmootherWork(ffadata* sourcearray, int startpos, int subsize, int smoothsize, ffadata* copyarray) {
+
+  // validity checks
+  assert(sourcearray != NULL);
+  assert(copyarray != NULL);
+
   // run a loop through the folded profile to execute the smoothing
   int i;
   
@@ -360,9 +971,6 @@ void mfsmoother(ffadata* sourcearray, int startpos, int subsize, int smoothsize)
     sourcearray[i+startpos] = copyarray[i];
   }
 
-  // cleanup
-  free(copyarray);
-
   return;
 
 }
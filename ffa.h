@@ -1,15 +1,30 @@
 // Header for fucntions directly related to FFA execution
 // Andrew Cameron, MPIFR, 14/04/2015
 
-// LAST MODIFIED 16/09/2015
+// LAST MODIFIED 19/10/2026
 // Changelog
 // 08/09/2015 - Modified structure of profiledump() to dump out full FFA profile information in custom format
 // 16/09/2015 - Modified structure of massFFA() and singleFFA() to be able to dump out normalised profile data as part of profiledump
+// 19/10/2026 - Added ffaStage() and blockedFFA() for the cache-blocked addition schedule
+//            - Added a selectable layout for the FFA work arrays (profile-major rows or bin-major interleaved groups), passed through massFFA() and singleFFA()
+//            - ffaStage() and blockedFFA() can now substitute a single masked source row with zeroes, so singleFFA() no longer needs its own copy of the source array
+//            - Added the ffaPlan workspace (createFFAPlan(), runFFAPlan(), deleteFFAPlan()), and mfsmootherWork() for smoothing without allocation
+//            - Plan buffers now come from hugeAlloc()
+//            - Added rangeFFA() for running consecutive base periods, optionally across threads. massFFA() takes the periodogram format and thread count
+//            - Added the oversample factor (half-step trials) to ffaPlan, rangeFFA() and massFFA(), and ffaSourceRow() / ffaDataRows() for fractionally spaced source rows
+//            - ffaStage() and blockedFFA() now read every source row from datarows onwards as zeroes, and take the spacing of the source rows
+//            - Added foldFFAPlan(). massFFA() takes the number of segments to split the data into and how to combine them (see segmentffa.h)
+//            - massFFA() now carries out a searchPlan (see searchplan.h) rather than taking the period range and preliminary downsamples itself
+//            - Added the FFA_TRIM_* modes for skipping the repeated last trial of each base period, set on a plan with trimFFAPlan() and passed through rangeFFA()
+//            - Half-step trials are now assigned to the base period they fall in (FFA_HALFSTEP_SHIFT, ffaHalfStepRows(), ffaHalfSteps()),
+//              and plans running them keep spare and carry buffers for the standard profiles and the previous half-step fold
+//            - runFFAPlan() no longer reports each base period - serial rangeFFA() and singleFFA() still do, threaded runs report per octave only
 
 #include <stdio.h>
 #include <stdlib.h>
 #include "ffadata.h"
 #include "paddedarray.h"
+#include "searchplan.h"
 
 #ifndef FFA_H
 #define FFA_H
@@ -17,16 +32,140 @@
 #define TRUE 1
 #define FALSE 0
 
+// Working set (in bytes, summed over all stage arrays) below which blockedFFA runs every remaining addition stage of a block of rows back to back
+// Sized to sit comfortably inside a typical per-core L2 cache
+#define FFA_BLOCK_BYTES (256*1024)
+
+// Layouts of the FFA work arrays
+// FFA_LAYOUT_ROW - each profile (row) is stored contiguously, at row*baseperiod
+// FFA_LAYOUT_INTERLEAVED - groups of FFA_INTERLEAVE profiles are stored bin by bin, so that bin b of every profile in a group is contiguous (for SIMD scoring)
+#define FFA_LAYOUT_ROW 1
+#define FFA_LAYOUT_INTERLEAVED 2
+#define FFA_INTERLEAVE 8
+
+// Which trials to skip - the last trial of base period p (a period of exactly p + 1) repeats the first trial of base period p + 1
+// FFA_TRIM_NONE - every trial is evaluated
+// FFA_TRIM_REPEATS - the last trial of every base period is skipped
+// FFA_TRIM_KEEP_END - as FFA_TRIM_REPEATS, except for the last base period of the range, which ends the search
+#define FFA_TRIM_NONE 0
+#define FFA_TRIM_REPEATS 1
+#define FFA_TRIM_KEEP_END 2
+
+// Half-step trials fall halfway between the standard trials of a base period. Source rows can only start on whole samples, so they come from a
+// second fold with the source rows spaced baseperiod + FFA_HALFSTEP_SHIFT samples apart, which tests baseperiod + 0.5 + k/(branches - 1).
+// Those trials run half a period past the end of the base period, so base period p takes its half-step trials in [p, p + 0.5) from the upper
+// rows of the half-step fold of p - 1, and those in [p + 0.5, p + 1) from the lower rows of its own - every trial of a base period then lies
+// in [p, p + 1] and the periodogram stays sorted by period
+#define FFA_HALFSTEP_SHIFT 0.5
+
+// An ffaPlan is the workspace for running FFAs over a range of base periods [lowperiod, highperiod) on data with datasize real samples
+// It is built once (per octave, say) and reused for every base period in the range, so that running the FFA itself does no allocation
+// arraysize is the largest stage array any base period in the range needs - the addition stages alternate between the two buffers
+// zerorow, profile and smootharray are highperiod - 1 elements long, used for the masked partial row, gathering interleaved profiles and the matched filter
+// With half-step trials, spare holds the standard profiles while the half-step folds run, and carry keeps the half-step fold of carryperiod
+// (the last base period run) for the next base period to reuse - both are NULL without half-step trials
+typedef struct ffaPlan {
+  int layout;
+  int format; // periodogram format written by runFFAPlan (see periodogram.h)
+  int oversample; // 1 for the standard FFA, 2 to add half-step trials (see FFA_HALFSTEP_SHIFT)
+  int trim; // TRUE if runFFAPlan skips the last trial of each base period
+  int keepperiod; // base period whose last trial is evaluated regardless of trim (-1 for none)
+  int datasize;
+  int lowperiod;
+  int highperiod;
+  int arraysize;
+  ffadata* buffers[2];
+  ffadata* spare;
+  ffadata* carry;
+  int carryperiod; // base period of the half-step fold in carry (-1 for none)
+  paddedArray* carrysource; // source data it was folded from
+  ffadata* zerorow;
+  ffadata* profile;
+  ffadata* smootharray;
+} ffaPlan;
+
 // ***** FUNCTION PROTOTYPES *****
 
 // adds together the elements of two subarrays of the source array after sliding the contents of the second array by a set amount, then stores the result in a third subarray of result array
 void slideAdd(ffadata* sourcearray, ffadata* resultarray, int sourcesubstartpos1, int sourcesubstartpos2, int resultsubstart, int subsize, int slide);
 
-// Oversight function for the FFA
-void massFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, int lowperiod, int highperiod, double (*metric)(ffadata*, int, int), int mfsize, int prelim_ds, FILE* redfile, int PRESTO_flag, int timenorm_flag);
+// as slideAdd, but for rows whose consecutive bins are separated by a stride (as in the interleaved layout) - rows are passed by the address of their first bin
+void stridedSlideAdd(ffadata* source1, ffadata* source2, int sourcestride, ffadata* result, int resultstride, int subsize, int slide);
+
+// returns the number of elements needed to store branches rows of baseperiod bins in the given layout
+int ffaArraySize(int layout, int branches, int baseperiod);
+
+// returns the address of the first bin of a row in the given layout
+ffadata* ffaRow(ffadata* array, int layout, int row, int baseperiod);
+
+// returns the address of a source row when rows start baseperiod + rowshift samples apart (rounded down to a whole sample) - same as ffaRow if rowshift is 0
+ffadata* ffaSourceRow(ffadata* array, int layout, int row, int baseperiod, double rowshift);
+
+// returns the number of complete baseperiod long source rows, spaced baseperiod + rowshift samples apart, within datasize samples
+int ffaDataRows(int datasize, int baseperiod, double rowshift);
+
+// returns the distance between consecutive bins of a row in the given layout
+int ffaStride(int layout);
+
+// performs the additions of a single FFA stage (segments of 2^stage rows) for the rows [firstrow, firstrow + rows) - rows must be a multiple of 2^stage
+// if datarows is not negative, rows of startarray from datarows onwards are read from zerorow instead (pass -1 and NULL for no masking)
+// rows of a profile-major startarray start baseperiod + rowshift samples apart (see ffaSourceRow) - rowshift must be 0 for any other start array
+void ffaStage(ffadata* startarray, int startlayout, ffadata* endarray, int endlayout, int baseperiod, int stage, int firstrow, int rows, int datarows, double rowshift, ffadata* zerorow);
+
+// brings the 2^stage rows starting at firstrow up to the given stage, working depth-first so that blocks of rows stay cache resident across stages
+// sumarrays[0] must hold the source rows (profile-major), sumarrays[1..stage] receive the results of each stage in the given layout
+// source rows from datarows onwards (if datarows is not negative) are treated as zeroes via zerorow - sumarrays[0] itself is never written to
+// source rows start baseperiod + rowshift samples apart
+void blockedFFA(ffadata** sumarrays, int layout, int baseperiod, int stage, int firstrow, int datarows, double rowshift, ffadata* zerorow);
+
+// Oversight function for the FFA - runs every octave of the search plan in turn, preparing the downsampled (and de-reddened, if the red flag is set) data once per octave
+void massFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, searchPlan* searchplan, double (*metric)(ffadata*, int, int), int mfsize, FILE* redfile, int PRESTO_flag, int timenorm_flag, int layout, int format, int oversample, int threads, int segments, int segmode);
 
-// Runs a single FFA for one baseperiod
-void singleFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, int baseperiod, double (*metric)(ffadata*, int, int), int mfsize);
+// Runs the FFA for base periods firstperiod to firstperiod + trials - 1 on the same source data, split across the given number of threads
+// Output is always written in base period order, identical to a run with a single thread
+// trim is one of the FFA_TRIM_* modes
+void rangeFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, int firstperiod, int trials, double (*metric)(ffadata*, int, int), int mfsize, int layout, int format, int oversample, int threads, int trim);
+
+// Runs a single FFA for one baseperiod (through a one-off plan - use runFFAPlan() when running many base periods)
+void singleFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, int baseperiod, double (*metric)(ffadata*, int, int), int mfsize, int layout);
+
+// Allocates an FFA plan for base periods [lowperiod, highperiod) on data with datasize real samples, writing periodograms in the given format
+// oversample is 1 for the standard FFA or 2 to add half-step trials (which also fold lowperiod - 1). Free with deleteFFAPlan().
+ffaPlan* createFFAPlan(int datasize, int lowperiod, int highperiod, int layout, int format, int oversample);
+
+// sets which trials runFFAPlan skips (one of the FFA_TRIM_* modes) - lastperiod is the last base period the plan will run, kept under FFA_TRIM_KEEP_END
+// plans are created with FFA_TRIM_NONE
+void trimFFAPlan(ffaPlan* plan, int trim, int lastperiod);
+
+// returns the number of trials of a base period that are evaluated, out of the branches folded
+int ffaEvaluatedBranches(ffaPlan* plan, int baseperiod, int branches);
+
+// the rows firstrow to lastrow - 1 of the half-step fold of a base period (with the given number of branches) that are half-step trials
+// of the next base period if upper is TRUE, or of the base period itself if not
+void ffaHalfStepRows(int branches, int upper, int* firstrow, int* lastrow);
+
+// returns the number of half-step trials of a base period on data with datasize samples
+int ffaHalfSteps(int datasize, int baseperiod);
+
+// cleans up an FFA plan and all of the buffers it owns
+void deleteFFAPlan(ffaPlan* plan);
+
+// returns a zeroed buffer of size elements from hugeAlloc(), touched by the calling thread - release with hugeFree()
+ffadata* ffaPlanBuffer(int size);
+
+// Runs the FFA for one baseperiod using the workspace of a plan - sourcedata must have the datasize the plan was built for
+// Any half-step trials are written between the standard trials they fall between, so the trials are always written in period order
+// The half-step fold of the previous base period is reused if the plan last ran baseperiod - 1 on the same sourcedata, which must not have changed since
+void runFFAPlan(ffaPlan* plan, FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, int baseperiod, double (*metric)(ffadata*, int, int), int mfsize);
+
+// Runs the addition stages of a single FFA pass (source rows spaced baseperiod + rowshift samples apart) using the workspace of a plan, without evaluating anything
+// Returns the final array of folded profiles (in the plan's layout, belonging to the plan and only valid until its next use) and its number of profiles via branchcount
+ffadata* foldFFAPlan(ffaPlan* plan, paddedArray* sourcedata, int baseperiod, double rowshift, int* branchcount);
+
+// evaluates one folded profile (contiguous, baseperiod bins long) and writes it out to the periodogram and any profile dumps
+// if score is not NULL the profile has already been evaluated and the matched filter / metric are skipped
+// smootharray is baseperiod elements of scratch space for the matched filter, format is the periodogram format to write
+void evaluateProfile(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, ffadata* profile, int baseperiod, double period, int scalefactor, double (*metric)(ffadata*, int, int), int mfsize, double* score, ffadata* smootharray, int format);
 
 // prints out the full profiles produced by an FFA folding sequence to specified filestream
 // Format will be "TrialPeriod(%.10f) ScaleFactor(%d) Bin1(%d) Bin2(%d) etc..."
@@ -36,4 +175,7 @@ void profiledump(FILE* profilefile, double period, int scalefactor, ffadata* sou
 // smoothsize is in sample units
 void mfsmoother(ffadata* sourcearray, int startpos, int subsize, int smoothsize);
 
+// as mfsmoother, but uses the given copyarray (at least subsize elements) for its intermediate results rather than allocating one
+void mfsmootherWork(ffadata* sourcearray, int startpos, int subsize, int smoothsize, ffadata* copyarray);
+
 #endif /* FFA_H */
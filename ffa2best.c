@@ -4,14 +4,15 @@
 #include <time.h>
 #include <math.h>
 #include <assert.h>
+#include <pthread.h>
 
 // user defined libraries
 #include "equalstrings.h"
+#include "periodogram.h"
 
 #define TRUE 1
 #define FALSE 0
 
-#define HEADER_STRINGS 13
 #define DCMAX_MAD_ALG 50
 #define DCMAX_KOND_ALG 20
 
@@ -19,10 +20,13 @@
 #define MAD_ALG 1
 #define KOND_ALG 2
 
+// longest line accepted from a -list file
+#define LIST_LINE_SIZE 4096
+
 // Program to convert ffa periodogram output from FFAncy into BEST format files
 // Based upon the tcsh script ffa2best.csh
 // Written by Andrew Cameron
-// Version 1.2.4 - Last updated 14/06/2017
+// Version 1.4.2 - Last updated 19/10/2026
 
 // CHANGELOG
 // 26/04/2016 - v1.1.0 - Added a candidate combiner (algorithm dependent), which groups together nearby peaks that are likely to be related.
@@ -35,6 +39,47 @@
 //                     - Changed accepted algorithms from 6 & 7 to 1 & 2 as per paper notation
 // 14/06/2017 - v1.2.4 - Bug fix - a value of 64us time sampling was hardcoded into several locations of the code, causing other values of tsamp to be converted incorrectly.
 //                     - Locations identified and corrected so as to use the runtime tsamp instead of the default 64 us.
+// 19/10/2026 - v1.3.0 - Peak combining now takes peaks in SNR order and finds each window by binary search over the peaks sorted by period, skipping peaks already removed,
+//                       rather than rescanning every peak for each one (results are unchanged). Peaks are stored on the heap rather than the stack.
+//                     - -ranked output is sorted rather than selected one peak at a time.
+//                     - Harmonic matching works out its prime fractions once, and finds the peaks near each harmonic of a peak by binary search rather than
+//                       testing every remaining peak against every fraction (results are unchanged).
+//                     - Peaks are passed between stages in memory rather than through the temporary files ffa2best.temp1.prd and ffa2best.temp2.prd,
+//                       so several conversions can run in the same directory at once. No peaks above threshold now gives an empty BEST file rather than an abort.
+// 19/10/2026 - v1.4.0 - Added batch mode: any number of periodograms (repeated -i, or -list) converted across -threads, with the DM of each taken from the list,
+//                       a sidecar file or the file name. Writes a BEST file per periodogram into -outdir, or a single -merged candidate table.
+// 19/10/2026 - v1.4.1 - Periodograms are read through periodogram.h, so binary periodograms (ffancy -binary) are accepted as well as text ones.
+//                       A row that cannot be read now stops the conversion of that periodogram with an error, rather than being retried forever.
+// 19/10/2026 - v1.4.2 - A periodogram whose last row is cut short is rejected rather than read up to the cut. Batch mode exits with an error before
+//                       starting if two periodograms would share a BEST file, and with EXIT_FAILURE if any periodogram could not be converted.
+
+// ***** DATA TYPES *****
+
+// the peaks passed between each stage of the conversion
+// periods are in ms and snrs in units of SNR, both rounded to the precision of the BEST format
+typedef struct peakList {
+  double *periods;
+  double *snrs;
+  int npeaks;
+  int capacity;
+} peakList;
+
+// the conversion options shared by every periodogram
+typedef struct bestSettings {
+  float acc;
+  float thresh;
+  float lthresh;
+  float dthresh;
+  float tsamp;
+  float pulsar_dc;
+  float max_dc;
+  float tobs;
+  int highprime;
+  float tolerance;
+  int combine_flag;
+  int harmonic_flag;
+  int ranked_flag;
+} bestSettings;
 
 // ***** FUNCTION PROTOTYPES *****
 
@@ -44,20 +89,67 @@ void help();
 // writes out a peak to file
 void writePeak(FILE *file, double period, double snr, float tsamp);
 
-// reads a peak from a file - basically a mask for fscanf
-int readPeak(FILE *file, double *period, double *snr);
+// creates an empty peak list - clean up with deletePeakList()
+peakList* createPeakList();
+
+// cleans up a peak list
+void deletePeakList(peakList* peaks);
+
+// adds a peak (period in samples) to the end of a peak list, rounded exactly as writePeak() would write it
+void addPeak(peakList* peaks, double period, double snr, float tsamp);
+
+// extracts the raw peaks of a periodogram (text or binary) and adds them to a peak list - returns the number of peaks found,
+// or -1 if the periodogram contains a row that cannot be read
+int rawPeakFinder(FILE *inputfile, peakList* peaks, double thresh, double lthresh, double dthresh, float tsamp);
+
+// conducts the peak combining process, also includes the harmonic process if activated, and reduces the peak list to the remaining peaks - returns their number
+int peakCombiner(peakList* peaks, float pulsar_dc, float max_dc, float tobs, float tsamp, int harmonic_flag, int highprime, float tolerance);
+
+// fills order with the positions of the peaks from highest to lowest SNR, keeping equal SNRs in their original order
+void rankPeaks(double *snrs, int npeaks, int *order);
 
-// extracts the raw peaks and stores them in a file - returns the number of peaks found
-int rawPeakFinder(FILE *inputfile, FILE *outputfile, double thresh, double lthresh, double dthresh, float tsamp);
+// fills order with the positions of the peaks from lowest to highest period
+void periodOrder(double *periods, int npeaks, int *order);
 
-// conducts the peak combining process, also includes the harmonic process if activated, returns number of peaks remaining
-int peakCombiner(FILE *inputfile, FILE *outputfile, int npeaks, float pulsar_dc, float max_dc, float tobs, float tsamp, int harmonic_flag, int highprime, float tolerance);
+// fills order with the positions of the peaks from lowest to highest SNR, keeping equal SNRs in their original order
+void weakestFirst(double *snrs, int npeaks, int *order);
+
+// returns the first position in period order whose peak lies within window of centre (or after it, if none do) - found by binary search
+int windowStart(double *periods, int *order, int npeaks, double centre, double window);
+
+// follows a skip list to the first unchecked position at or after position, compressing the path it takes
+int nextUnchecked(int *skip, int position);
 
 // calculates the combining window around a given peak
 double peakWindow(double period, double tobs, double pulsar_dc, double max_dc);
 
+// finds the peaks of one periodogram, combining them if requested - returns FALSE if the periodogram could not be read
+int findBestPeaks(FILE *inputfile, peakList* peaks, bestSettings* settings);
+
+// writes out a complete BEST file for a set of peaks found at the given DM
+void writeBestFile(FILE *outputfile, peakList* peaks, float dm, bestSettings* settings);
+
+// writes the peaks of one periodogram to the merged candidate table, one "DM SNR Period(ms) Periodogram" row each
+void mergedWriter(FILE *outputfile, peakList* peaks, float dm, char *name, int ranked);
+
+// adds a periodogram (and the DM listed with it, or NULL) to the batch list, growing it if needed - returns the new number of periodograms
+int addInput(char ***names, char ***dms, int *capacity, int ninputs, char *name, char *dm);
+
+// adds every periodogram named in a list file (one "name [DM]" per line) to the batch list - returns the new number of periodograms
+int addInputList(char ***names, char ***dms, int *capacity, int ninputs, char *listname);
+
+// works out the DM of a periodogram - from the list file, then a sidecar file (name.dm), then the number following dmtag in the file name, then default_dm
+float batchDM(char *name, char *listed_dm, char *dmtag, float default_dm);
+
+// returns the name of the BEST file for a periodogram in outdir - WARNING: RETURNS HEAP ALLOCATED MEMORY WHICH SHOULD BE FREED
+char* bestFileName(char *name, char *outdir);
+
+// converts a batch of periodograms across the given number of threads, writing a BEST file for each into outdir, or one merged table if mergedfile is set
+// exits if two periodograms would be written to the same BEST file - returns the number of periodograms that could not be converted
+int batchFFA2Best(char **names, char **listed_dms, int ninputs, char *dmtag, float default_dm, char *outdir, FILE *mergedfile, int threads, bestSettings *settings);
+
 // writes the peaks out to file in a ranked or unranked fashion
-void rankedWriter(FILE *inputfile, FILE *outputfile, int npeaks, float tsamp, int ranked);
+void rankedWriter(peakList* peaks, FILE *outputfile, float tsamp, int ranked);
 
 // calculates the next prime number after the one given
 int nextPrime(int prime);
@@ -65,38 +157,50 @@ int nextPrime(int prime);
 // returns TRUE or FALSE depending on whether two periods match the provided ratio to within the provided tolerance
 int harmonicMatch(double sourceperiod, double checkperiod, double ratio, double tolerance);
 
+// returns every fraction numdom/prime (and its inverse) for primes up to highprime and 0 < numdom < prime - WARNING: RETURNS HEAP ALLOCATED MEMORY WHICH SHOULD BE FREED
+// fractions below 1 are matched against shorter periods and their inverses against longer ones. The number of fractions is returned via nratios.
+double* harmonicRatios(int highprime, int *nratios);
+
+// returns TRUE if any peak reachable through the skip list is a harmonic of period for one of the ratios, to within tolerance (percent)
+int harmonicSearch(double *periods, int *order, int *skip, int npeaks, double period, double *ratios, int nratios, double tolerance);
+
 // ***** MAIN FUNCTION *****
 
 int main (int argc, char** argv) {
 
   // declare variables and initialise with defaults
-  FILE *inputfile = NULL;
   FILE *outputfile = NULL;
-  char tempname1[] = "ffa2best.temp1.prd";
-  char tempname2[] = "ffa2best.temp2.prd";
-  FILE *tempfile1 = NULL;
-  FILE *tempfile2 = NULL;
+  FILE *mergedfile = NULL;
+  char **inputnames = NULL;
+  char **inputdms = NULL;
+  int ninputs = 0;
+  int capacity = 0;
+  char *dmtag = "DM";
+  char *outdir = ".";
+  int threads = 1;
   float dm = 0;
-  float acc = 0;
-  float thresh = 10;
-  float lthresh = thresh - 1;
-  float dthresh = 0.2;
-  float tsamp = 64; // units of microseconds
-  float pulsar_dc = 1;
-  float max_dc = DCMAX_MAD_ALG;
-  float tobs = 4300;
   int algorithm = MAD_ALG;
-  int highprime = 3;
-  float tolerance = 1;
+  bestSettings settings;
+  settings.acc = 0;
+  settings.thresh = 10;
+  settings.lthresh = settings.thresh - 1;
+  settings.dthresh = 0.2;
+  settings.tsamp = 64; // units of microseconds
+  settings.pulsar_dc = 1;
+  settings.max_dc = DCMAX_MAD_ALG;
+  settings.tobs = 4300;
+  settings.highprime = 3;
+  settings.tolerance = 1;
 
   // flags
-  int COMBINE_FLAG = FALSE;
-  int HARMONIC_FLAG = FALSE;
-  int RANKED_FLAG = FALSE;
+  settings.combine_flag = FALSE;
+  settings.harmonic_flag = FALSE;
+  settings.ranked_flag = FALSE;
   
 
   // counters
   int i;
+  int failures = 0;
 
   // scan arguments and allocate variables
   if (argc > 1) {
@@ -104,50 +208,65 @@ int main (int argc, char** argv) {
     while (i < argc) {
       if (equal_strings(argv[i],"-i")) {
         i++;
-        inputfile = fopen(argv[i], "r");
+        ninputs = addInput(&inputnames, &inputdms, &capacity, ninputs, argv[i], NULL);
+      } else if (equal_strings(argv[i],"-list")) {
+        i++;
+        ninputs = addInputList(&inputnames, &inputdms, &capacity, ninputs, argv[i]);
       } else if (equal_strings(argv[i],"-o")) {
         i++;
         outputfile = fopen(argv[i], "w+");
+      } else if (equal_strings(argv[i],"-outdir")) {
+        i++;
+        outdir = argv[i];
+      } else if (equal_strings(argv[i],"-merged")) {
+        i++;
+        mergedfile = fopen(argv[i], "w+");
+      } else if (equal_strings(argv[i],"-dmtag")) {
+        i++;
+        dmtag = argv[i];
+      } else if (equal_strings(argv[i],"-threads")) {
+        i++;
+        threads = atoi(argv[i]);
       } else if (equal_strings(argv[i],"-dm")) {
         i++;
         dm = atof(argv[i]);
       } else if (equal_strings(argv[i],"-a")) {
         i++;
-        acc = atof(argv[i]);
+        settings.acc = atof(argv[i]);
       } else if (equal_strings(argv[i],"-tsamp")) {
         i++;
-        tsamp = atof(argv[i]);
-	printf("tsamp = %f\n", tsamp);
+        settings.tsamp = atof(argv[i]);
+	printf("tsamp = %f\n", settings.tsamp);
       } else if (equal_strings(argv[i],"-thresh")) {
 	i++;
-	thresh = atof(argv[i]);
+	settings.thresh = atof(argv[i]);
       } else if (equal_strings(argv[i],"-lthresh")) {
 	i++;
-	lthresh = atof(argv[i]);
+	settings.lthresh = atof(argv[i]);
       } else if (equal_strings(argv[i],"-dthresh")) {
         i++;
-        dthresh = atof(argv[i])/100;
+        settings.dthresh = atof(argv[i])/100;
       } else if (equal_strings(argv[i],"-combine")) {
-        COMBINE_FLAG = TRUE;
+        settings.combine_flag = TRUE;
       } else if (equal_strings(argv[i],"-dc")) {
         i++;
-        pulsar_dc = atof(argv[i]);
+        settings.pulsar_dc = atof(argv[i]);
       } else if (equal_strings(argv[i],"-algorithm")) {
         i++;
         algorithm = atoi(argv[i]);
       } else if (equal_strings(argv[i],"-tobs")) {
         i++;
-        tobs = atof(argv[i]);
+        settings.tobs = atof(argv[i]);
       } else if (equal_strings(argv[i],"-harmonics")) {
-        HARMONIC_FLAG = TRUE;
+        settings.harmonic_flag = TRUE;
       } else if (equal_strings(argv[i],"-ranked")) {
-        RANKED_FLAG = TRUE;
+        settings.ranked_flag = TRUE;
       } else if (equal_strings(argv[i],"-highprime")) {
         i++;
-        highprime = atoi(argv[i]);
+        settings.highprime = atoi(argv[i]);
       } else if (equal_strings(argv[i],"-tolerance")) {
         i++;
-        tolerance = atof(argv[i]);
+        settings.tolerance = atof(argv[i]);
       } else if (equal_strings(argv[i], "-h") || equal_strings(argv[i], "--help")) {
         help();
         exit(0);
@@ -162,104 +281,88 @@ int main (int argc, char** argv) {
     exit(0);
   }
 
+  // more than one periodogram, or an explicit choice of batch output, runs in batch mode
+  int batch_flag = ((ninputs > 1) || (mergedfile != NULL)) ? TRUE : FALSE;
+
   // test for valid input
-  assert(inputfile != NULL);
-  assert(outputfile != NULL);
+  assert(ninputs > 0);
+  assert((batch_flag == TRUE) || (outputfile != NULL));
   assert(dm >= 0);
-  assert(acc >= 0);
-  assert(tsamp > 0);
-  assert(thresh > 0);
-  assert(thresh > lthresh);
-  assert(dthresh < 1);
-  assert(tobs > 0);
-  assert(pulsar_dc >= 0);
+  assert(settings.acc >= 0);
+  assert(settings.tsamp > 0);
+  assert(settings.thresh > 0);
+  assert(settings.thresh > settings.lthresh);
+  assert(settings.dthresh < 1);
+  assert(settings.tobs > 0);
+  assert(settings.pulsar_dc >= 0);
   assert(algorithm == MAD_ALG || algorithm == KOND_ALG);
+  if ((batch_flag == TRUE) && (outputfile != NULL)) {
+    printf("-o names the output of a single periodogram - use -outdir or -merged with several periodograms.\n");
+    exit(0);
+  }
+  if (threads < 1) {
+    printf("Number of threads must be at least 1!\n");
+    exit(0);
+  }
 
   // setup the algorithm max_dc if selected
   if (algorithm == MAD_ALG) {
-    max_dc = DCMAX_MAD_ALG;
+    settings.max_dc = DCMAX_MAD_ALG;
   } else if (algorithm == KOND_ALG) {
-    max_dc = DCMAX_KOND_ALG;
+    settings.max_dc = DCMAX_KOND_ALG;
   }
 
   // echo input back to user to verify
-  printf("Launching ffa2best: DM = %.2f | ACC = %.2f | TSAMP = %.2f | THRESHOLD = %.2f | LOWER THRESHOLD = %.2f | DYNAMINC THRESHOLD = %.2f\n", dm, acc, tsamp, thresh, lthresh, dthresh);
-  if (COMBINE_FLAG == TRUE) {
-    printf("PEAK COMBINING ACTIVATED: Pulsar DC = %.2f | Algorithm = %d | Tobs = %.3f\n", pulsar_dc, algorithm, tobs);
+  if (batch_flag == FALSE) {
+    printf("Launching ffa2best: DM = %.2f | ACC = %.2f | TSAMP = %.2f | THRESHOLD = %.2f | LOWER THRESHOLD = %.2f | DYNAMINC THRESHOLD = %.2f\n", dm, settings.acc, settings.tsamp, settings.thresh, settings.lthresh, settings.dthresh);
+  } else {
+    printf("Launching ffa2best: %d PERIODOGRAMS | THREADS = %d | ACC = %.2f | TSAMP = %.2f | THRESHOLD = %.2f | LOWER THRESHOLD = %.2f | DYNAMINC THRESHOLD = %.2f\n", ninputs, threads, settings.acc, settings.tsamp, settings.thresh, settings.lthresh, settings.dthresh);
+  }
+  if (settings.combine_flag == TRUE) {
+    printf("PEAK COMBINING ACTIVATED: Pulsar DC = %.2f | Algorithm = %d | Tobs = %.3f\n", settings.pulsar_dc, algorithm, settings.tobs);
   }
-  if (HARMONIC_FLAG == TRUE) {
-    printf("HARMONIC MATCHING ACTIVATED: High prime = %d | Tolerance = %.5f\n", highprime, tolerance);
+  if (settings.harmonic_flag == TRUE) {
+    printf("HARMONIC MATCHING ACTIVATED: High prime = %d | Tolerance = %.5f\n", settings.highprime, settings.tolerance);
   }
 
-  // print first line of outputfile to output
-  fprintf(outputfile, " DM:   %.5f      AC:   %.6f      AD:   0.00000000\n", dm, acc);
+  if (batch_flag == FALSE) {
 
-  // prepare the tempfiles for use
-  tempfile1 = fopen(tempname1, "w+");
-  assert(tempfile1 != NULL);
-  
-  // conduct the first scan to get peaks
-  int peaks = rawPeakFinder(inputfile, tempfile1, thresh, lthresh, dthresh, tsamp);
-  fclose(tempfile1);
+    FILE *inputfile = fopen(inputnames[0], "r");
+    assert(inputfile != NULL);
 
-  // reopen tempfile1 to be read
-  tempfile1 = fopen(tempname1, "r");
-  assert(tempfile1 != NULL);
+    // every stage works on the same list of peaks in memory
+    peakList* peaks = createPeakList();
+    if (findBestPeaks(inputfile, peaks, &settings) == FALSE) {
+      printf("ERROR: Unable to read periodogram %s.\n", inputnames[0]);
+      exit(EXIT_FAILURE);
+    }
+    writeBestFile(outputfile, peaks, dm, &settings);
+    deletePeakList(peaks);
 
-  // now check for the combine flag
-  if (COMBINE_FLAG == TRUE) {
+    // I/O complete
+    fclose(inputfile);
+    fclose(outputfile);
 
-    tempfile2 = fopen(tempname2, "w+");
-    assert(tempfile2 != NULL);
-  
-    // conduct second pass
-    peaks = peakCombiner(tempfile1, tempfile2, peaks, pulsar_dc, max_dc, tobs, tsamp, HARMONIC_FLAG, highprime, tolerance);
+  } else {
 
-    // close tempfile1 and reallocate pointers
-    fclose(tempfile1);
-    fclose(tempfile2);
-    tempfile1 = fopen(tempname2, "r");
-    assert(tempfile1 != NULL);
-  }
+    failures = batchFFA2Best(inputnames, inputdms, ninputs, dmtag, dm, outdir, mergedfile, threads, &settings);
+    if (mergedfile != NULL) {
+      fclose(mergedfile);
+    }
 
-  // resulting peaks should now be stored in tempfile1
-  // write out to output file, keeping in mind the status of RANKED_FLAG
-  rankedWriter(tempfile1, outputfile, peaks, tsamp, RANKED_FLAG);
+  }
 
-  /*
-  // chose which procedure to follow based on the combine flag
-  if (COMBINE_FLAG == FALSE) {
-    // skip the tempfile and go straight to the outputfile
+  for (i = 0; i < ninputs; i++) {
+    free(inputnames[i]);
+    free(inputdms[i]);
+  }
+  free(inputnames);
+  free(inputdms);
 
-    // conduct the scan
-    rawPeakFinder(inputfile, outputfile, thresh, lthresh, dthresh, tsamp);
-    
-  } else if (COMBINE_FLAG == TRUE) {
-    // first pass writes out to a temporary file which stores the raw peaks before they are later combined
-    // open temp file for writing
-    tempfile = fopen(tempname, "w+");
-    assert(tempfile != NULL);
-
-    // conduct the first scan using the tempfile
-    int peaks = rawPeakFinder(inputfile, tempfile, thresh, lthresh, dthresh, tsamp);
-
-    // first pass now complete - now close tempfile and reopen for reading
-    fclose(tempfile);
-    tempfile = fopen(tempname, "r");
-    assert(tempfile != NULL);
-
-    // conduct candidate combining
-    peakCombiner(tempfile, outputfile, peaks, pulsar_dc, max_dc, tobs, tsamp, HARMONIC_FLAG, highprime, tolerance);
-    
-    // second scan complete
-    fclose(tempfile);
-    
+  if (failures > 0) {
+    printf("ERROR: %d periodogram(s) could not be converted.\n", failures);
+    exit(EXIT_FAILURE);
   }
-  */
- 
-  // I/O complete
-  fclose(inputfile);
-  fclose(outputfile);
   
   return 0;
 
@@ -270,13 +373,13 @@ int main (int argc, char** argv) {
 void help() {
 
   printf("\nffa2best - a program to convert FFAncy periodogram output into BEST format files.\n");
-  printf("Version 1.2.3, last updated 11/09/2016.\n");
+  printf("Version 1.4.2, last updated 19/10/2026.\n");
   printf("Written by Andrew Cameron, MPIFR IMPRS PhD Student.\n");
   printf("\n*****\n\n");
   printf("Input options:\n");
 
-  printf("-i [file]           Name of the periodogram file to be converted.\n");
-  printf("-o [file]           Name of the output file.\n");
+  printf("-i [file]           Name of the periodogram file (text or binary) to be converted. May be given more than once for batch mode.\n");
+  printf("-o [file]           Name of the output file (single periodogram only).\n");
   printf("-dm [float]         The DM at which the periodogram was produced. (default = 0)\n");
   printf("-a [float]          The acceleration at which the periodogram was produced (ms^-2). (default = 0)\n");
   printf("-tsamp [float]      The sample time of the original time series used to produce periodogram (us). (default = 64)\n");
@@ -284,6 +387,15 @@ void help() {
   printf("-lthresh [float]    The lower signal to noise cutoff used to control the separation of separate peaks. Units of SNR. By default set to [thresh] - 1.\n");
   printf("-dthresh [float]    (Optional) The dynaminc threshhold used to control the selection of separate peaks. Units of SNR (percent), eg, 20. (default = 20)\n");
 
+  printf("\n----- Batch options -----\n");
+  printf("-list [file]        File listing periodograms to convert, one per line, each optionally followed by its DM.\n");
+  printf("-dmtag [string]     DMs not given in the list are read from a sidecar file (periodogram name + '.dm'), or else from the number\n");
+  printf("                    following this tag in the periodogram's file name, eg, beam1_DM12.50.prd (default = DM). Otherwise -dm is used.\n");
+  printf("-outdir [dir]       Directory to write a BEST file for each periodogram into, named after the periodogram (default = .).\n");
+  printf("                    Periodograms must have different names, even in different directories.\n");
+  printf("-merged [file]      Writes one table of \"DM SNR Period(ms) Periodogram\" rows for every periodogram instead of individual BEST files.\n");
+  printf("-threads [int]      Number of periodograms converted at once (default = 1). Output is identical for any number of threads.\n");
+
   printf("\n----- Peak combining options -----\n");
   printf("-combine            Stand alone flag which turns on peak combining functionality - following arguments will be otherwise ignored.\n");
   printf("-dc [float]         Duty cycle being searched for (percent), eg, 5. (default = 1)\n");
@@ -304,6 +416,364 @@ void help() {
 
 }
 
+int findBestPeaks(FILE *inputfile, peakList* peaks, bestSettings* settings) {
+
+  assert(inputfile != NULL);
+  assert(peaks != NULL);
+  assert(settings != NULL);
+
+  // conduct the first scan to get peaks
+  if (rawPeakFinder(inputfile, peaks, settings->thresh, settings->lthresh, settings->dthresh, settings->tsamp) < 0) {
+    return FALSE;
+  }
+
+  // now check for the combine flag
+  if (settings->combine_flag == TRUE) {
+    // conduct second pass
+    peakCombiner(peaks, settings->pulsar_dc, settings->max_dc, settings->tobs, settings->tsamp, settings->harmonic_flag, settings->highprime, settings->tolerance);
+  }
+
+  return TRUE;
+
+}
+
+void writeBestFile(FILE *outputfile, peakList* peaks, float dm, bestSettings* settings) {
+
+  assert(outputfile != NULL);
+  assert(peaks != NULL);
+  assert(settings != NULL);
+
+  // print first line of outputfile to output
+  fprintf(outputfile, " DM:   %.5f      AC:   %.6f      AD:   0.00000000\n", dm, settings->acc);
+
+  // write out to output file, keeping in mind the status of RANKED_FLAG
+  rankedWriter(peaks, outputfile, settings->tsamp, settings->ranked_flag);
+
+  return;
+
+}
+
+void mergedWriter(FILE *outputfile, peakList* peaks, float dm, char *name, int ranked) {
+
+  assert(outputfile != NULL);
+  assert(peaks != NULL);
+  assert(name != NULL);
+
+  int ii;
+  int *order = (int*)malloc(sizeof(int) * (peaks->npeaks + 1));
+  assert(order != NULL);
+
+  // same order as the peaks of a BEST file
+  if (ranked == TRUE) {
+    rankPeaks(peaks->snrs, peaks->npeaks, order);
+  } else {
+    for (ii = 0; ii < peaks->npeaks; ii++) {
+      order[ii] = ii;
+    }
+  }
+
+  for (ii = 0; ii < peaks->npeaks; ii++) {
+    fprintf(outputfile, "%.5f %.1f %.8f %s\n", dm, peaks->snrs[order[ii]], peaks->periods[order[ii]], name);
+  }
+
+  free(order);
+  return;
+
+}
+
+int addInput(char ***names, char ***dms, int *capacity, int ninputs, char *name, char *dm) {
+
+  assert(names != NULL);
+  assert(dms != NULL);
+  assert(capacity != NULL);
+  assert(name != NULL);
+
+  if (ninputs == *capacity) {
+    *capacity = (*capacity == 0) ? 64 : 2*(*capacity);
+    *names = (char**)realloc(*names, sizeof(char*) * (*capacity));
+    *dms = (char**)realloc(*dms, sizeof(char*) * (*capacity));
+    assert((*names != NULL) && (*dms != NULL));
+  }
+
+  (*names)[ninputs] = strdup(name);
+  (*dms)[ninputs] = (dm != NULL) ? strdup(dm) : NULL;
+
+  return ninputs + 1;
+
+}
+
+int addInputList(char ***names, char ***dms, int *capacity, int ninputs, char *listname) {
+
+  assert(listname != NULL);
+
+  FILE *listfile = fopen(listname, "r");
+  if (listfile == NULL) {
+    printf("ERROR: Unable to open periodogram list %s.\n", listname);
+    exit(EXIT_FAILURE);
+  }
+
+  // each line holds a periodogram name, optionally followed by its DM
+  char line[LIST_LINE_SIZE];
+  while (fgets(line, LIST_LINE_SIZE, listfile) != NULL) {
+    char *name = strtok(line, " \t\r\n");
+    if ((name == NULL) || (name[0] == '#')) {
+      continue;
+    }
+    char *dm = strtok(NULL, " \t\r\n");
+    ninputs = addInput(names, dms, capacity, ninputs, name, dm);
+  }
+
+  fclose(listfile);
+
+  return ninputs;
+
+}
+
+float batchDM(char *name, char *listed_dm, char *dmtag, float default_dm) {
+
+  assert(name != NULL);
+  assert(dmtag != NULL);
+
+  // 1. a DM given alongside the name in a -list file
+  if (listed_dm != NULL) {
+    return atof(listed_dm);
+  }
+
+  // 2. a sidecar file next to the periodogram
+  char sidecar[LIST_LINE_SIZE];
+  snprintf(sidecar, LIST_LINE_SIZE, "%s.dm", name);
+  FILE *sidecarfile = fopen(sidecar, "r");
+  if (sidecarfile != NULL) {
+    float dm;
+    int found = fscanf(sidecarfile, "%f", &dm);
+    fclose(sidecarfile);
+    if (found == 1) {
+      return dm;
+    }
+  }
+
+  // 3. the number following the last appearance of the tag in the file name (ignoring the directory)
+  char *base = strrchr(name, '/');
+  base = (base == NULL) ? name : base + 1;
+  char *tag = NULL;
+  char *next = strstr(base, dmtag);
+  while (next != NULL) {
+    tag = next;
+    next = strstr(next + 1, dmtag);
+  }
+  if (tag != NULL) {
+    char *end;
+    double dm = strtod(tag + strlen(dmtag), &end);
+    if (end != tag + strlen(dmtag)) {
+      return (float)dm;
+    }
+  }
+
+  // 4. the -dm value
+  return default_dm;
+
+}
+
+char* bestFileName(char *name, char *outdir) {
+
+  assert(name != NULL);
+  assert(outdir != NULL);
+
+  char *base = strrchr(name, '/');
+  base = (base == NULL) ? name : base + 1;
+
+  // swap a .prd extension for .best, or add .best to any other name
+  size_t length = strlen(base);
+  if ((length > 4) && (strcmp(base + length - 4, ".prd") == 0)) {
+    length = length - 4;
+  }
+
+  size_t size = strlen(outdir) + length + 7;
+  char *bestname = (char*)malloc(size);
+  assert(bestname != NULL);
+  snprintf(bestname, size, "%s/%.*s.best", outdir, (int)length, base);
+
+  return bestname;
+
+}
+
+// the periodograms of a batch, shared out between threads one at a time
+typedef struct bestBatch {
+  char **names;
+  char **bestnames; // the BEST file of each periodogram (NULL for a merged table)
+  float *dms;
+  peakList **peaks; // kept for the merged table, otherwise each file is written out as soon as it is done
+  int ninputs;
+  int next;
+  int failures;
+  char *outdir;
+  int merged;
+  bestSettings *settings;
+  pthread_mutex_t lock;
+} bestBatch;
+
+// orders periodograms by the name of their BEST file, to find any two that share one
+static char **sortedBestNames;
+static int compareBestNames(const void *a, const void *b) {
+
+  int x = *(const int*)a;
+  int y = *(const int*)b;
+  int order = strcmp(sortedBestNames[x], sortedBestNames[y]);
+
+  return (order != 0) ? order : x - y;
+
+}
+
+// converts periodograms from a batch until there are none left
+static void* bestWorker(void *arg) {
+
+  bestBatch *batch = (bestBatch*)arg;
+
+  while (TRUE) {
+
+    pthread_mutex_lock(&batch->lock);
+    int job = batch->next;
+    batch->next++;
+    pthread_mutex_unlock(&batch->lock);
+
+    if (job >= batch->ninputs) {
+      break;
+    }
+
+    FILE *inputfile = fopen(batch->names[job], "r");
+    if (inputfile == NULL) {
+      printf("ERROR: Unable to open periodogram %s - skipped.\n", batch->names[job]);
+      pthread_mutex_lock(&batch->lock);
+      batch->failures++;
+      pthread_mutex_unlock(&batch->lock);
+      continue;
+    }
+
+    peakList *peaks = createPeakList();
+    int readable = findBestPeaks(inputfile, peaks, batch->settings);
+    fclose(inputfile);
+
+    if (readable == FALSE) {
+      printf("ERROR: Unable to read periodogram %s - skipped.\n", batch->names[job]);
+      deletePeakList(peaks);
+      pthread_mutex_lock(&batch->lock);
+      batch->failures++;
+      pthread_mutex_unlock(&batch->lock);
+      continue;
+    }
+
+    if (batch->merged == TRUE) {
+      batch->peaks[job] = peaks;
+    } else {
+      char *bestname = batch->bestnames[job];
+      FILE *outputfile = fopen(bestname, "w+");
+      if (outputfile == NULL) {
+	printf("ERROR: Unable to create %s - skipped.\n", bestname);
+	pthread_mutex_lock(&batch->lock);
+	batch->failures++;
+	pthread_mutex_unlock(&batch->lock);
+      } else {
+	writeBestFile(outputfile, peaks, batch->dms[job], batch->settings);
+	fclose(outputfile);
+      }
+      deletePeakList(peaks);
+    }
+  }
+
+  return NULL;
+
+}
+
+int batchFFA2Best(char **names, char **listed_dms, int ninputs, char *dmtag, float default_dm, char *outdir, FILE *mergedfile, int threads, bestSettings *settings) {
+
+  assert(names != NULL);
+  assert(listed_dms != NULL);
+  assert(settings != NULL);
+  assert(threads >= 1);
+
+  int ii;
+  bestBatch batch;
+  batch.names = names;
+  batch.ninputs = ninputs;
+  batch.next = 0;
+  batch.failures = 0;
+  batch.outdir = outdir;
+  batch.merged = (mergedfile != NULL) ? TRUE : FALSE;
+  batch.settings = settings;
+  batch.dms = (float*)malloc(sizeof(float) * ninputs);
+  batch.peaks = (peakList**)calloc(ninputs, sizeof(peakList*));
+  assert((batch.dms != NULL) && (batch.peaks != NULL));
+  pthread_mutex_init(&batch.lock, NULL);
+
+  for (ii = 0; ii < ninputs; ii++) {
+    batch.dms[ii] = batchDM(names[ii], listed_dms[ii], dmtag, default_dm);
+  }
+
+  // BEST files are named after the periodograms alone, so periodograms with the same name in different directories would overwrite each other
+  batch.bestnames = NULL;
+  if (batch.merged == FALSE) {
+    batch.bestnames = (char**)malloc(sizeof(char*) * ninputs);
+    int *order = (int*)malloc(sizeof(int) * ninputs);
+    assert((batch.bestnames != NULL) && (order != NULL));
+    for (ii = 0; ii < ninputs; ii++) {
+      batch.bestnames[ii] = bestFileName(names[ii], outdir);
+      order[ii] = ii;
+    }
+    sortedBestNames = batch.bestnames;
+    qsort(order, ninputs, sizeof(int), compareBestNames);
+    for (ii = 1; ii < ninputs; ii++) {
+      if (strcmp(batch.bestnames[order[ii - 1]], batch.bestnames[order[ii]]) == 0) {
+	printf("ERROR: Periodograms %s and %s would both be written to %s.\nPlease rename one of them, or use -merged, and try again.\n", names[order[ii - 1]], names[order[ii]], batch.bestnames[order[ii]]);
+	exit(EXIT_FAILURE);
+      }
+    }
+    free(order);
+  }
+
+  if (threads > ninputs) {
+    threads = ninputs;
+  }
+
+  if (threads == 1) {
+    bestWorker(&batch);
+  } else {
+    pthread_t workers[threads];
+    for (ii = 0; ii < threads; ii++) {
+      int error = pthread_create(&workers[ii], NULL, bestWorker, &batch);
+      assert(error == 0);
+    }
+    for (ii = 0; ii < threads; ii++) {
+      pthread_join(workers[ii], NULL);
+    }
+  }
+
+  // the merged table is written in input order once every periodogram is done, so it does not depend on the number of threads
+  if (batch.merged == TRUE) {
+    fprintf(mergedfile, "# DM | SNR | Period (ms) | Periodogram\n");
+    for (ii = 0; ii < ninputs; ii++) {
+      if (batch.peaks[ii] != NULL) {
+	mergedWriter(mergedfile, batch.peaks[ii], batch.dms[ii], names[ii], settings->ranked_flag);
+	deletePeakList(batch.peaks[ii]);
+      }
+    }
+  }
+
+  printf("%d of %d periodograms converted.\n", ninputs - batch.failures, ninputs);
+
+  pthread_mutex_destroy(&batch.lock);
+  if (batch.bestnames != NULL) {
+    for (ii = 0; ii < ninputs; ii++) {
+      free(batch.bestnames[ii]);
+    }
+    free(batch.bestnames);
+  }
+  free(batch.dms);
+  free(batch.peaks);
+
+  return batch.failures;
+
+}
+
 void writePeak(FILE *file, double period, double snr, float tsamp) {
 
   // check valid input
@@ -318,11 +788,11 @@ void writePeak(FILE *file, double period, double snr, float tsamp) {
   
 }
 
-int rawPeakFinder(FILE *inputfile, FILE *outputfile, double thresh, double lthresh, double dthresh, float tsamp) {
+int rawPeakFinder(FILE *inputfile, peakList* peaks, double thresh, double lthresh, double dthresh, float tsamp) {
 
   // check for valid input
   assert(inputfile != NULL);
-  assert(outputfile != NULL);
+  assert(peaks != NULL);
   assert(thresh > 0);
   assert(thresh > lthresh);
   assert(dthresh < 1);
@@ -330,8 +800,7 @@ int rawPeakFinder(FILE *inputfile, FILE *outputfile, double thresh, double lthre
   // setup variables for reading file
   double snr;
   double period;
-  int ds_factor;
-  double ds_period;
+  periodogramRow row;
   int i;
 
   // setup variables for computing peaks
@@ -346,15 +815,14 @@ int rawPeakFinder(FILE *inputfile, FILE *outputfile, double thresh, double lthre
   
   
   // commence reading file
-  // need to skip the first line
-  char header_string[50];
-  for (i = 0; i < HEADER_STRINGS; i++) {
-    fscanf(inputfile, "%s", header_string);
-    // removes the first line from the scan
-  }
+  // the header tells text and binary periodograms apart
+  int format = readPeriodogramHeader(inputfile);
 
   i = 0;
-  while (fscanf(inputfile, "%lf %d %lf %lf", &period, &ds_factor, &ds_period, &snr) != EOF) {
+  int status;
+  while ((status = readPeriodogramRow(inputfile, format, &row)) == TRUE) {
+    period = row.period;
+    snr = row.metric;
     // now begins the algorithm proper
 
     // check if we are above the cutoff
@@ -366,7 +834,7 @@ int rawPeakFinder(FILE *inputfile, FILE *outputfile, double thresh, double lthre
 	// the obvious case - if we've fallen below the lower threshold, we're done
 	// write out the peak, unless we've already done so
 	if (PEAK_FLAG == FALSE) {
-	  writePeak(outputfile, highest_period, highest_snr, tsamp);
+	  addPeak(peaks, highest_period, highest_snr, tsamp);
 	  peak_counter++;
 	}
 	ABOVE_THRESHOLD = FALSE;
@@ -379,7 +847,7 @@ int rawPeakFinder(FILE *inputfile, FILE *outputfile, double thresh, double lthre
 	// we have fallen sufficiently far from the highest_snr to classify it as its own peak
 	PEAK_FLAG = TRUE;
 	trough_snr = snr;
-	writePeak(outputfile, highest_period, highest_snr, tsamp);
+	addPeak(peaks, highest_period, highest_snr, tsamp);
 	peak_counter++;
       } else if (PEAK_FLAG == TRUE && snr < trough_snr) {
 	// we have fallen deeper into the valley since the previous peak
@@ -407,203 +875,328 @@ int rawPeakFinder(FILE *inputfile, FILE *outputfile, double thresh, double lthre
     
     i++;
   }
+
+  // rows stop being read at the end of the file, or at the first row that cannot be read (including one cut short by the end of the file)
+  if (status != FALSE) {
+    printf("ERROR: Row %d of the periodogram could not be read.\n", i + 1);
+    return -1;
+  }
   
   return peak_counter;
   
 }
 
-int readPeak(FILE *file, double *period, double *snr) {
+peakList* createPeakList() {
+
+  peakList* peaks = (peakList*)malloc(sizeof(peakList));
+  assert(peaks != NULL);
+
+  peaks->npeaks = 0;
+  peaks->capacity = 1024;
+  peaks->periods = (double*)malloc(sizeof(double) * peaks->capacity);
+  peaks->snrs = (double*)malloc(sizeof(double) * peaks->capacity);
+  assert((peaks->periods != NULL) && (peaks->snrs != NULL));
+
+  return peaks;
+
+}
+
+void deletePeakList(peakList* peaks) {
+
+  assert(peaks != NULL);
+
+  free(peaks->periods);
+  free(peaks->snrs);
+  free(peaks);
+
+  return;
+
+}
+
+void addPeak(peakList* peaks, double period, double snr, float tsamp) {
+
+  // check valid input
+  assert(peaks != NULL);
+  assert(tsamp > 0);
+
+  if (peaks->npeaks == peaks->capacity) {
+    peaks->capacity = 2*peaks->capacity;
+    peaks->periods = (double*)realloc(peaks->periods, sizeof(double) * peaks->capacity);
+    peaks->snrs = (double*)realloc(peaks->snrs, sizeof(double) * peaks->capacity);
+    assert((peaks->periods != NULL) && (peaks->snrs != NULL));
+  }
+
+  // round through the same formats as writePeak, so that results match those of the old text files passed between stages
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.1f", snr);
+  peaks->snrs[peaks->npeaks] = strtod(buffer, NULL);
+  snprintf(buffer, sizeof(buffer), "%.8f", period * tsamp / 1000);
+  peaks->periods[peaks->npeaks] = strtod(buffer, NULL);
+  peaks->npeaks++;
+
+  return;
 
-  // check for valid input
-  assert(file != NULL);
-  assert(period != NULL);
-  assert(snr != NULL);
-  
-  return fscanf(file, "%lf %lf", snr, period);
-  
 }
 
-int peakCombiner(FILE *inputfile, FILE *outputfile, int npeaks, float pulsar_dc, float max_dc, float tobs, float tsamp, int harmonic_flag, int highprime, float tolerance) {
+int peakCombiner(peakList* peaks, float pulsar_dc, float max_dc, float tobs, float tsamp, int harmonic_flag, int highprime, float tolerance) {
 
   // check for valid input
-  assert(inputfile != NULL);
-  assert(outputfile != NULL);
+  assert(peaks != NULL);
   assert(pulsar_dc >= 0);
   assert(max_dc >= 0);
   assert(max_dc > pulsar_dc);
 
   // variable setup
+  // everything is stored on the heap - dense periodograms can produce far more peaks than fit on the stack
   int ii;
-  double periods[npeaks];
-  double snrs[npeaks];
-  int active_peaks[npeaks];
-  int checked_peaks[npeaks];
-
-  double max_period;
-  double max_snr;
-  int max_position;
-
-  double min_period;
-  double min_snr;
-  int min_position;
-
-  // read peaks into arrays and activate all peaks
+  int npeaks = peaks->npeaks;
+  double *periods = peaks->periods;
+  double *snrs = peaks->snrs;
+  int *active_peaks = (int*)malloc(sizeof(int) * (npeaks + 1));
+  int *checked_peaks = (int*)malloc(sizeof(int) * (npeaks + 1));
+  assert((active_peaks != NULL) && (checked_peaks != NULL));
+
+  // activate all peaks
   for (ii = 0; ii < npeaks; ii++) {
-    readPeak(inputfile, &periods[ii], &snrs[ii]);
     active_peaks[ii] = TRUE;
     checked_peaks[ii] = FALSE;
   }
 
   // now scan through peaks heirarchically, removing peaks until the process stops
-  int total_checked = 0;
-  while (total_checked < npeaks) {
-    // scan the array and find the max entry that hasn't been checked
-    max_snr = 0;
-    
-    for (ii = 0; ii < npeaks; ii++) {
-      // has the current entry been checked?
-      if (checked_peaks[ii] == FALSE) {
-	// is this the first non-checked peak found?
-	if (max_snr == 0) {
-	  // this peak automatically gets to be top dog
-	  max_snr = snrs[ii];
-	  max_period = periods[ii];
-	  max_position = ii;
-	} else {
-	  // else another peak has already been allocated - compare and decide
-	  if (snrs[ii] > max_snr) {
-	    // this peak wins
-	    max_snr = snrs[ii];
-	    max_period = periods[ii];
-	    max_position = ii;
-	  }
-	}
-      }
+  // peaks are taken strongest first (the earliest wins a tie), passing over any already swallowed by the window of a stronger peak
+  // windows are found by binary search of the peaks in period order, and the skip list jumps straight over peaks that have already been checked,
+  // so each peak is only ever removed once
+  int *rank_order = (int*)malloc(sizeof(int) * (npeaks + 1));
+  int *period_order = (int*)malloc(sizeof(int) * (npeaks + 1));
+  int *period_position = (int*)malloc(sizeof(int) * (npeaks + 1));
+  int *skip = (int*)malloc(sizeof(int) * (npeaks + 1));
+  assert((rank_order != NULL) && (period_order != NULL) && (period_position != NULL) && (skip != NULL));
+
+  rankPeaks(snrs, npeaks, rank_order);
+  periodOrder(periods, npeaks, period_order);
+  for (ii = 0; ii < npeaks; ii++) {
+    period_position[period_order[ii]] = ii;
+  }
+  // skip leads from a position in period order to the next unchecked position at or after it - npeaks marks the end
+  for (ii = 0; ii <= npeaks; ii++) {
+    skip[ii] = ii;
+  }
+
+  int rank;
+  for (rank = 0; rank < npeaks; rank++) {
+
+    int max_position = rank_order[rank];
+    if (checked_peaks[max_position] == TRUE) {
+      continue;
     }
+    double max_period = periods[max_position];
 
     // we now have the max peak that has not been checked
     // calculate the window
     double window = peakWindow(max_period, tobs, pulsar_dc, max_dc);
     //printf("Window: period = %f | tobs = %f | pulsar_dc = %f | max_dc = %f | window = %f\n", max_period, tobs, pulsar_dc, max_dc, window);
 
-    // find any unchecked peaks within the window and deactivate + check them
-    for (ii = 0; ii < npeaks; ii++) {
-      // does the period fall within the window (also check that we're not considering the max peak against itself)
-      if ((fabs(periods[ii] - max_period) < window) && (ii != max_position) && (checked_peaks[ii] != TRUE)) {
+    // find any unchecked peaks within the window and deactivate + check them (also check that we're not considering the max peak against itself)
+    int position = nextUnchecked(skip, windowStart(periods, period_order, npeaks, max_period, window));
+    while ((position < npeaks) && (fabs(periods[period_order[position]] - max_period) < window)) {
+      if (period_order[position] != max_position) {
 	// deactivate and check the peak
-	checked_peaks[ii] = TRUE;
-	active_peaks[ii] = FALSE;
-	total_checked++;
+	checked_peaks[period_order[position]] = TRUE;
+	active_peaks[period_order[position]] = FALSE;
+	skip[position] = position + 1;
       }
+      position = nextUnchecked(skip, position + 1);
     }
 
     // now mark current peak as being checked (but not deactivated)
     checked_peaks[max_position] = TRUE;
-    total_checked++;
+    skip[period_position[max_position]] = period_position[max_position] + 1;
   }
 
+  free(rank_order);
+
   // now we need to run the harmonic filtering, if requested
   if (harmonic_flag == TRUE) {
 
-    // do harmonic stuff in here
     // need to scan through the list of active peaks again, deactivating any weak ones which display a harmonic match
-    // uncheck the still active peaks
-    total_checked = 0;
-    for (ii = 0; ii < npeaks; ii++) {
-      if (active_peaks[ii] == TRUE) {
-	checked_peaks[ii] = FALSE;
-      } else {
-	total_checked++;
-      }
+    // the weakest peak goes first (the earliest among equals), and is compared against every active peak not yet visited
+    // rather than stepping through each prime fraction and testing every peak against it, the fractions are worked out once,
+    // and for each one the periods that could match are found by binary search of the peaks in period order
+    int nratios;
+    double *ratios = harmonicRatios(highprime, &nratios);
+    int *weak_order = (int*)malloc(sizeof(int) * (npeaks + 1));
+    assert(weak_order != NULL);
+    weakestFirst(snrs, npeaks, weak_order);
+
+    // the skip list now leads to the next active peak that has not been visited
+    for (ii = 0; ii <= npeaks; ii++) {
+      skip[ii] = ((ii == npeaks) || (active_peaks[period_order[ii]] == TRUE)) ? ii : ii + 1;
     }
-    
-    while(total_checked < npeaks) {
-      // need to go by weakest peak first
-      // scan the array and find the min entry that hasn't been checked
-      min_snr = 0;
-    
-      for (ii = 0; ii < npeaks; ii++) {
-	// has the current entry been checked?
-	if (checked_peaks[ii] == FALSE) {
-	  // is this the first non-checked peak found?
-	  if (min_snr == 0) {
-	    // this peak automatically gets to be top dog
-	    min_snr = snrs[ii];
-	    min_period = periods[ii];
-	    min_position = ii;
-	  } else {
-	    // else another peak has already been allocated - compare and decide
-	    if (snrs[ii] < min_snr) {
-	      // this peak wins
-	      min_snr = snrs[ii];
-	      min_period = periods[ii];
-	      min_position = ii;
-	    }
-	  }
-	}
-      }
 
-      // min snr has now been found - now we need to check for harmonic relationships with the remaining peaks
-      // need to do this using rolling prime fractions
-      int prime = 2;
-      int match = FALSE;
-      int new_match = FALSE;
-      while (prime <= highprime && match == FALSE) {
-
-	int numdom = 1;
-	// numdom forms the numerator or the denominator to the current prime, depending on whether the period being checked is bigger or small than the min_period
-	while (numdom < prime) {
-
-	  for (ii=0; ii < npeaks; ii++) {
-	    // we are now scanning through the peak list
-	    // check to see if the peak hasn't already been checked
-	    if (checked_peaks[ii] == FALSE && ii != min_position) {
-	      // determine whether the peak is at a higher or lower period
-	      if (periods[ii] < min_period) {
-		// check to see if the harmonic match is close enough
-		new_match = harmonicMatch(min_period, periods[ii], ((double)numdom)/((double)prime), tolerance);
-	      } else if (periods[ii] > min_period) {
-		new_match = harmonicMatch(min_period, periods[ii], ((double)prime)/((double)numdom), tolerance);
-	      }
-	    }
-
-	    if (new_match == TRUE) {
-	      match = TRUE;
-	    }
-	  }
-	  
-	  numdom++;
-	  
-	}
-	
-	prime = nextPrime(prime);
-	
+    int weak;
+    for (weak = 0; weak < npeaks; weak++) {
+
+      int min_position = weak_order[weak];
+      if (active_peaks[min_position] == FALSE) {
+	continue;
       }
+      // this peak is no longer a candidate for the peaks still to come
+      skip[period_position[min_position]] = period_position[min_position] + 1;
 
-      // check to see if a match was found
-      if (match == TRUE) {
+      if (harmonicSearch(periods, period_order, skip, npeaks, periods[min_position], ratios, nratios, tolerance) == TRUE) {
 	active_peaks[min_position] = FALSE;
       }
-      checked_peaks[min_position] = TRUE;
-      total_checked++;
     }
+
+    free(ratios);
+    free(weak_order);
   }
 
-  int return_npeaks = 0;
-  // we should now have a list of the remaining active peaks - write to file
+  free(period_order);
+  free(period_position);
+  free(skip);
+
+  // we should now have a list of the remaining active peaks - keep only those, in their original order
+  // (the list is rewritten in place - a peak is never moved to a later position than the one it is read from)
+  peaks->npeaks = 0;
   for (ii = 0; ii < npeaks; ii++) {
     //printf("PEAK EVALUATED: Period = %f | SNR = %f | ii = %d | ACTIVE = %d | CHECKED = %d\n", periods[ii], snrs[ii], ii, active_peaks[ii], checked_peaks[ii]);
     if (active_peaks[ii] == TRUE) {
-      //printf("Writing out period = %f | snr = %f\n", periods[ii], snrs[ii]);
-      writePeak(outputfile, periods[ii]*1000/tsamp, snrs[ii], tsamp);
-      return_npeaks++;
+      addPeak(peaks, periods[ii]*1000/tsamp, snrs[ii], tsamp);
     }
   }
+  int return_npeaks = peaks->npeaks;
+
+  free(active_peaks);
+  free(checked_peaks);
   
   return return_npeaks;
 
 }
 
+// a peak being sorted, along with its position in the peak arrays
+typedef struct sortedPeak {
+  double key;
+  int position;
+} sortedPeak;
+
+// orders sortedPeaks by descending key, then ascending position
+static int compareDescending(const void *a, const void *b) {
+
+  const sortedPeak *x = (const sortedPeak*)a;
+  const sortedPeak *y = (const sortedPeak*)b;
+
+  if (x->key != y->key) {
+    return (x->key > y->key) ? -1 : 1;
+  }
+  return x->position - y->position;
+
+}
+
+// orders sortedPeaks by ascending key, then ascending position
+static int compareAscending(const void *a, const void *b) {
+
+  const sortedPeak *x = (const sortedPeak*)a;
+  const sortedPeak *y = (const sortedPeak*)b;
+
+  if (x->key != y->key) {
+    return (x->key < y->key) ? -1 : 1;
+  }
+  return x->position - y->position;
+
+}
+
+// sorts the positions of npeaks values into order using the given comparison
+static void sortPositions(double *values, int npeaks, int *order, int (*comparison)(const void*, const void*)) {
+
+  int ii;
+  sortedPeak *sorted = (sortedPeak*)malloc(sizeof(sortedPeak) * (npeaks + 1));
+  assert(sorted != NULL);
+
+  for (ii = 0; ii < npeaks; ii++) {
+    sorted[ii].key = values[ii];
+    sorted[ii].position = ii;
+  }
+  qsort(sorted, npeaks, sizeof(sortedPeak), comparison);
+  for (ii = 0; ii < npeaks; ii++) {
+    order[ii] = sorted[ii].position;
+  }
+
+  free(sorted);
+  return;
+
+}
+
+void rankPeaks(double *snrs, int npeaks, int *order) {
+
+  assert(snrs != NULL);
+  assert(order != NULL);
+
+  sortPositions(snrs, npeaks, order, compareDescending);
+  return;
+
+}
+
+void periodOrder(double *periods, int npeaks, int *order) {
+
+  assert(periods != NULL);
+  assert(order != NULL);
+
+  sortPositions(periods, npeaks, order, compareAscending);
+  return;
+
+}
+
+void weakestFirst(double *snrs, int npeaks, int *order) {
+
+  assert(snrs != NULL);
+  assert(order != NULL);
+
+  sortPositions(snrs, npeaks, order, compareAscending);
+  return;
+
+}
+
+int windowStart(double *periods, int *order, int npeaks, double centre, double window) {
+
+  assert(periods != NULL);
+  assert(order != NULL);
+
+  // peaks below the centre are inside the window once centre - period < window, which only gets truer as the period rises
+  int low = 0;
+  int high = npeaks;
+  while (low < high) {
+    int middle = low + (high - low)/2;
+    if ((periods[order[middle]] < centre) && !(centre - periods[order[middle]] < window)) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+
+  return low;
+
+}
+
+int nextUnchecked(int *skip, int position) {
+
+  assert(skip != NULL);
+
+  int end = position;
+  while (skip[end] != end) {
+    end = skip[end];
+  }
+  // point everything passed on the way straight at the end
+  while (skip[position] != end) {
+    int next = skip[position];
+    skip[position] = end;
+    position = next;
+  }
+
+  return end;
+
+}
+
 double peakWindow(double period, double tobs, double pulsar_dc, double max_dc) {
 
   // check valid input
@@ -665,68 +1258,109 @@ int harmonicMatch(double sourceperiod, double checkperiod, double ratio, double
   
 }
 
-void rankedWriter(FILE *inputfile, FILE *outputfile, int npeaks, float tsamp, int ranked) {
+double* harmonicRatios(int highprime, int *nratios) {
 
-  // check valid input
-  assert(inputfile != FALSE);
-  assert(outputfile != FALSE);
-  assert(npeaks > 0);
-  assert(ranked == TRUE || ranked == FALSE);
-  
-  // read the peaks into arrays
-  int ii;
-  double periods[npeaks];
-  double snrs[npeaks];
-  int checked_peaks[npeaks];
+  assert(nratios != NULL);
 
-  double max_snr;
-  int max_position;
+  // there are prime - 1 fractions (each used both ways up) for every prime
+  double *ratios = (double*)malloc(sizeof(double) * (2*highprime*highprime + 1));
+  assert(ratios != NULL);
 
-  for (ii = 0; ii < npeaks; ii++) {
-    readPeak(inputfile, &periods[ii], &snrs[ii]);
-    checked_peaks[ii] = FALSE;
+  int count = 0;
+  int prime = 2;
+  while (prime <= highprime) {
+    int numdom;
+    for (numdom = 1; numdom < prime; numdom++) {
+      ratios[count] = ((double)numdom)/((double)prime);
+      ratios[count + 1] = ((double)prime)/((double)numdom);
+      count = count + 2;
+    }
+    prime = nextPrime(prime);
   }
 
-  // now write them back out, depending on the status of ranked
-  if (ranked == TRUE) {
+  *nratios = count;
+  return ratios;
 
-    int total_checked = 0;
-    
-    while (total_checked < npeaks) {
-      
-      max_snr = 0;
-      
-      for (ii = 0; ii < npeaks; ii++) {
-	// has the current entry been checked?
-	if (checked_peaks[ii] == FALSE) {
-	  // is this the first non-checked peak found?
-	  if (max_snr == 0) {
-	    // this peak automatically gets to be top dog
-	    max_snr = snrs[ii];
-	    max_position = ii;
-	  } else {
-	    // else another peak has already been allocated - compare and decide
-	    if (snrs[ii] > max_snr) {
-	      // this peak wins
-	      max_snr = snrs[ii];
-	      max_position = ii;
-	    }
-	  }
+}
+
+int harmonicSearch(double *periods, int *order, int *skip, int npeaks, double period, double *ratios, int nratios, double tolerance) {
+
+  assert(periods != NULL);
+  assert(order != NULL);
+  assert(skip != NULL);
+  assert(ratios != NULL);
+  assert(tolerance > 0);
+
+  int rr;
+  double fraction = tolerance/100;
+
+  for (rr = 0; rr < nratios; rr++) {
+
+    // harmonicMatch accepts periods within fraction of period*ratio, relative to the checked period
+    // search a slightly wider range than that, and leave the final word to harmonicMatch itself
+    double target = period * ratios[rr];
+    double lowest = (target/(1 + fraction)) * (1 - 1e-9);
+    double highest = (fraction < 1) ? (target/(1 - fraction)) * (1 + 1e-9) : HUGE_VAL;
+
+    int low = 0;
+    int high = npeaks;
+    while (low < high) {
+      int middle = low + (high - low)/2;
+      if (periods[order[middle]] < lowest) {
+	low = middle + 1;
+      } else {
+	high = middle;
+      }
+    }
+
+    int position = nextUnchecked(skip, low);
+    while ((position < npeaks) && (periods[order[position]] <= highest)) {
+      double check = periods[order[position]];
+      // fractions below 1 only apply to shorter periods, and their inverses to longer ones
+      if (((ratios[rr] < 1) && (check < period)) || ((ratios[rr] > 1) && (check > period))) {
+	if (harmonicMatch(period, check, ratios[rr], tolerance) == TRUE) {
+	  return TRUE;
 	}
       }
+      position = nextUnchecked(skip, position + 1);
+    }
+  }
+
+  return FALSE;
 
-      // we now have the maximum peak that has not been checked
-      //printf("RANKED: Found max at period %f and snr %f.\n", periods[max_position], snrs[max_position]);
-      // write it out
-      writePeak(outputfile, periods[max_position]*1000/tsamp, snrs[max_position], tsamp);
-      checked_peaks[max_position] = TRUE;
-      total_checked++;
+}
+
+void rankedWriter(peakList* peaks, FILE *outputfile, float tsamp, int ranked) {
+
+  // check valid input
+  assert(peaks != NULL);
+  assert(outputfile != NULL);
+  assert(ranked == TRUE || ranked == FALSE);
+
+  int ii;
+  int npeaks = peaks->npeaks;
+  double *periods = peaks->periods;
+  double *snrs = peaks->snrs;
+
+  // now write them back out, depending on the status of ranked
+  if (ranked == TRUE) {
+
+    // highest SNR first, the earliest peak first among equals
+    int *rank_order = (int*)malloc(sizeof(int) * (npeaks + 1));
+    assert(rank_order != NULL);
+    rankPeaks(snrs, npeaks, rank_order);
+
+    for (ii = 0; ii < npeaks; ii++) {
+      writePeak(outputfile, periods[rank_order[ii]]*1000/tsamp, snrs[rank_order[ii]], tsamp);
     }
+
+    free(rank_order);
   } else if (ranked == FALSE) {
     for (ii = 0; ii < npeaks; ii++) {
       writePeak(outputfile, periods[ii]*1000/tsamp, snrs[ii], tsamp);
     }
   }
+
   return;
     
 }
@@ -0,0 +1,415 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <assert.h>
+
+// User defined libraries
+#include "metrics.h"
+#include "ffadata.h"
+#include "paddedarray.h"
+#include "dataarray.h"
+#include "equalstrings.h"
+#include "whitenoise.h"
+#include "ffa.h"
+#include "hugealloc.h"
+#include "periodogram.h"
+
+#define TRUE 1
+#define FALSE 0
+
+// Program to benchmark the FFA implementation on a synthetic time series
+// Written by Andrew Cameron
+// Version 1.3 - Last updated 19/10/2026
+
+/*
+
+CHANGELOG:
+
+19/10/2026 - v1.0 - Times singleFFA over a range of base periods for each FFA work array layout, and checks that all layouts produce identical periodograms
+19/10/2026 - v1.1 - Runs the base periods through a single FFA plan per layout, as massFFA does, rather than calling singleFFA for each one
+19/10/2026 - v1.2 - Added -hugepages option to compare huge page modes
+19/10/2026 - v1.3 - Added -halfstep mode, which measures the cost and sensitivity of half-step FFA trials on fractional period test pulsars
+
+*/
+
+// ***** FUNCTION PROTOTYPES *****
+
+// prints out an explanation of how to use the command line interface
+void ffabench_help();
+
+// runs the FFA over the given base periods through one plan, writing the periodogram to outputfile, and returns the elapsed wall clock time in seconds (CPU time returned via cputime)
+double benchFFA(FILE* outputfile, paddedArray* sourcedata, int lowperiod, int highperiod, double (*metric)(ffadata*, int, int), int mfsize, int layout, int repeats, double* cputime);
+
+// runs the FFA with the given oversampling over base periods [lowperiod, highperiod), and returns the highest metric of any trial within
+// tolerance samples of targetperiod (the elapsed wall clock time of the FFA itself is returned via walltime)
+double peakFFA(paddedArray* sourcedata, int lowperiod, int highperiod, double (*metric)(ffadata*, int, int), int mfsize, int oversample, double targetperiod, double tolerance, double* walltime);
+
+// compares the standard FFA against half-step trials for ntests pulsars with fractional periods spread across [lowperiod, highperiod)
+void halfstepBenchmark(int samples, double seedwidth, double noise, int lowperiod, int highperiod, double (*metric)(ffadata*, int, int), int mfsize, int ntests);
+
+// returns TRUE if two files have identical contents
+int identicalFiles(FILE* file1, FILE* file2);
+
+// ***** MAIN FUNCTION *****
+
+int main(int argc, char** argv) {
+
+  // declare variables and initialise with defaults
+  int samples = (int)pow(2, 20);
+  int seedperiod = 500;
+  int seedwidth = 15;
+  double noise = 1;
+  int lowperiod = 490;
+  int highperiod = 510;
+  int metric_choice = 3;
+  int mfsize = 0;
+  int layout_choice = 0;
+  int repeats = 1;
+  unsigned int seed = 1;
+  int hugepage_mode = HUGEPAGE_TRANSPARENT;
+  int halfstep_flag = FALSE;
+  int ntests = 10;
+
+  double (*metric)(ffadata*, int, int);
+
+  int i; // counter
+
+  // scan arguments and allocate variables
+  i = 1;
+  while (i < argc) {
+    if (equal_strings(argv[i],"-s")) {
+      i++;
+      samples = atoi(argv[i]);
+    } else if (equal_strings(argv[i],"-pp")) {
+      i++;
+      seedperiod = atoi(argv[i]);
+    } else if (equal_strings(argv[i],"-pw")) {
+      i++;
+      seedwidth = atoi(argv[i]);
+    } else if (equal_strings(argv[i],"-sigma")) {
+      i++;
+      noise = atof(argv[i]);
+    } else if (equal_strings(argv[i],"-lp")) {
+      i++;
+      lowperiod = atoi(argv[i]);
+    } else if (equal_strings(argv[i],"-hp")) {
+      i++;
+      highperiod = atoi(argv[i]);
+    } else if (equal_strings(argv[i],"-a")) {
+      i++;
+      metric_choice = atoi(argv[i]);
+    } else if (equal_strings(argv[i],"-mf")) {
+      i++;
+      mfsize = atoi(argv[i]);
+    } else if (equal_strings(argv[i],"-layout")) {
+      i++;
+      layout_choice = atoi(argv[i]);
+    } else if (equal_strings(argv[i],"-repeat")) {
+      i++;
+      repeats = atoi(argv[i]);
+    } else if (equal_strings(argv[i],"-seed")) {
+      i++;
+      seed = (unsigned int)atoi(argv[i]);
+    } else if (equal_strings(argv[i],"-hugepages")) {
+      i++;
+      hugepage_mode = atoi(argv[i]);
+    } else if (equal_strings(argv[i],"-halfstep")) {
+      halfstep_flag = TRUE;
+    } else if (equal_strings(argv[i],"-ntests")) {
+      i++;
+      ntests = atoi(argv[i]);
+    } else if (equal_strings(argv[i], "-h") || equal_strings(argv[i], "--help")) {
+      ffabench_help();
+      exit(0);
+    } else {
+      printf("Unknown argument (%s) passed to ffabench.\nUse -h / --help to display help menu with acceptable arguments.\n",argv[i]);
+      exit(0);
+    }
+    i++;
+  }
+
+  // test for valid input
+  assert(lowperiod >= 2);
+  assert(highperiod > lowperiod);
+  assert(samples > highperiod);
+  assert(seedperiod > seedwidth);
+  assert(noise >= 0);
+  assert(repeats > 0);
+  assert(ntests > 0);
+  assert(mfsize >= 0);
+  assert(layout_choice == 0 || layout_choice == FFA_LAYOUT_ROW || layout_choice == FFA_LAYOUT_INTERLEAVED);
+  assert(hugepage_mode == HUGEPAGE_OFF || hugepage_mode == HUGEPAGE_TRANSPARENT || hugepage_mode == HUGEPAGE_EXPLICIT);
+
+  setHugePageMode(hugepage_mode);
+
+  // assign metric
+  if (metric_choice == 3) {
+    metric = basicMetric;
+  } else if (metric_choice == 4) {
+    metric = maxminMetric;
+  } else if (metric_choice == 5) {
+    metric = kondratievMetric;
+  } else if (metric_choice == 7) {
+    metric = integralMetric;
+  } else if (metric_choice == 8) {
+    metric = averageMetric;
+  } else if (metric_choice == 1) {
+    metric = postMadMatchedFilterMetric;
+  } else if (metric_choice == 2) {
+    metric = kondratievMFMetric;
+  } else {
+    printf("Invalid algorithm choice!\n");
+    exit(0);
+  }
+
+  seedWhiteNoise(seed);
+
+  // the half-step benchmark builds its own test data
+  if (halfstep_flag == TRUE) {
+    halfstepBenchmark(samples, seedwidth, noise, lowperiod, highperiod, metric, mfsize, ntests);
+    return 0;
+  }
+
+  // build the test time series - a top hat pulse train with added white noise
+  paddedArray* sourcedata = basicPulsarDataArray(samples, seedperiod, seedwidth);
+  ffadata* dataarray = getPaddedArrayDataArray(sourcedata);
+  for (i = 0; i < samples; i++) {
+    dataarray[i] = dataarray[i] + generateNoisyPadding(noise, 0);
+  }
+
+  // run the benchmark for each requested layout
+  int layouts[2] = {FFA_LAYOUT_ROW, FFA_LAYOUT_INTERLEAVED};
+  char* layoutnames[2] = {"profile-major", "bin-major"};
+  double walltimes[2] = {0, 0};
+  double cputimes[2] = {0, 0};
+  FILE* outputfiles[2] = {NULL, NULL};
+
+  for (i = 0; i < 2; i++) {
+    if ((layout_choice == 0) || (layout_choice == layouts[i])) {
+      outputfiles[i] = tmpfile();
+      assert(outputfiles[i] != NULL);
+      walltimes[i] = benchFFA(outputfiles[i], sourcedata, lowperiod, highperiod, metric, mfsize, layouts[i], repeats, &cputimes[i]);
+    }
+  }
+
+  // report
+  int trials = (highperiod - lowperiod) * repeats;
+  printf("\n***** FFABENCH RESULTS *****\n");
+  printf("Samples = %d | Base periods = %d to %d | Algorithm = %d | Matched filter = %d | Repeats = %d\n", samples, lowperiod, highperiod - 1, metric_choice, mfsize, repeats);
+  printf("%-15s %12s %12s %20s\n", "Layout", "Wall (s)", "CPU (s)", "Per base period (ms)");
+  for (i = 0; i < 2; i++) {
+    if (outputfiles[i] != NULL) {
+      printf("%-15s %12.4f %12.4f %20.4f\n", layoutnames[i], walltimes[i], cputimes[i], walltimes[i]*1000/trials);
+    }
+  }
+
+  if ((outputfiles[0] != NULL) && (outputfiles[1] != NULL)) {
+    if (identicalFiles(outputfiles[0], outputfiles[1]) == TRUE) {
+      printf("Periodograms from both layouts are identical.\n");
+    } else {
+      printf("WARNING: Periodograms from the two layouts differ!\n");
+    }
+  }
+
+  // cleanup
+  for (i = 0; i < 2; i++) {
+    if (outputfiles[i] != NULL) {
+      fclose(outputfiles[i]);
+    }
+  }
+  deletePaddedArray(sourcedata);
+
+  return 0;
+
+}
+
+double benchFFA(FILE* outputfile, paddedArray* sourcedata, int lowperiod, int highperiod, double (*metric)(ffadata*, int, int), int mfsize, int layout, int repeats, double* cputime) {
+
+  assert(outputfile != NULL);
+  assert(sourcedata != NULL);
+  assert(cputime != NULL);
+
+  struct timespec start, end;
+  clock_t cpustart = clock();
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  // plan creation is included in the timing, as it is part of the cost of a search
+  ffaPlan* plan = createFFAPlan(getPaddedArrayDataSize(sourcedata), lowperiod, highperiod, layout, PERIODOGRAM_TEXT, 1);
+
+  int r, baseperiod;
+  for (r = 0; r < repeats; r++) {
+    // only keep the periodogram from the first pass for comparison
+    if (r == 1) {
+      fflush(outputfile);
+      outputfile = fopen("/dev/null", "w");
+      assert(outputfile != NULL);
+    }
+    for (baseperiod = lowperiod; baseperiod < highperiod; baseperiod++) {
+      runFFAPlan(plan, outputfile, NULL, NULL, sourcedata, baseperiod, metric, mfsize);
+    }
+  }
+  deleteFFAPlan(plan);
+  if (repeats > 1) {
+    fclose(outputfile);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  *cputime = (double)(clock() - cpustart)/CLOCKS_PER_SEC;
+
+  return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec)/1e9;
+
+}
+
+double peakFFA(paddedArray* sourcedata, int lowperiod, int highperiod, double (*metric)(ffadata*, int, int), int mfsize, int oversample, double targetperiod, double tolerance, double* walltime) {
+
+  assert(sourcedata != NULL);
+  assert(walltime != NULL);
+
+  // full precision binary output, so that the comparison is not limited by text rounding
+  FILE* outputfile = tmpfile();
+  assert(outputfile != NULL);
+  writePeriodogramHeader(outputfile, PERIODOGRAM_BINARY);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  ffaPlan* plan = createFFAPlan(getPaddedArrayDataSize(sourcedata), lowperiod, highperiod, FFA_LAYOUT_ROW, PERIODOGRAM_BINARY, oversample);
+  int baseperiod;
+  for (baseperiod = lowperiod; baseperiod < highperiod; baseperiod++) {
+    runFFAPlan(plan, outputfile, NULL, NULL, sourcedata, baseperiod, metric, mfsize);
+  }
+  deleteFFAPlan(plan);
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  *walltime = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec)/1e9;
+
+  // scan the periodogram for the best trial near the target
+  rewind(outputfile);
+  int format = readPeriodogramHeader(outputfile);
+  periodogramRow row;
+  double peak = -INFINITY;
+
+  while (readPeriodogramRow(outputfile, format, &row) == TRUE) {
+    if ((fabs(row.period - targetperiod) <= tolerance) && (row.metric > peak)) {
+      peak = row.metric;
+    }
+  }
+
+  fclose(outputfile);
+
+  return peak;
+}
+
+void halfstepBenchmark(int samples, double seedwidth, double noise, int lowperiod, int highperiod, double (*metric)(ffadata*, int, int), int mfsize, int ntests) {
+
+  int i, t;
+  double time1, time2;
+  double totaltime1 = 0;
+  double totaltime2 = 0;
+  double totalgain = 0;
+  double worstpeak1 = INFINITY;
+  double worstpeak2 = INFINITY;
+
+  printf("\n***** FFABENCH HALF-STEP RESULTS *****\n");
+  printf("Samples = %d | Pulse width = %.2f | Noise RMS = %.2f | Test periods between %d and %d\n", samples, seedwidth, noise, lowperiod, highperiod);
+  printf("%-14s %14s %14s %10s\n", "Period", "Standard peak", "Half-step peak", "Gain (%)");
+
+  for (t = 0; t < ntests; t++) {
+
+    // spread the test periods across the range, with fractional parts that step through the gaps between standard trials
+    double period = lowperiod + (highperiod - lowperiod - 1)*((double)t/ntests) + (double)(t + 1)/(ntests + 1);
+
+    paddedArray* sourcedata = fractionalPulsarDataArray(samples, period, seedwidth);
+    ffadata* dataarray = getPaddedArrayDataArray(sourcedata);
+    for (i = 0; i < samples; i++) {
+      dataarray[i] = dataarray[i] + generateNoisyPadding(noise, 0);
+    }
+
+    // the base periods either side of the pulsar cover every trial that could pick it up
+    int firstperiod = (int)floor(period) - 1;
+    if (firstperiod < 2) {
+      firstperiod = 2;
+    }
+
+    double peak1 = peakFFA(sourcedata, firstperiod, (int)floor(period) + 2, metric, mfsize, 1, period, 1.0, &time1);
+    double peak2 = peakFFA(sourcedata, firstperiod, (int)floor(period) + 2, metric, mfsize, 2, period, 1.0, &time2);
+
+    printf("%-14.4f %14.4f %14.4f %10.2f\n", period, peak1, peak2, (peak2 - peak1)*100/fabs(peak1));
+
+    totaltime1 = totaltime1 + time1;
+    totaltime2 = totaltime2 + time2;
+    totalgain = totalgain + (peak2 - peak1)/fabs(peak1);
+    if (peak1 < worstpeak1) {
+      worstpeak1 = peak1;
+    }
+    if (peak2 < worstpeak2) {
+      worstpeak2 = peak2;
+    }
+
+    deletePaddedArray(sourcedata);
+  }
+
+  printf("\nMean metric gain from half-step trials: %.2f%%\n", totalgain*100/ntests);
+  printf("Worst case peak metric: %.4f (standard), %.4f (half-step)\n", worstpeak1, worstpeak2);
+  printf("FFA wall time: %.4f s (standard), %.4f s (half-step) - half-step costs %.2fx\n", totaltime1, totaltime2, totaltime2/totaltime1);
+
+  return;
+}
+
+int identicalFiles(FILE* file1, FILE* file2) {
+
+  assert(file1 != NULL);
+  assert(file2 != NULL);
+
+  rewind(file1);
+  rewind(file2);
+
+  int c1, c2;
+  do {
+    c1 = fgetc(file1);
+    c2 = fgetc(file2);
+    if (c1 != c2) {
+      return FALSE;
+    }
+  } while (c1 != EOF);
+
+  return TRUE;
+
+}
+
+void ffabench_help() {
+
+  printf("\nFFABENCH - a program to benchmark the FFAncy implementation of the FFA on a synthetic time series.\n");
+  printf("Version 1.3, last updated 19/10/2026.\n");
+  printf("\n*****\n\n");
+  printf("Input options:\n");
+
+  printf("\n----- Test Dataset -----\n");
+  printf("-s [int]             Number of samples in the test time series (default = 2^20).\n");
+  printf("-pp [int]            Period (in samples) of the fake pulsar (default = 500).\n");
+  printf("-pw [int]            Pulse width (in samples) of the fake pulsar (default = 15).\n");
+  printf("-sigma [float]       RMS of the white noise added to the pulse train (default = 1).\n");
+  printf("-seed [int]          Seed for the noise generation (default = 1).\n");
+
+  printf("\n----- FFA Execution -----\n");
+  printf("-lp [int]            Lowest base period to run, in samples (default = 490).\n");
+  printf("-hp [int]            Base periods up to (but not including) this value are run (default = 510).\n");
+  printf("-a [int]             Algorithm used for profile evaluation, as in ffancy (default = 3).\n");
+  printf("-mf [int]            Matched filter size applied before evaluation, as in ffancy (default = 0).\n");
+  printf("-layout [int]        FFA work array layout to benchmark: 0 = both (DEFAULT), 1 = profile-major, 2 = bin-major.\n");
+  printf("-hugepages [int]     Huge page mode for the data and FFA buffers, as in ffancy: 0 = off, 1 = transparent (DEFAULT), 2 = explicit.\n");
+  printf("-repeat [int]        Number of times to repeat the full set of base periods (default = 1).\n");
+
+  printf("\n----- Half-Step Benchmark -----\n");
+  printf("-halfstep            Instead of comparing layouts, compare the standard FFA against half-step trials (ffancy -halfstep) for cost and sensitivity.\n");
+  printf("                     Test pulsars with fractional periods (and width -pw) are spread between -lp and -hp.\n");
+  printf("-ntests [int]        Number of test pulsars for -halfstep (default = 10).\n");
+
+  printf("\n----- Miscellaneous -----\n");
+  printf("-h / --help          Displays this useful and informative help menu.\n\n");
+
+  return;
+
+}
@@ -5,13 +5,6 @@
 #include <stdlib.h>
 #include "ffadata.h"
 
-ffadata add(ffadata x, ffadata y) {
-
-  ffadata result = x + y;
-  
-  return result;
-}
-
 ffadata resample(ffadata x, ffadata y) {
 
   // basic implementation - just return the sum
@@ -14,7 +14,10 @@ typedef double ffadata;
 // ***** FUNCTION PROTOTYPES *****
 
 // Defines the addition function for the data values
-ffadata add(ffadata x, ffadata y);
+// Defined here (rather than in ffadata.c) so that it can be inlined into the FFA addition loops
+static inline ffadata add(ffadata x, ffadata y) {
+  return x + y;
+}
 
 // Resamples two values into one value
 ffadata resample(ffadata x, ffadata y);
@@ -0,0 +1,671 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+
+// user defined libraries
+#include "metrics.h"
+#include "ffadata.h"
+#include "paddedarray.h"
+#include "dataarray.h"
+#include "equalstrings.h"
+#include "ffa.h"
+#include "synthseries.h"
+#include "whitenoise.h"
+#include "mad.h"
+
+#define TRUE 1
+#define FALSE 0
+
+// Program to measure FFA sensitivity by injecting pulsars into noise and recovering them, all in one process
+// Every injection of a grid of periods, duty cycles and amplitudes is added to each of a set of shared noise realisations,
+// folded at its period with the same plan and metric code ffancy uses, and its best metric recorded against the injected SNR
+// Written by Andrew Cameron
+// Version 1.2 - Last updated 19/10/2026
+
+// CHANGELOG
+// 19/10/2026 - v1.0 - First version. Writes a table of every injection, detection fractions per grid point, and the sensitivity curve
+//                     (injected SNR at the detection fraction threshold against duty cycle, as in Kondratiev et al. 2009)
+// 19/10/2026 - v1.1 - Noise realisations are seeded from one stream seeded with -seed, rather than with seed + realisation
+// 19/10/2026 - v1.2 - Added -lp and -timenorm, so injections can be downsampled and normalised per octave as in an ffancy search.
+//                     Without -lp every injection is still folded at the original resolution.
+
+// ***** DATA TYPES *****
+
+// one axis of the injection grid
+typedef struct injectAxis {
+  double low;
+  double high;
+  int steps;
+} injectAxis;
+
+// the outcome of one injection
+typedef struct injectResult {
+  double injected; // optimal SNR of the injected signal against the white noise
+  double recovered; // best metric within the period tolerance
+  double period; // trial period that gave it
+} injectResult;
+
+// everything the workers share
+typedef struct injectHarness {
+  int samples;
+  int realisations;
+  double white;
+  double** noise; // one array of samples per realisation
+  injectAxis periods;
+  injectAxis dcs;
+  injectAxis amps;
+  int shape;
+  double scatter;
+  double tolerance; // in trial period spacings
+  double (*metric)(ffadata*, int, int);
+  int mfsize;
+  int dered_flag;
+  int timenorm_flag;
+  int lowperiod; // lowest period of the ffancy search being emulated (original samples), or 0 to fold every injection at the original resolution
+  long njobs;
+  long next;
+  injectResult* results;
+  pthread_mutex_t lock;
+} injectHarness;
+
+// ***** FUNCTION PROTOTYPES *****
+
+// prints out an explanation of how to use the command line interface
+void help();
+
+// returns grid point step of an axis
+double axisValue(injectAxis* axis, int step);
+
+// reads the three values of a grid option starting at argv[ii] into an axis
+void readAxis(injectAxis* axis, int argc, char** argv, int ii);
+
+// splits a job number into its realisation and grid steps - periods vary slowest, so that consecutive jobs mostly share an FFA plan
+void jobSteps(injectHarness* harness, long job, int* realisation, int* pstep, int* dstep, int* astep);
+
+// runs injections until there are none left
+void* injectWorker(void* arg);
+
+// ***** MAIN FUNCTION *****
+
+int main(int argc, char** argv) {
+
+  // declare variables and initialise with defaults
+  FILE *outputfile = NULL;
+  FILE *curvefile = NULL;
+  FILE *sensfile = NULL;
+  injectHarness harness;
+  long samples = 1L << 20;
+  int realisations = 8;
+  unsigned long long seed = 0;
+  int seed_flag = FALSE;
+  double red = 0;
+  double redindex = 1;
+  int metric_choice = 1;
+  int threads = 1;
+  double thresh = 6;
+  double fraction = 0.5;
+
+  harness.white = 1;
+  harness.periods.low = 500;
+  harness.periods.high = 500;
+  harness.periods.steps = 1;
+  harness.dcs.low = 5;
+  harness.dcs.high = 5;
+  harness.dcs.steps = 1;
+  harness.amps.low = 0;
+  harness.amps.high = 0.5;
+  harness.amps.steps = 11;
+  harness.shape = 1;
+  harness.scatter = 0;
+  harness.tolerance = 2;
+  harness.mfsize = 0;
+  harness.dered_flag = FALSE;
+  harness.timenorm_flag = FALSE;
+  harness.lowperiod = 0;
+
+  int ii, jj, kk; // counters
+
+  // check that a valid number of arguments have been passed
+  if (argc < 2) {
+    help();
+    exit(0);
+  }
+
+  // scan arguments and allocate variables
+  ii = 1;
+  while (ii < argc) {
+    if (equal_strings(argv[ii], "-o")) {
+      ii++;
+      outputfile = fopen(argv[ii], "w+");
+    } else if (equal_strings(argv[ii], "-curve")) {
+      ii++;
+      curvefile = fopen(argv[ii], "w+");
+    } else if (equal_strings(argv[ii], "-sens")) {
+      ii++;
+      sensfile = fopen(argv[ii], "w+");
+    } else if (equal_strings(argv[ii], "-n")) {
+      ii++;
+      samples = atol(argv[ii]);
+    } else if (equal_strings(argv[ii], "-realisations")) {
+      ii++;
+      realisations = atoi(argv[ii]);
+    } else if (equal_strings(argv[ii], "-seed")) {
+      ii++;
+      seed_flag = TRUE;
+      seed = strtoull(argv[ii], NULL, 10);
+    } else if (equal_strings(argv[ii], "-white")) {
+      ii++;
+      harness.white = atof(argv[ii]);
+    } else if (equal_strings(argv[ii], "-red")) {
+      if (ii + 2 >= argc) {
+	printf("-red needs an RMS and a spectral index.\n");
+	exit(0);
+      }
+      red = atof(argv[ii + 1]);
+      redindex = atof(argv[ii + 2]);
+      ii = ii + 2;
+    } else if (equal_strings(argv[ii], "-periods")) {
+      readAxis(&harness.periods, argc, argv, ii);
+      ii = ii + 3;
+    } else if (equal_strings(argv[ii], "-dcs")) {
+      readAxis(&harness.dcs, argc, argv, ii);
+      ii = ii + 3;
+    } else if (equal_strings(argv[ii], "-amps")) {
+      readAxis(&harness.amps, argc, argv, ii);
+      ii = ii + 3;
+    } else if (equal_strings(argv[ii], "-shape")) {
+      ii++;
+      harness.shape = atoi(argv[ii]);
+    } else if (equal_strings(argv[ii], "-scatter")) {
+      ii++;
+      harness.scatter = atof(argv[ii]);
+    } else if (equal_strings(argv[ii], "-a")) {
+      ii++;
+      metric_choice = atoi(argv[ii]);
+    } else if (equal_strings(argv[ii], "-mf")) {
+      ii++;
+      harness.mfsize = atoi(argv[ii]);
+    } else if (equal_strings(argv[ii], "-dered")) {
+      harness.dered_flag = TRUE;
+    } else if (equal_strings(argv[ii], "-timenorm")) {
+      harness.timenorm_flag = TRUE;
+    } else if (equal_strings(argv[ii], "-lp")) {
+      ii++;
+      harness.lowperiod = atoi(argv[ii]);
+    } else if (equal_strings(argv[ii], "-ptol")) {
+      ii++;
+      harness.tolerance = atof(argv[ii]);
+    } else if (equal_strings(argv[ii], "-thresh")) {
+      ii++;
+      thresh = atof(argv[ii]);
+    } else if (equal_strings(argv[ii], "-fraction")) {
+      ii++;
+      fraction = atof(argv[ii]);
+    } else if (equal_strings(argv[ii], "-threads")) {
+      ii++;
+      threads = atoi(argv[ii]);
+    } else if (equal_strings(argv[ii], "-h") || equal_strings(argv[ii], "--help")) {
+      help();
+      exit(0);
+    } else {
+      printf("Unknown argument (%s) passed to ffainject.\nUse -h / --help to display help menu with acceptable arguments.\n", argv[ii]);
+      exit(0);
+    }
+    ii++;
+  }
+
+  // test for valid input
+  assert(outputfile != NULL);
+  if ((samples < 1) || (samples > INT_MAX/ARRAY_PADDING - 1)) {
+    printf("Invalid number of samples!\n");
+    exit(0);
+  }
+  if ((realisations < 1) || (threads < 1)) {
+    printf("Number of realisations and threads must be at least 1!\n");
+    exit(0);
+  }
+  if ((harness.white <= 0) || (red < 0) || ((red > 0) && ((redindex <= 0) || (redindex >= 2)))) {
+    printf("White noise RMS must be greater than 0, red noise RMS cannot be negative and its index must lie between 0 and 2!\n");
+    exit(0);
+  }
+  if ((fmin(harness.periods.low, harness.periods.high) < 2) || (fmax(harness.periods.low, harness.periods.high) * 2 >= samples)) {
+    printf("Injected periods must be at least 2 samples, and fit at least twice into the data!\n");
+    exit(0);
+  }
+  if ((harness.lowperiod < 0) || ((harness.lowperiod > 0) && ((harness.lowperiod < 2) || (fmin(harness.periods.low, harness.periods.high) < harness.lowperiod)))) {
+    printf("The lowest search period (-lp) must be at least 2 samples, and no longer than any injected period!\n");
+    exit(0);
+  }
+  if ((fmin(harness.dcs.low, harness.dcs.high) <= 0) || (fmax(harness.dcs.low, harness.dcs.high) >= 100)) {
+    printf("Duty cycles must lie between 0 and 100 percent!\n");
+    exit(0);
+  }
+  if ((harness.shape != 1) && (harness.shape != 2)) {
+    printf("Invalid pulse shape chosen!\n");
+    exit(0);
+  }
+  if ((harness.scatter < 0) || (harness.tolerance < 0) || (harness.mfsize < 0)) {
+    printf("Scattering time, period tolerance and matched filter size cannot be negative!\n");
+    exit(0);
+  }
+  if ((fraction <= 0) || (fraction >= 1)) {
+    printf("Detection fraction must lie between 0 and 1!\n");
+    exit(0);
+  }
+
+  // assign metric
+  if (metric_choice == 3) {
+    harness.metric = basicMetric;
+  } else if (metric_choice == 4) {
+    harness.metric = maxminMetric;
+  } else if (metric_choice == 5) {
+    harness.metric = kondratievMetric;
+  } else if (metric_choice == 6) {
+    printf("Algorithm 6 has been permanently disabled. Please select a different metric.\n");
+    exit(0);
+  } else if (metric_choice == 7) {
+    harness.metric = integralMetric;
+  } else if (metric_choice == 8) {
+    harness.metric = averageMetric;
+  } else if (metric_choice == 1) {
+    harness.metric = postMadMatchedFilterMetric;
+  } else if (metric_choice == 2) {
+    harness.metric = kondratievMFMetric;
+  } else {
+    printf("Invalid algorithm choice!\n");
+    exit(0);
+  }
+
+  if (seed_flag == FALSE) {
+    seed = (unsigned long long)time(NULL);
+  }
+
+  harness.samples = (int)samples;
+  harness.realisations = realisations;
+  harness.njobs = (long)realisations * harness.periods.steps * harness.dcs.steps * harness.amps.steps;
+  harness.next = 0;
+  harness.results = (injectResult*)malloc(sizeof(injectResult) * harness.njobs);
+  harness.noise = (double**)malloc(sizeof(double*) * realisations);
+  assert(harness.results != NULL && harness.noise != NULL);
+
+  // generate the shared noise realisations - every injection is added to each of them in turn
+  // each realisation is seeded from the next draw of one stream seeded with -seed, so runs with neighbouring seeds share no realisations
+  printf("Generating %d noise realisations of %d samples (seed %llu)...\n", realisations, harness.samples, seed);
+  noiseStream seeds;
+  seedNoiseStream(&seeds, (uint64_t)seed);
+  for (ii = 0; ii < realisations; ii++) {
+    synthSeries* series = createSynthSeries();
+    series->samples = harness.samples;
+    series->white = harness.white;
+    series->red = red;
+    series->redindex = redindex;
+    series->seed = noiseBits(&seeds);
+    series->seed_flag = TRUE;
+    startSynthSeries(series);
+
+    harness.noise[ii] = (double*)malloc(sizeof(double) * harness.samples);
+    assert(harness.noise[ii] != NULL);
+    nextSynthChunk(series, harness.noise[ii], harness.samples);
+    deleteSynthSeries(series);
+  }
+
+  printf("Running %ld injections (%d periods x %d duty cycles x %d amplitudes x %d realisations) using %d thread(s)...\n", harness.njobs, harness.periods.steps, harness.dcs.steps, harness.amps.steps, realisations, threads);
+  pthread_mutex_init(&harness.lock, NULL);
+
+  if (threads == 1) {
+    injectWorker(&harness);
+  } else {
+    pthread_t workers[threads];
+    for (ii = 0; ii < threads; ii++) {
+      int error = pthread_create(&workers[ii], NULL, injectWorker, &harness);
+      assert(error == 0);
+    }
+    for (ii = 0; ii < threads; ii++) {
+      pthread_join(workers[ii], NULL);
+    }
+  }
+  pthread_mutex_destroy(&harness.lock);
+  printf("Injections complete.\n");
+
+  // every injection
+  fprintf(outputfile, "# Realisation | Period (samples) | Duty cycle (%%) | Amplitude | Injected SNR | Recovered metric | Recovered period (samples)\n");
+  long job;
+  for (job = 0; job < harness.njobs; job++) {
+    int realisation, pstep, dstep, astep;
+    jobSteps(&harness, job, &realisation, &pstep, &dstep, &astep);
+    fprintf(outputfile, "%d %.6f %.4f %.6f %.6f %.6f %.6f\n", realisation, axisValue(&harness.periods, pstep), axisValue(&harness.dcs, dstep), axisValue(&harness.amps, astep),
+	    harness.results[job].injected, harness.results[job].recovered, harness.results[job].period);
+  }
+  fclose(outputfile);
+
+  // detection fractions at each grid point, and the injected SNR at which the detection fraction first reaches the threshold
+  // (interpolated linearly between amplitude steps, which should be in increasing order)
+  if (curvefile != NULL) {
+    fprintf(curvefile, "# Period (samples) | Duty cycle (%%) | Amplitude | Mean injected SNR | Mean recovered metric | Detection fraction (metric >= %.3f)\n", thresh);
+  }
+  if (sensfile != NULL) {
+    fprintf(sensfile, "# Period (samples) | Duty cycle (%%) | Injected SNR at %.0f%% detection | Amplitude at %.0f%% detection\n", fraction*100, fraction*100);
+  }
+
+  for (ii = 0; ii < harness.periods.steps; ii++) {
+    for (jj = 0; jj < harness.dcs.steps; jj++) {
+
+      double lastfraction = 0;
+      double lastsnr = 0;
+      double lastamp = 0;
+      int found = FALSE;
+
+      for (kk = 0; kk < harness.amps.steps; kk++) {
+	double injected = 0;
+	double recovered = 0;
+	int detections = 0;
+	int rr;
+	for (rr = 0; rr < realisations; rr++) {
+	  long index = (((long)ii * harness.dcs.steps + jj) * harness.amps.steps + kk) * realisations + rr;
+	  injected = injected + harness.results[index].injected;
+	  recovered = recovered + harness.results[index].recovered;
+	  if (harness.results[index].recovered >= thresh) {
+	    detections++;
+	  }
+	}
+	injected = injected / realisations;
+	recovered = recovered / realisations;
+	double detected = (double)detections / realisations;
+
+	if (curvefile != NULL) {
+	  fprintf(curvefile, "%.6f %.4f %.6f %.6f %.6f %.4f\n", axisValue(&harness.periods, ii), axisValue(&harness.dcs, jj), axisValue(&harness.amps, kk), injected, recovered, detected);
+	}
+
+	if ((found == FALSE) && (detected >= fraction)) {
+	  double snr = injected;
+	  double amp = axisValue(&harness.amps, kk);
+	  if (kk > 0) {
+	    double t = (fraction - lastfraction) / (detected - lastfraction);
+	    snr = lastsnr + t * (injected - lastsnr);
+	    amp = lastamp + t * (amp - lastamp);
+	  }
+	  if (sensfile != NULL) {
+	    fprintf(sensfile, "%.6f %.4f %.6f %.6f\n", axisValue(&harness.periods, ii), axisValue(&harness.dcs, jj), snr, amp);
+	  }
+	  found = TRUE;
+	}
+	lastfraction = detected;
+	lastsnr = injected;
+	lastamp = axisValue(&harness.amps, kk);
+      }
+
+      if ((found == FALSE) && (sensfile != NULL)) {
+	// never detected often enough within the amplitude grid
+	fprintf(sensfile, "%.6f %.4f nan nan\n", axisValue(&harness.periods, ii), axisValue(&harness.dcs, jj));
+      }
+    }
+  }
+
+  if (curvefile != NULL) {
+    fclose(curvefile);
+  }
+  if (sensfile != NULL) {
+    fclose(sensfile);
+  }
+
+  // cleanup
+  for (ii = 0; ii < realisations; ii++) {
+    free(harness.noise[ii]);
+  }
+  free(harness.noise);
+  free(harness.results);
+
+  printf("\nffainject complete.\n");
+
+  return 0;
+
+}
+
+// ***** FUNCTION BODIES *****
+
+double axisValue(injectAxis* axis, int step) {
+
+  assert(axis != NULL);
+
+  if (axis->steps == 1) {
+    return axis->low;
+  }
+
+  return axis->low + (axis->high - axis->low) * step / (axis->steps - 1);
+}
+
+void readAxis(injectAxis* axis, int argc, char** argv, int ii) {
+
+  assert(axis != NULL);
+
+  if (ii + 3 >= argc) {
+    printf("%s needs a low value, a high value and a number of steps.\n", argv[ii]);
+    exit(0);
+  }
+  axis->low = atof(argv[ii + 1]);
+  axis->high = atof(argv[ii + 2]);
+  axis->steps = atoi(argv[ii + 3]);
+  if (axis->steps < 1) {
+    printf("%s needs at least 1 step.\n", argv[ii]);
+    exit(0);
+  }
+
+  return;
+}
+
+void jobSteps(injectHarness* harness, long job, int* realisation, int* pstep, int* dstep, int* astep) {
+
+  *realisation = (int)(job % harness->realisations);
+  job = job / harness->realisations;
+  *astep = (int)(job % harness->amps.steps);
+  job = job / harness->amps.steps;
+  *dstep = (int)(job % harness->dcs.steps);
+  *pstep = (int)(job / harness->dcs.steps);
+
+  return;
+}
+
+void* injectWorker(void* arg) {
+
+  injectHarness* harness = (injectHarness*)arg;
+  int samples = harness->samples;
+
+  // the data array injections are built in, padded as ffancy pads its input
+  int paddedsize = samples*ARRAY_PADDING;
+  paddedArray* data = createPaddedArray(samples, paddedsize);
+  ffadata* array = getPaddedArrayDataArray(data);
+  int i;
+  for (i = samples; i < paddedsize; i++) {
+    array[i] = generateZeroPadding();
+  }
+  setRedFlag(data, harness->dered_flag);
+
+  // downsampled (and de-reddened) copies of an injection are made here - it is created at full size, so it fits every number of downsamples
+  paddedArray* preprocessed = NULL;
+
+  double* signal = (double*)malloc(sizeof(double) * samples);
+  assert(signal != NULL);
+
+  // the plan is rebuilt only when the base period or downsampling changes
+  ffaPlan* plan = NULL;
+  int planperiod = 0;
+  int plandownsamples = 0;
+
+  // the signal is only regenerated when the injected pulsar changes (realisations vary fastest)
+  long signaljob = -1;
+  double signalpower = 0;
+
+  while (TRUE) {
+
+    pthread_mutex_lock(&harness->lock);
+    long job = harness->next;
+    harness->next++;
+    pthread_mutex_unlock(&harness->lock);
+
+    if (job >= harness->njobs) {
+      break;
+    }
+
+    int realisation, pstep, dstep, astep;
+    jobSteps(harness, job, &realisation, &pstep, &dstep, &astep);
+    double period = axisValue(&harness->periods, pstep);
+    double dc = axisValue(&harness->dcs, dstep);
+    double amp = axisValue(&harness->amps, astep);
+
+    if ((signaljob < 0) || (job / harness->realisations != signaljob)) {
+      synthSeries* series = createSynthSeries();
+      series->samples = samples;
+      series->white = 0;
+      series->seed_flag = TRUE;
+      addSynthPulsar(series, period, dc, amp, harness->shape, harness->scatter, 0);
+      startSynthSeries(series);
+      nextSynthChunk(series, signal, samples);
+      deleteSynthSeries(series);
+
+      signalpower = 0;
+      for (i = 0; i < samples; i++) {
+	signalpower = signalpower + signal[i]*signal[i];
+      }
+      signaljob = job / harness->realisations;
+    }
+
+    double* noise = harness->noise[realisation];
+    for (i = 0; i < samples; i++) {
+      array[i] = noise[i] + signal[i];
+    }
+
+    // with -lp, the injection is downsampled as ffancy would for a search starting at lowperiod: once more each time the period doubles
+    int downsamples = 0;
+    if (harness->lowperiod > 0) {
+      while (period >= (double)harness->lowperiod * (1 << (downsamples + 1))) {
+	downsamples++;
+      }
+    }
+    int scalefactor = 1 << downsamples;
+
+    // ffancy normalises the whole series first, and then every octave's data once it has been prepared
+    if (harness->timenorm_flag == TRUE) {
+      parallelMad(array, samples, 1);
+    }
+
+    // optional de-reddening (with the window ffancy would choose for a search of this period) and downsampling, in one pass
+    paddedArray* source = data;
+    if ((downsamples > 0) || (harness->dered_flag == TRUE)) {
+      if (preprocessed == NULL) {
+	preprocessed = createPaddedArray(samples, paddedsize);
+      }
+      preprocessDataArray(data, preprocessed, downsamples, 2*((int)period + 1) + 1, 1);
+      source = preprocessed;
+    }
+    if (harness->timenorm_flag == TRUE) {
+      parallelMad(getPaddedArrayDataArray(source), getPaddedArrayDataSize(source), 1);
+    }
+
+    // base periods and trial spacings are in downsampled samples
+    int baseperiod = (int)floor(period/scalefactor);
+    if ((plan == NULL) || (planperiod != baseperiod) || (plandownsamples != downsamples)) {
+      if (plan != NULL) {
+	deleteFFAPlan(plan);
+      }
+      plan = createFFAPlan(getPaddedArrayDataSize(source), baseperiod, baseperiod + 1, FFA_LAYOUT_ROW, 0, 1);
+      planperiod = baseperiod;
+      plandownsamples = downsamples;
+    }
+
+    // fold at the base period and take the best metric of the trials within tolerance of the injected period
+    int branches;
+    ffadata* profiles = foldFFAPlan(plan, source, baseperiod, 0, &branches);
+    double increment = (branches > 1) ? (double)1/((double)(branches - 1)) : 1;
+
+    double best = -HUGE_VAL;
+    double bestperiod = period;
+    int k;
+    for (k = 0; k < branches; k++) {
+      double trial = baseperiod + k * increment;
+      if (fabs(trial - period/scalefactor) <= harness->tolerance * increment) {
+	ffadata* profile = &profiles[k*baseperiod];
+	if (harness->mfsize > 0) {
+	  mfsmootherWork(profile, 0, baseperiod, harness->mfsize, plan->smootharray);
+	}
+	double score = harness->metric(profile, 0, baseperiod);
+	if (score > best) {
+	  best = score;
+	  bestperiod = trial * scalefactor;
+	}
+      }
+    }
+
+    // optimal (matched filter) SNR of the injected signal in the white noise
+    harness->results[job].injected = sqrt(signalpower) / harness->white;
+    harness->results[job].recovered = best;
+    harness->results[job].period = bestperiod;
+  }
+
+  if (plan != NULL) {
+    deleteFFAPlan(plan);
+  }
+  if (preprocessed != NULL) {
+    deletePaddedArray(preprocessed);
+  }
+  deletePaddedArray(data);
+  free(signal);
+
+  return NULL;
+}
+
+void help() {
+
+  printf("\nffainject - a program to measure FFA sensitivity through injection and recovery of simulated pulsars.\n");
+  printf("Version 1.2, last updated 19/10/2026.\n");
+  printf("Written by Andrew Cameron, MPIFR IMPRS PhD Student.\n");
+  printf("\nEach pulsar of the injection grid is added to every noise realisation and folded at its base period, as ffancy would.\n");
+  printf("By default injections are folded at the original resolution. With -lp, each is first downsampled (and with -dered / -timenorm,\n");
+  printf("de-reddened and normalised) as ffancy would for a search starting at that period, so long periods give the SNRs ffancy reports.\n");
+  printf("The best metric among the trial periods near the injected period is recorded against the optimal SNR of the injected signal\n");
+  printf("(sqrt of the summed squared signal over the white noise RMS). Everything runs in memory - no files are written until the end.\n");
+  printf("\n*****\n\n");
+  printf("Input options:\n");
+
+  printf("\n----- Output -----\n");
+  printf("-o [file]           Table of every injection: Realisation | Period | Duty cycle | Amplitude | Injected SNR | Recovered metric | Recovered period.\n");
+  printf("-curve [file]       (Optional) Detection fraction and mean SNRs at each grid point.\n");
+  printf("-sens [file]        (Optional) Sensitivity curve - the injected SNR (and amplitude) at which each period and duty cycle is detected\n");
+  printf("                    in -fraction of the realisations.\n");
+
+  printf("\n----- Noise -----\n");
+  printf("-n [int]            Number of samples per realisation (default = 1048576).\n");
+  printf("-realisations [int] Number of noise realisations each injection is added to (default = 8).\n");
+  printf("-white [float]      RMS of the white noise (default = 1).\n");
+  printf("-red [rms] [index]  (Optional) Adds red noise with power spectrum ~ f^-index (0 < index < 2).\n");
+  printf("-seed [int]         Noise seed, for repeatable runs (default = current time).\n");
+
+  printf("\n----- Injections -----\n");
+  printf("-periods [lo] [hi] [n]  Grid of injected periods in (fractional) samples (default = 500).\n");
+  printf("-dcs [lo] [hi] [n]      Grid of duty cycles in percent (default = 5).\n");
+  printf("-amps [lo] [hi] [n]     Grid of pulse heights, in the same units as the noise RMS, in increasing order (default = 0 to 0.5 in 11 steps).\n");
+  printf("-shape [int]            Pulse shape, 1 = top hat (DEFAULT), 2 = Gaussian.\n");
+  printf("-scatter [float]        Scattering time in samples (default = 0).\n");
+
+  printf("\n----- Recovery -----\n");
+  printf("-a [int]            Algorithm used to evaluate the folded profiles, numbered as in ffancy (default = 1).\n");
+  printf("-mf [int]           Applies a matched filter of this size (samples) to profiles before evaluation, as in ffancy.\n");
+  printf("-lp [int]           Lowest period (samples) of the ffancy search to emulate - injections are downsampled once more each time the\n");
+  printf("                    period doubles from it, as ffancy -lp does (default = off, every injection is folded at the original resolution).\n");
+  printf("-dered              De-reddens each injection before folding, with the window ffancy would use.\n");
+  printf("-timenorm           Normalises each injection, and then its downsampled data, using MAD, as ffancy -timenorm does.\n");
+  printf("-ptol [float]       Trials within this many trial spacings of the injected period are searched for the best metric (default = 2).\n");
+  printf("-thresh [float]     Metric at or above which an injection counts as detected (default = 6).\n");
+  printf("-fraction [float]   Detection fraction defining the sensitivity curve (default = 0.5).\n");
+  printf("-threads [int]      Number of threads to run injections on (default = 1).\n");
+
+  printf("\n----- Miscellaneous -----\n");
+  printf("-h / --help         Displays this useful and informative help menu.\n\n");
+
+  return;
+
+}
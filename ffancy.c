@@ -13,13 +13,18 @@
 #include "equalstrings.h"
 #include "ffa.h"
 #include "mad.h"
+#include "hugealloc.h"
+#include "periodogram.h"
+#include "segmentffa.h"
+#include "synthseries.h"
+#include "searchplan.h"
 
 #define TRUE 1
 #define FALSE 0
 
 // Program to test an implementation of the FFA algorithm (Staelin 1969)
 // Written by Andrew Cameron
-// Version 1.8.3 - Last updated 11/09/2016
+// Version 1.14.2 - Last updated 19/10/2026
 // Based upon earlier program ffatest4 - this program would be equivalent to Version 5.0 - see ffatest4.0 for previous changelog
 
 /*
@@ -61,6 +66,22 @@ CHANGELOG:
 06/06/2016 - v1.8.2 - Clarified useage with improved help menu
 11/09/2016 - v1.8.3 - Further updated the help menu
                     - Converted Algorithm notation such that published metrics are now numbered 1 & 2
+19/10/2026 - v1.9.0 - Added -layout option to select the memory layout of the FFA work arrays (profile-major or bin-major interleaved)
+19/10/2026 - v1.9.1 - Data arrays and FFA workspaces now use transparent huge pages by default. Added -hugepages option to select the huge page mode
+19/10/2026 - v1.10.0 - Added -threads option to run the base periods of each octave in parallel (output is identical to a single threaded run)
+                     - Added -binary option to write the periodogram in the binary format described in periodogram.h
+                     - With -timenorm, the MAD normalisation is now applied once per octave rather than before every base period
+19/10/2026 - v1.11.0 - Added -halfstep option, which runs a second FFA per base period with trial periods halfway between the standard ones (see ffabench -halfstep for the cost/sensitivity trade-off)
+19/10/2026 - v1.12.0 - Added -segments and -segmode options to split long observations into segments that are folded independently and combined incoherently
+19/10/2026 - v1.13.0 - Added -sim option to generate the test dataset from a synthetic series spec (white / red noise and pulsars, see synthseries.h) in memory
+19/10/2026 - v1.13.1 - The -timenorm MAD normalisation finds the median and MAD without sorting (exact counting for integer data such as 8-bit input
+                       and downsampled series) and uses the -threads threads
+19/10/2026 - v1.14.0 - Added the search planner (-tsamp, -pmin, -pmax, -duty): the downsampling and base periods of each octave are chosen from the
+                       sample time, period range and smallest duty cycle, and repeated trials are skipped. -planonly prints the plan and stops.
+                       The -lp / -hp / -l / -ds options are turned into an equivalent plan, and give the same output as before
+19/10/2026 - v1.14.1 - -halfstep output is now sorted by period: each half-step trial is written between the standard trials either side of it,
+                       and every base period only tests the half-step periods within its own range
+19/10/2026 - v1.14.2 - A search plan reaching periods longer than the (segmented) data is now rejected with an error before it is printed or run
 
 FUTURE IMPROVEMENTS
 * The format of the data (ASCII vs PRESTO) could be re-written to be included as a part of the struct rather than a flag passed between functions.
@@ -93,6 +114,7 @@ int main(int argc, char** argv) {
   FILE *parrotfile = NULL;
   FILE *originalfile = NULL;
   FILE *originalderedfile = NULL;
+  FILE *simfile = NULL;
   paddedArray* sourcedata = NULL;
   int mfsize = 0;
   int dered_flag = FALSE;
@@ -101,6 +123,21 @@ int main(int argc, char** argv) {
   int user_dw_flag = FALSE;
   int dered_window = 1;
   int timenorm_flag = FALSE;
+  int layout = FFA_LAYOUT_ROW;
+  int hugepage_mode = HUGEPAGE_TRANSPARENT;
+  int threads = 1;
+  int output_format = PERIODOGRAM_TEXT;
+  int oversample = 1;
+  int segments = 1;
+  int segmode = SEGMENT_SUM_PROFILES;
+  double tsamp = 0;
+  double minperiod = 0;
+  double maxperiod = 0;
+  double duty = PLAN_DEFAULT_DUTY;
+  int plan_flag = FALSE;
+  int planonly_flag = FALSE;
+  int lp_flag = FALSE;
+  searchPlan* searchplan = NULL;
 
   double (*metric)(ffadata*, int, int);
 
@@ -125,6 +162,7 @@ int main(int argc, char** argv) {
       } else if (equal_strings(argv[i],"-lp")) {
 	i++;
 	lowperiod = atoi(argv[i]);
+	lp_flag = TRUE;
       } else if (equal_strings(argv[i],"-l")) {
 	i++;
 	loops = atoi(argv[i]);
@@ -174,6 +212,10 @@ int main(int argc, char** argv) {
 	i++;
 	originalderedfile = fopen(argv[i], "w+");
 	assert(originalderedfile != NULL);
+      } else if (equal_strings(argv[i], "-sim")) {
+	i++;
+	simfile = fopen(argv[i], "r");
+	assert(simfile != NULL);
       } else if (equal_strings(argv[i], "-presto")) {
 	PRESTO_flag = TRUE;
 	//} else if (equal_strings(argv[i], "-sigpyproc")) {
@@ -189,6 +231,43 @@ int main(int argc, char** argv) {
 	dered_window = atoi(argv[i]);
       } else if (equal_strings(argv[i], "-timenorm")) {
 	timenorm_flag = TRUE;
+      } else if (equal_strings(argv[i], "-layout")) {
+	i++;
+	layout = atoi(argv[i]);
+      } else if (equal_strings(argv[i], "-hugepages")) {
+	i++;
+	hugepage_mode = atoi(argv[i]);
+      } else if (equal_strings(argv[i], "-threads")) {
+	i++;
+	threads = atoi(argv[i]);
+      } else if (equal_strings(argv[i], "-binary")) {
+	output_format = PERIODOGRAM_BINARY;
+      } else if (equal_strings(argv[i], "-halfstep")) {
+	oversample = 2;
+      } else if (equal_strings(argv[i], "-segments")) {
+	i++;
+	segments = atoi(argv[i]);
+      } else if (equal_strings(argv[i], "-segmode")) {
+	i++;
+	segmode = atoi(argv[i]);
+      } else if (equal_strings(argv[i], "-tsamp")) {
+	i++;
+	tsamp = atof(argv[i]);
+	plan_flag = TRUE;
+      } else if (equal_strings(argv[i], "-pmin")) {
+	i++;
+	minperiod = atof(argv[i]);
+	plan_flag = TRUE;
+      } else if (equal_strings(argv[i], "-pmax")) {
+	i++;
+	maxperiod = atof(argv[i]);
+	plan_flag = TRUE;
+      } else if (equal_strings(argv[i], "-duty")) {
+	i++;
+	duty = atof(argv[i]);
+	plan_flag = TRUE;
+      } else if (equal_strings(argv[i], "-planonly")) {
+	planonly_flag = TRUE;
       } else {
 	printf("Unknown argument (%s) passed to ffancy.\nUse -h / --help to display help menu with acceptable arguments.\n",argv[i]);
 	exit(0);
@@ -197,6 +276,29 @@ int main(int argc, char** argv) {
     }
   }
 
+  // plan the search from physical units if asked to - this sets the period range in samples for everything that follows
+  if (plan_flag == TRUE) {
+    if ((lp_flag == TRUE) || (loop_flag == TRUE) || (hp_flag == TRUE) || (prelim_downsamples != 0)) {
+      printf("ERROR: The search planner (-tsamp, -pmin, -pmax, -duty) chooses the period range and downsampling itself, and cannot be combined with -lp, -l, -hp or -ds.\n");
+      exit(0);
+    }
+    if (tsamp <= 0) {
+      printf("Sample time (-tsamp) must be greater than 0!\n");
+      exit(0);
+    }
+    if ((minperiod <= 0) || (maxperiod <= minperiod)) {
+      printf("Period range (-pmin, -pmax) must satisfy 0 < pmin < pmax!\n");
+      exit(0);
+    }
+    if ((duty <= 0) || (duty >= 1)) {
+      printf("Duty cycle (-duty) must be between 0 and 1!\n");
+      exit(0);
+    }
+    searchplan = createSearchPlan(tsamp, minperiod, maxperiod, duty);
+    lowperiod = searchPlanLowPeriod(searchplan);
+    highperiod = searchPlanHighPeriod(searchplan);
+  }
+
   // populate dependent variables
   if ((loop_flag == TRUE) && (hp_flag == FALSE)) {
     highperiod = lowperiod * (int)pow(2,loops);
@@ -236,6 +338,33 @@ int main(int argc, char** argv) {
     printf("De-reddening window must be greater than 0!\n");
     exit(0);
   }
+  if (layout != FFA_LAYOUT_ROW && layout != FFA_LAYOUT_INTERLEAVED) {
+    printf("Invalid FFA memory layout choice!\n");
+    exit(0);
+  }
+  if (hugepage_mode != HUGEPAGE_OFF && hugepage_mode != HUGEPAGE_TRANSPARENT && hugepage_mode != HUGEPAGE_EXPLICIT) {
+    printf("Invalid huge page mode!\n");
+    exit(0);
+  }
+  if (threads < 1) {
+    printf("Number of threads must be at least 1!\n");
+    exit(0);
+  }
+  if (segments < 1) {
+    printf("Number of segments must be at least 1!\n");
+    exit(0);
+  }
+  if (segmode != SEGMENT_SUM_PROFILES && segmode != SEGMENT_SUM_METRICS) {
+    printf("Invalid segment combination mode!\n");
+    exit(0);
+  }
+  if ((segments > 1) && (segmode == SEGMENT_SUM_METRICS) && ((profilefile != NULL) || (normprofilefile != NULL))) {
+    printf("Profiles cannot be dumped when summing segment metrics (-segmode %d)!\n", SEGMENT_SUM_METRICS);
+    exit(0);
+  }
+
+  // must be set before any data arrays are allocated
+  setHugePageMode(hugepage_mode);
 
   // assign metric
   if (metric_choice == 3) {
@@ -296,6 +425,21 @@ int main(int argc, char** argv) {
       fclose(originalfile);
     }
     
+  } else if (simfile != NULL) {
+
+    // generate a synthetic series in memory
+    synthSeries* series = createSynthSeries();
+    readSynthSpec(series, simfile);
+    fclose(simfile);
+    printf("Generating synthetic series of %ld samples with %d pulsar(s)...\n", series->samples, series->npulsars);
+
+    sourcedata = synthDataArray(series);
+    deleteSynthSeries(series);
+    setRedFlag(sourcedata, dered_flag);
+    setWindow(sourcedata, dered_window);
+    printf("%d samples generated\n", getPaddedArrayDataSize(sourcedata));
+    assert(getPaddedArrayDataSize(sourcedata) > highperiod);
+
   } else {
     
     // generate samples manually
@@ -310,7 +454,7 @@ int main(int argc, char** argv) {
   // normalise if required
   if (timenorm_flag == TRUE) {
     // run MAD on sourcedata using only the datasize
-    mad(getPaddedArrayDataArray(sourcedata), getPaddedArrayDataSize(sourcedata));
+    parallelMad(getPaddedArrayDataArray(sourcedata), getPaddedArrayDataSize(sourcedata), threads);
     printf("Time series normalised via MAD.\n");
   }
 
@@ -338,11 +482,33 @@ int main(int argc, char** argv) {
     setWindow(sourcedata, old_dr_window);
   }
 
+  // the period options map onto a plan that steps through the base periods exactly as massFFA always has
+  if (searchplan == NULL) {
+    searchplan = legacySearchPlan(lowperiod, highperiod, prelim_downsamples, getPaddedArrayScaleFactor(sourcedata));
+  }
+  // every octave's longest base period must fit within the (segmented) downsampled data, as getPaddedArrayDataSize(sourcedata) > highperiod checks for the whole series
+  int misfit;
+  if (searchPlanFits(searchplan, sourcedata, segments, &misfit) == FALSE) {
+    searchOctave* octave = &searchplan->octaves[misfit];
+    printf("ERROR: Octave %d of the search plan runs to a period of %d original samples, which %s of %d samples cannot fold.\nPlease reduce the highest period", misfit, (octave->firstperiod + octave->trials - 1)*octave->scalefactor, (segments > 1) ? "segments" : "a time series", getPaddedArrayDataSize(sourcedata)/segments);
+    printf("%s and try again.\n", (segments > 1) ? " or use fewer segments" : "");
+    exit(0);
+  }
+  printSearchPlan(searchplan, sourcedata, segments, oversample);
+
+  if (planonly_flag == TRUE) {
+    printf("\nPlan only - no FFA run.\n");
+    fclose(outputfile);
+    deleteSearchPlan(searchplan);
+    deletePaddedArray(sourcedata);
+    return 0;
+  }
+
   printf("Now scanning from a period of %d samples to %d original samples...\n", lowperiod, highperiod);
 
   // now ready to begin FFA
 
-  massFFA(outputfile, profilefile, normprofilefile, sourcedata, lowperiod, highperiod, metric, mfsize, prelim_downsamples, originalderedfile, PRESTO_flag, timenorm_flag);
+  massFFA(outputfile, profilefile, normprofilefile, sourcedata, searchplan, metric, mfsize, originalderedfile, PRESTO_flag, timenorm_flag, layout, output_format, oversample, threads, segments, segmode);
 
   // file I/O should now be complete - close files
   fclose(outputfile);
@@ -357,6 +523,7 @@ int main(int argc, char** argv) {
   }
 
   // cleanup
+  deleteSearchPlan(searchplan);
   deletePaddedArray(sourcedata);
 
   printf("\nFFA complete.\n");
@@ -368,7 +535,7 @@ int main(int argc, char** argv) {
 void ffa_help() {
 
   printf("\nFFAncy - a testbed program for the Fast Folding Algorithm (FFA) (Staelin 1969).\n");
-  printf("Version 1.8.3, last updated 11/09/2016.\n");
+  printf("Version 1.14.2, last updated 19/10/2026.\n");
   printf("Based on earlier testing program 'ffatest4', now retired.\n");
   printf("Written by Andrew Cameron, MPIFR IMPRS PhD Student.\n");
   printf("\n*****\n\n");
@@ -378,6 +545,8 @@ void ffa_help() {
   printf("-s [int]             Number of samples to generate for test dataset.\n");
   printf("-pp [int]            Period (in samples) of the fake pulsar to be seeded into the test dataset.\n");
   printf("-pw [int]            Pulse width (in samples) of the fake pulsar.\n");
+  printf("-sim [file]          Generates the test dataset from a synthetic series spec instead - white / red noise and any number of pulsars with\n");
+  printf("                     fractional periods (see ffasim -h for the spec format). The series is generated directly in memory.\n");
 
   printf("\n----- External Dataset Input ----- \n");
   printf("-i [file]            Name of the input file (this deactivates internal data generation and makes most other data seeding parameters redundant).\n");
@@ -389,10 +558,11 @@ void ffa_help() {
   printf("                     By default, the de-reddening window is set to 2N+1, where N is th largest period trial that will be run before downsampling.\n");
   printf("                     After each downsampling, the de-reddening window is doubled in size with respect to the original data.\n");
   printf("-dw [int]            (Optional) Manually set initial window for de-reddening, in units of the original sample size.\n");
-  printf("-timenorm            EXPERIMENTAL - normalises a time series both pre and post downsampling using MAD.\n");
+  printf("-timenorm            EXPERIMENTAL - normalises a time series both pre and post downsampling using MAD (once per octave).\n");
 
   printf("\n----- Output -----\n");
   printf("-o [file]            Name of the primary output file which stores period vs. metric data in a GNUPLOT friendly format.\n");
+  printf("-binary              Write the primary output file in binary (full precision, see periodogram.h) rather than ASCII.\n");
   printf("-pdump [file]        Name of the profile dump file, which stores each individual folded profile.\n");
   printf("-npdump [file]       Same as -pdump, except that output profiles have been normalised via MAD.\n");
   printf("-parrot [file]       Name of file to re-write padded data to after initial data initialisation (writes in GNUPLOT format, used for testing purposes).\n\n");
@@ -411,6 +581,16 @@ void ffa_help() {
   printf("-l [int]             Number of downsampling loops to execute during FFA execution (tests periods from [lp] to [lp * 2^l].\n");
   printf("-hp [int]            The highest period to test for, in units of samples (downsampling may still occur if [hp] > [2*lp]).\n\n");
 
+  printf("                     SEARCH PLANNER - instead of -lp, -l, -hp and -ds, the search can be planned from physical units:\n");
+  printf("-tsamp [double]      Sample time of the data, in seconds.\n");
+  printf("-pmin [double]       The lowest period to search, in seconds.\n");
+  printf("-pmax [double]       The highest period to search, in seconds.\n");
+  printf("-duty [double]       The smallest duty cycle (pulse width / period) of interest (default = %.2f).\n", PLAN_DEFAULT_DUTY);
+  printf("                     Each octave is downsampled so that profiles have between 1/duty and 2/duty bins (never more than needed to resolve\n");
+  printf("                     the narrowest pulse), and the last trial of each base period, which repeats the first trial of the next, is skipped.\n");
+  printf("-planonly            Prints the search plan (octaves, downsampling, base periods and trial counts) and stops without running the FFA.\n");
+  printf("                     The plan is printed before every run, for the planner and the options above alike.\n\n");
+
   printf("-a [int]             Algorithm choice for profile evaluation:\n\n");
   printf("                     -* PRIMARY ALGORITHMS *-\n");
   printf("                     1 = Boxcar matched-filter with Median Absolute Deviation (MAD) normalisation.\n");
@@ -422,7 +602,22 @@ void ffa_help() {
   printf("                     6 = Faster off-pulse window algorithm. Takes advantage of pre-calculated statistics in an attempt to increase speed. (DISABLED).\n");
   printf("                     7 = Integration algorithm. Takes the integral of the profile minus the integral of the average (now uses Post-MAD profile normalisation).\n");
   printf("                     8 = Average algorithm. Returns the difference between the total and off-peak averages (now uses Post-MAD profile normalisation).\n\n");
-  printf("                     NOTE: Algorithms may also be referred to as 'metrics' in source code.\n");
+  printf("                     NOTE: Algorithms may also be referred to as 'metrics' in source code.\n\n");
+  printf("-layout [int]        Memory layout of the FFA work arrays (results are identical, only speed differs):\n");
+  printf("                     1 = Profile-major - each folded profile is stored contiguously (DEFAULT).\n");
+  printf("                     2 = Bin-major - groups of %d profiles are interleaved bin by bin, allowing Algorithms 3 & 4 to score a whole group at once.\n", FFA_INTERLEAVE);
+  printf("-hugepages [int]     Huge page use for the large data and FFA buffers (results are identical, only speed differs):\n");
+  printf("                     0 = Off - regular 4 KB pages.\n");
+  printf("                     1 = Transparent huge pages, if enabled in the kernel (DEFAULT).\n");
+  printf("                     2 = Explicit huge pages from the reserved pool (see /proc/sys/vm/nr_hugepages), falling back to transparent huge pages.\n");
+  printf("-halfstep            Runs a second FFA for each base period, with rows spaced half a sample further apart, to test the periods halfway between the standard trials.\n");
+  printf("                     Roughly doubles the cost. Half-step trials are written in period order among the standard trials.\n");
+  printf("-threads [int]       Number of threads used to run the base periods of each octave (default = 1). Output is identical for any number of threads.\n");
+  printf("-segments [int]      Splits the data into this many equal length segments, which are folded independently and combined (default = 1, no segmentation).\n");
+  printf("                     Each segment needs its own FFA workspace only one segment long, and with -threads the segments are folded in parallel.\n");
+  printf("-segmode [int]       How segments are combined when -segments is greater than 1:\n");
+  printf("                     1 = Rotate the folded profiles of each segment to a common phase and sum them before evaluation (DEFAULT).\n");
+  printf("                     2 = Evaluate each segment's profiles separately and sum the metrics (profile dumps unavailable).\n");
   printf("\n----- Miscellaneous -----\n");
   printf("-h / --help          Displays this useful and informative help menu.\n\n");
 
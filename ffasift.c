@@ -0,0 +1,573 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <assert.h>
+
+// user defined libraries
+#include "equalstrings.h"
+
+#define TRUE 1
+#define FALSE 0
+
+// longest line accepted from any input file
+#define LINE_SIZE 4096
+
+// Program to sift the candidates found by ffa2best across many DM trials
+// Candidates close together in both period and DM are grouped around the strongest of them, and each group is reduced to its strongest member and its DM-SNR curve
+// Written by Andrew Cameron
+// Version 1.1 - Last updated 19/10/2026
+
+// CHANGELOG
+// 19/10/2026 - v1.0 - First version. Reads BEST files and ffa2best -merged tables, clusters candidates in (log period, DM) using a hashed grid of cells
+//                     one tolerance wide, so each candidate is only compared against those in the neighbouring cells.
+// 19/10/2026 - v1.1 - Clusters are now seeded strongest first, and each seed only claims candidates within the tolerances of itself (rather than
+//                     chaining friends-of-friends, which merged whole DM ranges of dense candidate lists into one cluster). A cluster never holds
+//                     two candidates from the same DM trial. The size and DM span of the largest cluster are reported.
+
+// ***** DATA TYPES *****
+
+// every candidate read in, stored as parallel arrays
+typedef struct candidateList {
+  double *dms;
+  double *snrs;
+  double *periods; // ms
+  int ncands;
+  int capacity;
+} candidateList;
+
+// ***** FUNCTION PROTOTYPES *****
+
+// prints out an explanation of how to use the command line interface
+void help();
+
+// creates an empty candidate list - clean up with deleteCandidateList()
+candidateList* createCandidateList();
+
+// cleans up a candidate list
+void deleteCandidateList(candidateList* cands);
+
+// adds a candidate to the end of a list
+void addCandidate(candidateList* cands, double dm, double snr, double period);
+
+// reads every candidate from a BEST file or an ffa2best merged table (recognised from the first line) into the list - returns the number read
+int readCandidates(char *name, candidateList* cands);
+
+// groups candidates around seeds, strongest first: each seed claims the unclustered candidates whose periods agree with its own to within ptol
+// (fractional) and DMs to within dmtol, taking at most one from each DM trial (a DM trial being every candidate with the same DM)
+// fills cluster with a cluster number for each candidate (numbered from 0 in order of their seeds) and returns the number of clusters
+int clusterCandidates(candidateList* cands, double ptol, double dmtol, int *cluster);
+
+// writes one row per cluster (strongest first), and the DM-SNR curve of each cluster to curvefile if it is not NULL
+void writeClusters(FILE *outputfile, FILE *curvefile, candidateList* cands, int *cluster, int nclusters, double minsnr, int mincands);
+
+// ***** MAIN FUNCTION *****
+
+int main (int argc, char** argv) {
+
+  // declare variables and initialise with defaults
+  FILE *outputfile = NULL;
+  FILE *curvefile = NULL;
+  double ptol = 0.1; // percent
+  double dmtol = 2;
+  double minsnr = 0;
+  int mincands = 1;
+  int ninputs = 0;
+  candidateList* cands = createCandidateList();
+
+  // counters
+  int i;
+
+  // scan arguments and allocate variables
+  if (argc > 1) {
+    i=1;
+    while (i < argc) {
+      if (equal_strings(argv[i],"-i")) {
+        i++;
+        readCandidates(argv[i], cands);
+        ninputs++;
+      } else if (equal_strings(argv[i],"-list")) {
+        i++;
+        FILE *listfile = fopen(argv[i], "r");
+        if (listfile == NULL) {
+          printf("ERROR: Unable to open candidate file list %s.\n", argv[i]);
+          exit(EXIT_FAILURE);
+        }
+        char line[LINE_SIZE];
+        while (fgets(line, LINE_SIZE, listfile) != NULL) {
+          char *name = strtok(line, " \t\r\n");
+          if ((name != NULL) && (name[0] != '#')) {
+            readCandidates(name, cands);
+            ninputs++;
+          }
+        }
+        fclose(listfile);
+      } else if (equal_strings(argv[i],"-o")) {
+        i++;
+        outputfile = fopen(argv[i], "w+");
+      } else if (equal_strings(argv[i],"-curves")) {
+        i++;
+        curvefile = fopen(argv[i], "w+");
+      } else if (equal_strings(argv[i],"-ptol")) {
+        i++;
+        ptol = atof(argv[i]);
+      } else if (equal_strings(argv[i],"-dmtol")) {
+        i++;
+        dmtol = atof(argv[i]);
+      } else if (equal_strings(argv[i],"-minsnr")) {
+        i++;
+        minsnr = atof(argv[i]);
+      } else if (equal_strings(argv[i],"-mincands")) {
+        i++;
+        mincands = atoi(argv[i]);
+      } else if (equal_strings(argv[i], "-h") || equal_strings(argv[i], "--help")) {
+        help();
+        exit(0);
+      } else {
+        printf("Unknown argument (%s) passed to ffasift.\nUse -h / --help to display help menu with acceptable arguments.\n",argv[i]);
+        exit(0);
+      }
+      i++;
+    }
+  } else {
+    help();
+    exit(0);
+  }
+
+  // test for valid input
+  assert(outputfile != NULL);
+  if (ninputs == 0) {
+    printf("No candidate files given!\n");
+    exit(0);
+  }
+  if (ptol <= 0) {
+    printf("Period tolerance must be greater than 0!\n");
+    exit(0);
+  }
+  if (dmtol <= 0) {
+    printf("DM tolerance must be greater than 0!\n");
+    exit(0);
+  }
+  if (mincands < 1) {
+    printf("Minimum cluster size must be at least 1!\n");
+    exit(0);
+  }
+
+  printf("Launching ffasift: %d FILES | %d CANDIDATES | PERIOD TOLERANCE = %.4f%% | DM TOLERANCE = %.3f\n", ninputs, cands->ncands, ptol, dmtol);
+
+  int *cluster = (int*)malloc(sizeof(int) * (cands->ncands + 1));
+  assert(cluster != NULL);
+
+  int nclusters = clusterCandidates(cands, ptol/100, dmtol, cluster);
+  printf("%d candidates grouped into %d clusters.\n", cands->ncands, nclusters);
+
+  writeClusters(outputfile, curvefile, cands, cluster, nclusters, minsnr, mincands);
+
+  // I/O complete
+  fclose(outputfile);
+  if (curvefile != NULL) {
+    fclose(curvefile);
+  }
+  free(cluster);
+  deleteCandidateList(cands);
+
+  return 0;
+
+}
+
+// FUNCTION BODIES
+
+void help() {
+
+  printf("\nffasift - a program to group the candidates found by ffa2best across DM trials.\n");
+  printf("Version 1.1, last updated 19/10/2026.\n");
+  printf("Written by Andrew Cameron, MPIFR IMPRS PhD Student.\n");
+  printf("\nStarting from the strongest candidate, each candidate not yet grouped collects the ungrouped candidates within the period and\n");
+  printf("DM tolerances of itself, at most one (the strongest) from each DM trial. Each group is reported once, by its strongest candidate.\n");
+  printf("\n*****\n\n");
+  printf("Input options:\n");
+
+  printf("-i [file]           BEST file or ffa2best -merged table to read candidates from. May be given any number of times.\n");
+  printf("-list [file]        File listing BEST files / merged tables to read, one per line.\n");
+  printf("-o [file]           Name of the output file. One row per cluster, strongest first:\n");
+  printf("                    SNR | Period (ms) | DM | Candidates | Lowest DM | Highest DM\n");
+  printf("-curves [file]      (Optional) Name of a file to write the DM-SNR curve of each cluster to, as Cluster | DM | SNR rows.\n");
+
+  printf("\n----- Clustering options -----\n");
+  printf("-ptol [float]       Percentage difference in period within which candidates are grouped (default = 0.1).\n");
+  printf("-dmtol [float]      Difference in DM within which candidates are grouped (default = 2).\n");
+  printf("-minsnr [float]     Only reports clusters whose strongest candidate has at least this SNR (default = 0).\n");
+  printf("-mincands [int]     Only reports clusters of at least this many candidates (default = 1).\n");
+
+  printf("\n----- Miscellaneous -----\n");
+  printf("-h / --help         Displays this useful and informative help menu.\n\n");
+
+  return;
+
+}
+
+candidateList* createCandidateList() {
+
+  candidateList* cands = (candidateList*)malloc(sizeof(candidateList));
+  assert(cands != NULL);
+
+  cands->ncands = 0;
+  cands->capacity = 1024;
+  cands->dms = (double*)malloc(sizeof(double) * cands->capacity);
+  cands->snrs = (double*)malloc(sizeof(double) * cands->capacity);
+  cands->periods = (double*)malloc(sizeof(double) * cands->capacity);
+  assert((cands->dms != NULL) && (cands->snrs != NULL) && (cands->periods != NULL));
+
+  return cands;
+
+}
+
+void deleteCandidateList(candidateList* cands) {
+
+  assert(cands != NULL);
+
+  free(cands->dms);
+  free(cands->snrs);
+  free(cands->periods);
+  free(cands);
+
+  return;
+
+}
+
+void addCandidate(candidateList* cands, double dm, double snr, double period) {
+
+  assert(cands != NULL);
+
+  if (cands->ncands == cands->capacity) {
+    cands->capacity = 2*cands->capacity;
+    cands->dms = (double*)realloc(cands->dms, sizeof(double) * cands->capacity);
+    cands->snrs = (double*)realloc(cands->snrs, sizeof(double) * cands->capacity);
+    cands->periods = (double*)realloc(cands->periods, sizeof(double) * cands->capacity);
+    assert((cands->dms != NULL) && (cands->snrs != NULL) && (cands->periods != NULL));
+  }
+
+  cands->dms[cands->ncands] = dm;
+  cands->snrs[cands->ncands] = snr;
+  cands->periods[cands->ncands] = period;
+  cands->ncands++;
+
+  return;
+
+}
+
+int readCandidates(char *name, candidateList* cands) {
+
+  assert(name != NULL);
+  assert(cands != NULL);
+
+  FILE *inputfile = fopen(name, "r");
+  if (inputfile == NULL) {
+    printf("ERROR: Unable to open candidate file %s.\n", name);
+    exit(EXIT_FAILURE);
+  }
+
+  int found = 0;
+  char line[LINE_SIZE];
+  double dm, snr, period;
+
+  if (fgets(line, LINE_SIZE, inputfile) != NULL) {
+
+    if (sscanf(line, " DM: %lf", &dm) == 1) {
+      // BEST file - the DM is in the header, then every line is "SNR Period(ms)"
+      while (fgets(line, LINE_SIZE, inputfile) != NULL) {
+	if (sscanf(line, "%lf %lf", &snr, &period) == 2) {
+	  addCandidate(cands, dm, snr, period);
+	  found++;
+	}
+      }
+    } else {
+      // merged table - after the header line, every line is "DM SNR Period(ms) Periodogram"
+      while (fgets(line, LINE_SIZE, inputfile) != NULL) {
+	if (sscanf(line, "%lf %lf %lf", &dm, &snr, &period) == 3) {
+	  addCandidate(cands, dm, snr, period);
+	  found++;
+	}
+      }
+    }
+  }
+
+  fclose(inputfile);
+
+  return found;
+
+}
+
+// the grid cell containing a candidate - cells are one tolerance wide in both log(period) and DM
+static long long gridCell(double value, double width) {
+  return (long long)floor(value/width);
+}
+
+// mixes the two cell coordinates into a hash table position
+static unsigned long long cellHash(long long logcell, long long dmcell) {
+
+  unsigned long long hash = (unsigned long long)logcell * 0x9E3779B97F4A7C15ULL;
+  hash ^= (unsigned long long)dmcell + 0xC2B2AE3D27D4EB4FULL + (hash << 6) + (hash >> 2);
+
+  return hash;
+
+}
+
+// orders candidates strongest first (the earlier candidate first on a tie), for picking seeds
+static candidateList* seedOrderList;
+static int compareSeeds(const void *a, const void *b) {
+
+  int x = *(const int*)a;
+  int y = *(const int*)b;
+  double snrx = seedOrderList->snrs[x];
+  double snry = seedOrderList->snrs[y];
+
+  if (snrx != snry) {
+    return (snrx > snry) ? -1 : 1;
+  }
+  return x - y;
+
+}
+
+int clusterCandidates(candidateList* cands, double ptol, double dmtol, int *cluster) {
+
+  assert(cands != NULL);
+  assert(cluster != NULL);
+  assert(ptol > 0);
+  assert(dmtol > 0);
+
+  int ncands = cands->ncands;
+  int ii, jj;
+
+  // a candidate is claimed by a seed when their periods differ by no more than a factor of 1 + ptol and their DMs by no more than dmtol
+  // with cells exactly that wide, every candidate a seed can claim lies in its own cell or one of the eight around it
+  double logwidth = log(1 + ptol);
+
+  // hash table of cells - each bucket heads a chain of the candidates in it (through next), and different cells may share a bucket
+  int nbuckets = 1;
+  while (nbuckets < 2*ncands) {
+    nbuckets = 2*nbuckets;
+  }
+  int *buckets = (int*)malloc(sizeof(int) * nbuckets);
+  int *next = (int*)malloc(sizeof(int) * (ncands + 1));
+  long long *logcells = (long long*)malloc(sizeof(long long) * (ncands + 1));
+  long long *dmcells = (long long*)malloc(sizeof(long long) * (ncands + 1));
+  int *order = (int*)malloc(sizeof(int) * (ncands + 1));
+  int *claims = (int*)malloc(sizeof(int) * (ncands + 1));
+  assert((buckets != NULL) && (next != NULL) && (logcells != NULL) && (dmcells != NULL) && (order != NULL) && (claims != NULL));
+
+  for (ii = 0; ii < nbuckets; ii++) {
+    buckets[ii] = -1;
+  }
+  for (ii = 0; ii < ncands; ii++) {
+    logcells[ii] = gridCell(log(cands->periods[ii]), logwidth);
+    dmcells[ii] = gridCell(cands->dms[ii], dmtol);
+    int bucket = (int)(cellHash(logcells[ii], dmcells[ii]) & (unsigned long long)(nbuckets - 1));
+    next[ii] = buckets[bucket];
+    buckets[bucket] = ii;
+    cluster[ii] = -1;
+    order[ii] = ii;
+  }
+
+  seedOrderList = cands;
+  qsort(order, ncands, sizeof(int), compareSeeds);
+
+  // the strongest candidate not yet in a cluster seeds the next one, and claims the unclustered candidates around it
+  // claims do not chain on through the claimed candidates, and a cluster takes at most one candidate (its strongest) from each DM trial,
+  // so that other peaks of the same DM trial are left to seed clusters of their own
+  int nclusters = 0;
+  int o;
+  for (o = 0; o < ncands; o++) {
+
+    int seed = order[o];
+    if (cluster[seed] >= 0) {
+      continue;
+    }
+    cluster[seed] = nclusters;
+
+    double logperiod = log(cands->periods[seed]);
+    int nclaims = 0;
+    long long dl, dd;
+    for (dl = -1; dl <= 1; dl++) {
+      for (dd = -1; dd <= 1; dd++) {
+	long long logcell = logcells[seed] + dl;
+	long long dmcell = dmcells[seed] + dd;
+	int bucket = (int)(cellHash(logcell, dmcell) & (unsigned long long)(nbuckets - 1));
+	for (jj = buckets[bucket]; jj >= 0; jj = next[jj]) {
+	  // only unclustered members of this cell (rather than anything sharing its bucket), from other DM trials, can be claimed
+	  if ((cluster[jj] >= 0) || (logcells[jj] != logcell) || (dmcells[jj] != dmcell) || (cands->dms[jj] == cands->dms[seed])) {
+	    continue;
+	  }
+	  if ((fabs(log(cands->periods[jj]) - logperiod) > logwidth) || (fabs(cands->dms[jj] - cands->dms[seed]) > dmtol)) {
+	    continue;
+	  }
+	  // keep only the strongest claim at each DM
+	  for (ii = 0; ii < nclaims; ii++) {
+	    if (cands->dms[claims[ii]] == cands->dms[jj]) {
+	      break;
+	    }
+	  }
+	  if (ii == nclaims) {
+	    claims[nclaims] = jj;
+	    nclaims++;
+	  } else if (compareSeeds(&jj, &claims[ii]) < 0) {
+	    claims[ii] = jj;
+	  }
+	}
+      }
+    }
+
+    for (ii = 0; ii < nclaims; ii++) {
+      cluster[claims[ii]] = nclusters;
+    }
+    nclusters++;
+  }
+
+  free(buckets);
+  free(next);
+  free(logcells);
+  free(dmcells);
+  free(order);
+  free(claims);
+
+  return nclusters;
+
+}
+
+// a candidate's place when sorting by cluster, then DM
+typedef struct clusterMember {
+  int cluster;
+  double dm;
+  int cand;
+} clusterMember;
+
+static int compareMembers(const void *a, const void *b) {
+
+  const clusterMember *x = (const clusterMember*)a;
+  const clusterMember *y = (const clusterMember*)b;
+
+  if (x->cluster != y->cluster) {
+    return x->cluster - y->cluster;
+  }
+  if (x->dm != y->dm) {
+    return (x->dm < y->dm) ? -1 : 1;
+  }
+  return x->cand - y->cand;
+
+}
+
+// the strongest candidate of a cluster, for sorting clusters by SNR
+typedef struct clusterBest {
+  double snr;
+  int cluster;
+  int first; // position of the cluster's first member in the sorted member list
+  int size;
+  int best; // the strongest candidate
+} clusterBest;
+
+static int compareBest(const void *a, const void *b) {
+
+  const clusterBest *x = (const clusterBest*)a;
+  const clusterBest *y = (const clusterBest*)b;
+
+  if (x->snr != y->snr) {
+    return (x->snr > y->snr) ? -1 : 1;
+  }
+  return x->cluster - y->cluster;
+
+}
+
+void writeClusters(FILE *outputfile, FILE *curvefile, candidateList* cands, int *cluster, int nclusters, double minsnr, int mincands) {
+
+  assert(outputfile != NULL);
+  assert(cands != NULL);
+  assert(cluster != NULL);
+
+  int ncands = cands->ncands;
+  int ii, jj;
+
+  // gather the members of each cluster together, in DM order
+  clusterMember *members = (clusterMember*)malloc(sizeof(clusterMember) * (ncands + 1));
+  clusterBest *bests = (clusterBest*)malloc(sizeof(clusterBest) * (nclusters + 1));
+  assert((members != NULL) && (bests != NULL));
+
+  for (ii = 0; ii < ncands; ii++) {
+    members[ii].cluster = cluster[ii];
+    members[ii].dm = cands->dms[ii];
+    members[ii].cand = ii;
+  }
+  qsort(members, ncands, sizeof(clusterMember), compareMembers);
+
+  // find the strongest member of each cluster (the earliest candidate wins a tie)
+  for (ii = 0; ii < ncands; ii++) {
+    int c = members[ii].cluster;
+    int cand = members[ii].cand;
+    if ((ii == 0) || (members[ii - 1].cluster != c)) {
+      bests[c].cluster = c;
+      bests[c].first = ii;
+      bests[c].size = 0;
+      bests[c].best = cand;
+      bests[c].snr = cands->snrs[cand];
+    }
+    bests[c].size++;
+    if ((cands->snrs[cand] > bests[c].snr) || ((cands->snrs[cand] == bests[c].snr) && (cand < bests[c].best))) {
+      bests[c].best = cand;
+      bests[c].snr = cands->snrs[cand];
+    }
+  }
+  qsort(bests, nclusters, sizeof(clusterBest), compareBest);
+
+  // the largest cluster, as a check that the tolerances suit the density of the candidates
+  int largest = 0;
+  for (ii = 1; ii < nclusters; ii++) {
+    if (bests[ii].size > bests[largest].size) {
+      largest = ii;
+    }
+  }
+  if (nclusters > 0) {
+    printf("Largest cluster: %d candidates, DM %.5f to %.5f.\n", bests[largest].size, members[bests[largest].first].dm, members[bests[largest].first + bests[largest].size - 1].dm);
+  }
+
+  fprintf(outputfile, "# SNR | Period (ms) | DM | Candidates | Lowest DM | Highest DM\n");
+  if (curvefile != NULL) {
+    fprintf(curvefile, "# Cluster | DM | SNR\n");
+  }
+
+  int reported = 0;
+  for (ii = 0; ii < nclusters; ii++) {
+
+    if ((bests[ii].snr < minsnr) || (bests[ii].size < mincands)) {
+      continue;
+    }
+
+    int best = bests[ii].best;
+    int first = bests[ii].first;
+    int last = first + bests[ii].size - 1;
+    fprintf(outputfile, "%.1f %.8f %.5f %d %.5f %.5f\n", cands->snrs[best], cands->periods[best], cands->dms[best], bests[ii].size, members[first].dm, members[last].dm);
+
+    // the DM-SNR curve takes the strongest member at each DM
+    if (curvefile != NULL) {
+      for (jj = first; jj <= last; jj++) {
+	double snr = cands->snrs[members[jj].cand];
+	while ((jj < last) && (members[jj + 1].dm == members[jj].dm)) {
+	  jj++;
+	  if (cands->snrs[members[jj].cand] > snr) {
+	    snr = cands->snrs[members[jj].cand];
+	  }
+	}
+	fprintf(curvefile, "%d %.5f %.1f\n", reported, members[jj].dm, snr);
+      }
+    }
+
+    reported++;
+  }
+
+  printf("%d clusters written.\n", reported);
+
+  free(members);
+  free(bests);
+
+  return;
+
+}
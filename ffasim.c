@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <assert.h>
+
+// user defined libraries
+#include "equalstrings.h"
+#include "synthseries.h"
+
+#define TRUE 1
+#define FALSE 0
+
+// output formats
+#define FORMAT_PRESTO 1
+#define FORMAT_RAW8 2
+
+// Program to write synthetic time series of white noise, red noise and pulsars for FFAncy tests and benchmarks
+// The series is generated and written a chunk at a time, so only one chunk is ever held in memory
+// Written by Andrew Cameron
+// Version 1.1 - Last updated 19/10/2026
+
+// CHANGELOG
+// 19/10/2026 - v1.0 - First version. Series are described by a spec file (see synthseries.h), written as PRESTO floats or 8-bit SIGPROC samples.
+// 19/10/2026 - v1.1 - -sigproc renamed -raw8, as the 8-bit output has no SIGPROC header.
+
+// ***** FUNCTION PROTOTYPES *****
+
+// prints out an explanation of how to use the command line interface
+void help();
+
+// ***** MAIN FUNCTION *****
+
+int main(int argc, char** argv) {
+
+  // declare variables and initialise with defaults
+  FILE *specfile = NULL;
+  FILE *outputfile = NULL;
+  long samples = 0;
+  int seed_flag = FALSE;
+  unsigned long long seed = 0;
+  int format = FORMAT_PRESTO;
+  long chunk = 1L << 20;
+
+  int ii; // counter
+
+  // check that a valid number of arguments have been passed
+  if (argc < 2) {
+    help();
+    exit(0);
+  }
+
+  // scan arguments and allocate variables
+  ii = 1;
+  while (ii < argc) {
+    if (equal_strings(argv[ii], "-spec")) {
+      ii++;
+      specfile = fopen(argv[ii], "r");
+      if (specfile == NULL) {
+	printf("ERROR: Unable to open series spec %s.\n", argv[ii]);
+	exit(EXIT_FAILURE);
+      }
+    } else if (equal_strings(argv[ii], "-o")) {
+      ii++;
+      outputfile = fopen(argv[ii], "wb");
+    } else if (equal_strings(argv[ii], "-n")) {
+      ii++;
+      samples = atol(argv[ii]);
+    } else if (equal_strings(argv[ii], "-seed")) {
+      ii++;
+      seed_flag = TRUE;
+      seed = strtoull(argv[ii], NULL, 10);
+    } else if (equal_strings(argv[ii], "-presto")) {
+      format = FORMAT_PRESTO;
+    } else if (equal_strings(argv[ii], "-raw8")) {
+      format = FORMAT_RAW8;
+    } else if (equal_strings(argv[ii], "-chunk")) {
+      ii++;
+      chunk = atol(argv[ii]);
+    } else if (equal_strings(argv[ii], "-h") || equal_strings(argv[ii], "--help")) {
+      help();
+      exit(0);
+    } else {
+      printf("Unknown argument (%s) passed to ffasim.\nUse -h / --help to display help menu with acceptable arguments.\n", argv[ii]);
+      exit(0);
+    }
+    ii++;
+  }
+
+  // test for valid input
+  assert(outputfile != NULL);
+  if (chunk < 1) {
+    printf("Chunk size must be at least 1 sample!\n");
+    exit(0);
+  }
+
+  synthSeries* series = createSynthSeries();
+  if (specfile != NULL) {
+    readSynthSpec(series, specfile);
+    fclose(specfile);
+  }
+
+  // command line settings override the spec
+  if (samples > 0) {
+    series->samples = samples;
+  }
+  if (seed_flag == TRUE) {
+    series->seed = seed;
+    series->seed_flag = TRUE;
+  }
+
+  startSynthSeries(series);
+
+  printf("Generating %ld samples (seed %llu): white RMS %.4f, red RMS %.4f, %d pulsar(s)...\n", series->samples, (unsigned long long)series->seed, series->white, series->red, series->npulsars);
+  for (ii = 0; ii < series->npulsars; ii++) {
+    printf("Pulsar %d: period %.6f samples, duty cycle %.3f%%, height %.4f\n", ii + 1, series->pulsars[ii].period, series->pulsars[ii].dc, series->pulsars[ii].height);
+  }
+
+  double* buffer = (double*)malloc(sizeof(double) * chunk);
+  float* floats = (float*)malloc(sizeof(float) * chunk);
+  unsigned char* bytes = (unsigned char*)malloc(sizeof(unsigned char) * chunk);
+  assert(buffer != NULL && floats != NULL && bytes != NULL);
+
+  long generated;
+  long clipped = 0;
+  long i;
+
+  while ((generated = nextSynthChunk(series, buffer, chunk)) > 0) {
+    if (format == FORMAT_PRESTO) {
+      for (i = 0; i < generated; i++) {
+	floats[i] = (float)buffer[i];
+      }
+      fwrite(floats, sizeof(float), generated, outputfile);
+    } else {
+      // 8-bit samples are rounded and clipped to [0, 255]
+      for (i = 0; i < generated; i++) {
+	double value = floor(buffer[i] + 0.5);
+	if (value < 0) {
+	  value = 0;
+	  clipped++;
+	} else if (value > 255) {
+	  value = 255;
+	  clipped++;
+	}
+	bytes[i] = (unsigned char)value;
+      }
+      fwrite(bytes, sizeof(unsigned char), generated, outputfile);
+    }
+  }
+
+  if (clipped > 0) {
+    printf("WARNING: %ld samples were clipped to fit in 8 bits - consider changing the mean or noise levels.\n", clipped);
+  }
+  printf("Time series complete.\n");
+
+  // cleanup
+  fclose(outputfile);
+  free(buffer);
+  free(floats);
+  free(bytes);
+  deleteSynthSeries(series);
+
+  return 0;
+
+}
+
+// ***** FUNCTION BODIES *****
+
+void help() {
+
+  printf("\nffasim - a program to generate synthetic time series for FFAncy.\n");
+  printf("Version 1.1, last updated 19/10/2026.\n");
+  printf("Written by Andrew Cameron, MPIFR IMPRS PhD Student.\n");
+  printf("\nSeries are written a chunk at a time, so any length of series can be generated in constant memory.\n");
+  printf("The same spec and seed always produce the same series.\n");
+  printf("\n*****\n\n");
+  printf("Input options:\n");
+
+  printf("-spec [file]        Series description, one directive per line (without one, the series is white noise of RMS 1):\n");
+  printf("                    samples [long]\n");
+  printf("                    seed [int]\n");
+  printf("                    mean [double]\n");
+  printf("                    white [rms]\n");
+  printf("                    red [rms] [index] (cutoff)    - power spectrum ~ f^-index (0 < index < 2), flat below 1 / cutoff samples\n");
+  printf("                    pulsar [period] [dc] [height] (shape) (scatter) (phase)\n");
+  printf("                                                  - period in (fractional) samples, duty cycle in percent, shape 1 = top hat\n");
+  printf("                                                    or 2 = Gaussian (as in PROGENY), scattering time in samples, phase at the first sample\n");
+  printf("-n [long]           Number of samples, overriding the spec.\n");
+  printf("-seed [int]         Noise seed, overriding the spec (default = current time).\n");
+  printf("-o [file]           Name of the output time series.\n");
+  printf("-presto             Writes 32-bit floats, as read by ffancy -presto (DEFAULT).\n");
+  printf("-raw8               Writes headerless 8-bit unsigned samples, as read by ffancy without -presto (values are rounded and clipped to 0 - 255).\n");
+  printf("                    No SIGPROC header is written, so other SIGPROC tools cannot read the file.\n");
+  printf("-chunk [long]       Samples generated per chunk (default = 1048576).\n");
+
+  printf("\n----- Miscellaneous -----\n");
+  printf("-h / --help         Displays this useful and informative help menu.\n\n");
+
+  return;
+
+}
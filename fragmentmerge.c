@@ -0,0 +1,150 @@
+// C file for the output stage of threaded FFA runs
+// Andrew Cameron, MPIFR, 19/10/2026
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "fragmentmerge.h"
+
+// the merger thread - pops fragments off the rings in sequence order and writes them out
+static void* runFragmentMerger(void* arg);
+
+fragmentMerger* startFragmentMerger(int workers, long total, FILE* outputs[FRAGMENT_STREAMS]) {
+
+  assert(workers > 0);
+  assert(total >= 0);
+  assert(outputs != NULL);
+
+  fragmentMerger* merger = (fragmentMerger*)malloc(sizeof(fragmentMerger));
+  assert(merger != NULL);
+
+  merger->workers = workers;
+  merger->total = total;
+
+  int i;
+  for (i = 0; i < FRAGMENT_STREAMS; i++) {
+    merger->outputs[i] = outputs[i];
+  }
+
+  merger->rings = (fragmentRing*)malloc(sizeof(fragmentRing)*workers);
+  assert(merger->rings != NULL);
+
+  for (i = 0; i < workers; i++) {
+    merger->rings[i].head = 0;
+    merger->rings[i].count = 0;
+    pthread_mutex_init(&merger->rings[i].lock, NULL);
+    pthread_cond_init(&merger->rings[i].notempty, NULL);
+    pthread_cond_init(&merger->rings[i].notfull, NULL);
+  }
+
+  int error = pthread_create(&merger->thread, NULL, runFragmentMerger, merger);
+  assert(error == 0);
+
+  return merger;
+}
+
+void finishFragmentMerger(fragmentMerger* merger) {
+
+  assert(merger != NULL);
+
+  pthread_join(merger->thread, NULL);
+
+  int i;
+  for (i = 0; i < merger->workers; i++) {
+    pthread_mutex_destroy(&merger->rings[i].lock);
+    pthread_cond_destroy(&merger->rings[i].notempty);
+    pthread_cond_destroy(&merger->rings[i].notfull);
+  }
+
+  free(merger->rings);
+  free(merger);
+
+  return;
+}
+
+void openFragment(fragmentMerger* merger, fragment* x, long sequence) {
+
+  assert(merger != NULL);
+  assert(x != NULL);
+
+  x->sequence = sequence;
+
+  int i;
+  for (i = 0; i < FRAGMENT_STREAMS; i++) {
+    x->data[i] = NULL;
+    x->size[i] = 0;
+    x->streams[i] = NULL;
+    if (merger->outputs[i] != NULL) {
+      x->streams[i] = open_memstream(&x->data[i], &x->size[i]);
+      assert(x->streams[i] != NULL);
+    }
+  }
+
+  return;
+}
+
+void pushFragment(fragmentMerger* merger, fragment* x) {
+
+  assert(merger != NULL);
+  assert(x != NULL);
+
+  // closing the streams finalises data and size
+  int i;
+  for (i = 0; i < FRAGMENT_STREAMS; i++) {
+    if (x->streams[i] != NULL) {
+      fclose(x->streams[i]);
+      x->streams[i] = NULL;
+    }
+  }
+
+  fragmentRing* ring = &merger->rings[x->sequence % merger->workers];
+
+  pthread_mutex_lock(&ring->lock);
+  while (ring->count == FRAGMENT_RING_SIZE) {
+    pthread_cond_wait(&ring->notfull, &ring->lock);
+  }
+  ring->slots[(ring->head + ring->count) % FRAGMENT_RING_SIZE] = *x;
+  ring->count++;
+  pthread_cond_signal(&ring->notempty);
+  pthread_mutex_unlock(&ring->lock);
+
+  return;
+}
+
+static void* runFragmentMerger(void* arg) {
+
+  fragmentMerger* merger = (fragmentMerger*)arg;
+  fragment x;
+  long sequence;
+  int i;
+
+  for (sequence = 0; sequence < merger->total; sequence++) {
+
+    // the next fragment in sequence can only be at the front of one ring
+    fragmentRing* ring = &merger->rings[sequence % merger->workers];
+
+    pthread_mutex_lock(&ring->lock);
+    while (ring->count == 0) {
+      pthread_cond_wait(&ring->notempty, &ring->lock);
+    }
+    x = ring->slots[ring->head];
+    ring->head = (ring->head + 1) % FRAGMENT_RING_SIZE;
+    ring->count--;
+    pthread_cond_signal(&ring->notfull);
+    pthread_mutex_unlock(&ring->lock);
+
+    assert(x.sequence == sequence);
+
+    // write out and release the fragment outside of the lock
+    for (i = 0; i < FRAGMENT_STREAMS; i++) {
+      if (merger->outputs[i] != NULL) {
+	fwrite(x.data[i], 1, x.size[i], merger->outputs[i]);
+      }
+      free(x.data[i]);
+    }
+  }
+
+  return NULL;
+}
@@ -0,0 +1,68 @@
+// Header for the output stage of threaded FFA runs
+// Andrew Cameron, MPIFR, 19/10/2026
+
+// Worker threads write the output of each base period into an in-memory fragment, and hand it to the merger through their own ring buffer
+// Fragment n is always produced by worker n % workers, so a single merger thread can pop the fragments back off in sequence and write them
+// to the real output files - the files only ever see one writer and the output is identical to that of a serial run
+// Each ring has its own lock, shared only by its worker and the merger
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#ifndef FRAGMENTMERGE_H
+#define FRAGMENTMERGE_H
+
+#define TRUE 1
+#define FALSE 0
+
+// number of output streams carried by a fragment - periodogram, profile dump and normalised profile dump
+#define FRAGMENT_STREAMS 3
+
+// number of finished fragments each worker can have queued before it has to wait for the merger
+#define FRAGMENT_RING_SIZE 4
+
+// ***** DATA TYPES *****
+
+// a fragment holds the complete output of one unit of work (one base period) - streams that are not in use have a NULL stream
+typedef struct fragment {
+  long sequence;
+  FILE* streams[FRAGMENT_STREAMS];
+  char* data[FRAGMENT_STREAMS];
+  size_t size[FRAGMENT_STREAMS];
+} fragment;
+
+// a single producer, single consumer queue of fragments
+typedef struct fragmentRing {
+  fragment slots[FRAGMENT_RING_SIZE];
+  int head;
+  int count;
+  pthread_mutex_t lock;
+  pthread_cond_t notempty;
+  pthread_cond_t notfull;
+} fragmentRing;
+
+typedef struct fragmentMerger {
+  int workers;
+  long total;
+  FILE* outputs[FRAGMENT_STREAMS];
+  fragmentRing* rings;
+  pthread_t thread;
+} fragmentMerger;
+
+// ***** FUNCTION PROTOTYPES *****
+
+// creates a merger for total fragments from the given number of workers and starts its thread
+// outputs are the final destinations of each stream (NULL if a stream is not in use)
+fragmentMerger* startFragmentMerger(int workers, long total, FILE* outputs[FRAGMENT_STREAMS]);
+
+// waits for the merger to write out every fragment, then cleans it up
+void finishFragmentMerger(fragmentMerger* merger);
+
+// opens in-memory streams for a new fragment, matching the outputs in use by the merger
+void openFragment(fragmentMerger* merger, fragment* x, long sequence);
+
+// closes a fragment's streams and queues it on its worker's ring - blocks while that ring is full
+void pushFragment(fragmentMerger* merger, fragment* x);
+
+#endif /* FRAGMENTMERGE_H */
@@ -0,0 +1,110 @@
+// C file for the large buffer allocator used by paddedArray and the FFA workspaces
+// Andrew Cameron, MPIFR, 19/10/2026
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <sys/mman.h>
+#include "hugealloc.h"
+
+// Every buffer is preceded by a header (one alignment unit long, so the buffer stays aligned) recording how it was allocated
+typedef struct hugeHeader {
+  void* base;
+  size_t mapsize; // 0 if the buffer came from the heap
+} hugeHeader;
+
+static int hugepagemode = HUGEPAGE_TRANSPARENT;
+static int hugepagewarned = FALSE;
+
+void setHugePageMode(int mode) {
+
+  assert(mode == HUGEPAGE_OFF || mode == HUGEPAGE_TRANSPARENT || mode == HUGEPAGE_EXPLICIT);
+  hugepagemode = mode;
+
+  return;
+}
+
+int getHugePageMode() {
+  return hugepagemode;
+}
+
+void* hugeAlloc(size_t bytes) {
+
+  size_t total = bytes + FFA_ALLOC_ALIGNMENT;
+  void* base = NULL;
+  size_t mapsize = 0;
+
+  if ((hugepagemode != HUGEPAGE_OFF) && (total >= HUGEPAGE_SIZE)) {
+    // map whole huge pages
+    mapsize = ((total + HUGEPAGE_SIZE - 1)/HUGEPAGE_SIZE)*HUGEPAGE_SIZE;
+
+    if (hugepagemode == HUGEPAGE_EXPLICIT) {
+      base = mmap(NULL, mapsize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (base == MAP_FAILED) {
+	// only warn once, the pool is not going to grow during the run
+	if (hugepagewarned == FALSE) {
+	  printf("WARNING: Could not allocate %zu bytes of explicit huge pages - falling back to transparent huge pages.\n", mapsize);
+	  hugepagewarned = TRUE;
+	}
+	base = NULL;
+      }
+    }
+
+    if (base == NULL) {
+      // mmap only promises page alignment, and a huge page can only back a whole aligned 2 MB - so one extra huge page is mapped,
+      // and the mapping trimmed to start on a huge page boundary, leaving every page of the buffer eligible
+      char* raw = (char*)mmap(NULL, mapsize + HUGEPAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      assert(raw != MAP_FAILED);
+      char* start = (char*)(((uintptr_t)raw + HUGEPAGE_SIZE - 1) & ~(uintptr_t)(HUGEPAGE_SIZE - 1));
+      size_t head = start - raw;
+      if (head > 0) {
+	munmap(raw, head);
+      }
+      if (HUGEPAGE_SIZE - head > 0) {
+	munmap(start + mapsize, HUGEPAGE_SIZE - head);
+      }
+      base = start;
+#ifdef MADV_HUGEPAGE
+      // only a hint - the kernel may not have transparent huge pages enabled
+      madvise(base, mapsize, MADV_HUGEPAGE);
+#endif
+    }
+  } else {
+    int error = posix_memalign(&base, FFA_ALLOC_ALIGNMENT, total);
+    assert(error == 0);
+  }
+
+  hugeHeader* header = (hugeHeader*)base;
+  header->base = base;
+  header->mapsize = mapsize;
+
+  return (char*)base + FFA_ALLOC_ALIGNMENT;
+}
+
+void hugeFree(void* buffer) {
+
+  if (buffer == NULL) {
+    return;
+  }
+
+  hugeHeader* header = (hugeHeader*)((char*)buffer - FFA_ALLOC_ALIGNMENT);
+
+  if (header->mapsize > 0) {
+    munmap(header->base, header->mapsize);
+  } else {
+    free(header->base);
+  }
+
+  return;
+}
+
+void hugeTouch(void* buffer, size_t bytes) {
+
+  assert(buffer != NULL);
+  memset(buffer, 0, bytes);
+
+  return;
+}
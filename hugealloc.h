@@ -0,0 +1,47 @@
+// Header for the large buffer allocator used by paddedArray and the FFA workspaces
+// Andrew Cameron, MPIFR, 19/10/2026
+
+// Buffers are always FFA_ALLOC_ALIGNMENT aligned, and large buffers can be backed by huge pages to cut TLB misses
+// No pages are touched on allocation - on NUMA machines pages are placed on the node of the thread that first writes to them,
+// so buffers should be filled (or cleared with hugeTouch()) by the thread that will process them
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef HUGEALLOC_H
+#define HUGEALLOC_H
+
+#define TRUE 1
+#define FALSE 0
+
+// alignment (in bytes) of every buffer returned by hugeAlloc
+#define FFA_ALLOC_ALIGNMENT 64
+
+// Huge page modes
+// HUGEPAGE_OFF - plain aligned heap allocations
+// HUGEPAGE_TRANSPARENT - large buffers are mapped separately, aligned to HUGEPAGE_SIZE, and marked for transparent huge pages (madvise)
+// HUGEPAGE_EXPLICIT - large buffers are taken from the reserved huge page pool (MAP_HUGETLB), falling back to transparent huge pages if the pool is empty
+#define HUGEPAGE_OFF 0
+#define HUGEPAGE_TRANSPARENT 1
+#define HUGEPAGE_EXPLICIT 2
+
+// buffers smaller than this are never given huge pages
+#define HUGEPAGE_SIZE (2*1024*1024)
+
+// ***** FUNCTION PROTOTYPES *****
+
+// sets the huge page mode used for all subsequent allocations (default HUGEPAGE_TRANSPARENT)
+void setHugePageMode(int mode);
+
+int getHugePageMode();
+
+// returns an aligned buffer of at least bytes bytes, with uninitialised contents - must be released with hugeFree()
+void* hugeAlloc(size_t bytes);
+
+// releases a buffer returned by hugeAlloc()
+void hugeFree(void* buffer);
+
+// zeroes a buffer, faulting in its pages on the calling thread's NUMA node
+void hugeTouch(void* buffer, size_t bytes);
+
+#endif /* HUGEALLOC_H */
@@ -2,80 +2,353 @@
 // Andrew Cameron, MPIFR, 29/04/2015
 
 // AS OF 07/04/2015, CURRENTLY IN TESTING PHASE - POTENTIAL ERRORS IN ALGORITHM HAVE BEEN IDENTIFIED AND ARE BEING INVESTIGATED.
+// 19/10/2026 - mad() no longer sorts - see mad.h
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <math.h>
+#include <pthread.h>
 #include "ffadata.h"
 #include "mad.h"
 
+#define TRUE 1
+#define FALSE 0
+
+// stages of a pass over the array
+#define MAD_RANGE 0 // minimum, maximum, and whether every value is an integer
+#define MAD_COUNT 1 // histogram / bucket counts
+#define MAD_GATHER 2 // copy out the values in the bucket holding the target
+#define MAD_SCALE 3 // apply the normalisation
+
+// one thread's share of a pass - the values examined are x, or |x - centre| when absolute is set
+typedef struct madJob {
+  int stage;
+  ffadata* array;
+  int start;
+  int end;
+  int absolute;
+  ffadata centre;
+  double low; // lowest value, used to place values in bins
+  double binscale; // bins per unit value
+  int nbins;
+  int integral;
+  double min;
+  double max;
+  int* counts; // this thread's counts, nbins long
+  int target; // the bucket being gathered
+  ffadata* gathered; // where this thread's values from the target bucket go
+  double scale; // MAD_SCALE divisor
+} madJob;
+
+static void* madWorker(void* arg);
+static void runMadJobs(madJob* jobs, int threads);
+static ffadata rankValue(madJob* jobs, int threads, int size, int rank);
+static ffadata selectRank(ffadata* array, int size, int rank);
+
 void mad(ffadata* array, int size) {
 
+  parallelMad(array, size, 1);
+
+  return;
+}
+
+void parallelMad(ffadata* array, int size, int threads) {
+
   //printf("Entered MAD normalisation function...\n");
 
   assert(array != NULL);
+  assert(size > 0);
+  assert(threads > 0);
   int i;
 
-  // STEP 1 - Get the median of the array
-  
-  // copy array for sorting
-  ffadata* sortedarray = (ffadata*)malloc(sizeof(ffadata)*size);
-  for (i = 0; i < size; i++) {
-    sortedarray[i] = array[i];
-    
-    // TEST SECTION
-    //printf("%d %f\n", i, sortedarray[i]); 
+  int median_pos = floor((double)size/((double)2));
+  ffadata median, median_deviance;
+
+  if (size < MAD_SELECT_SIZE) {
+
+    // small arrays - a copy and two selections
+    ffadata* copyarray = (ffadata*)malloc(sizeof(ffadata)*size);
+    assert(copyarray != NULL);
+    for (i = 0; i < size; i++) {
+      copyarray[i] = array[i];
+    }
+    median = selectRank(copyarray, size, median_pos);
+    for (i = 0; i < size; i++) {
+      copyarray[i] = fabs(array[i] - median);
+    }
+    median_deviance = selectRank(copyarray, size, median_pos);
+    free(copyarray);
+
+  } else {
+
+    // large arrays - split into a contiguous slice per thread
+    if (threads > size/MAD_SELECT_SIZE) {
+      threads = size/MAD_SELECT_SIZE;
+    }
+    madJob jobs[threads];
+    int t;
+    for (t = 0; t < threads; t++) {
+      jobs[t].array = array;
+      jobs[t].start = (int)(((long)size * t)/threads);
+      jobs[t].end = (int)(((long)size * (t + 1))/threads);
+      jobs[t].absolute = FALSE;
+      jobs[t].centre = 0;
+    }
+
+    // STEP 1 - Get the median of the array
+    median = rankValue(jobs, threads, size, median_pos);
+
+    // STEP 2 & 3 - Get the median of the absolute deviances from it (MAD)
+    for (t = 0; t < threads; t++) {
+      jobs[t].absolute = TRUE;
+      jobs[t].centre = median;
+    }
+    median_deviance = rankValue(jobs, threads, size, median_pos);
+
+    // STEP 4 - Remove the median and divide all elements by MAD * K
+    for (t = 0; t < threads; t++) {
+      jobs[t].stage = MAD_SCALE;
+      jobs[t].scale = median_deviance * K;
+    }
+    runMadJobs(jobs, threads);
+
+    return;
+  }
 
+  // STEP 4 - Remove the median and divide all elements by MAD * K
+  for (i = 0; i < size; i++) {
+    array[i] = (array[i] - median)/(median_deviance * K);
   }
 
-  //printf("Array copied...\n");
+  //printf("MAD normalisation complete.\n");
+  return;
+}
 
-  // sort array
-  qsort(sortedarray, size, sizeof(ffadata), compare);
+// finds the value that would sit at position rank if the size values examined by the jobs were sorted
+static ffadata rankValue(madJob* jobs, int threads, int size, int rank) {
 
-  // TEST SECTION
-  /*printf("Array sorted...displaying contents\n");
-  for (i = 0; i < size; i++) {
-     printf("%d %f\n", i, sortedarray[i]); 
-     }*/
+  assert(rank >= 0 && rank < size);
 
-  // get median
-  int median_pos = floor((double)size/((double)2));
-  ffadata median = sortedarray[median_pos];
+  int t, b;
 
-  //printf("Median obtained = %f...\n", median);
-  
-  // STEP 2 - Remove median and calculate the absolute value of the deviances
+  // range of the values, and whether they can be counted directly
+  for (t = 0; t < threads; t++) {
+    jobs[t].stage = MAD_RANGE;
+  }
+  runMadJobs(jobs, threads);
+
+  double min = jobs[0].min;
+  double max = jobs[0].max;
+  int integral = jobs[0].integral;
+  for (t = 1; t < threads; t++) {
+    if (jobs[t].min < min) {
+      min = jobs[t].min;
+    }
+    if (jobs[t].max > max) {
+      max = jobs[t].max;
+    }
+    integral = integral && jobs[t].integral;
+  }
 
-  ffadata* deviances = (ffadata*)malloc(sizeof(ffadata)*size);
-  for (i = 0; i < size; i++) {
-    array[i] = array[i] - median;
-    deviances[i] = fabs(array[i]);
-    //printf("Deviance %d: %f\n", i, array[i]); 
-    //printf("Abs. Deviance %d: %f\n", i, deviances[i]); 
+  if (min == max) {
+    return min;
   }
 
-  //printf("Median removed...\n");
+  // integers are counted one bin per value, anything else is spread over MAD_BUCKETS
+  int nbins;
+  double binscale;
+  if ((integral == TRUE) && (max - min < MAD_HISTOGRAM_RANGE)) {
+    nbins = (int)(max - min) + 1;
+    binscale = 1;
+  } else {
+    integral = FALSE;
+    nbins = MAD_BUCKETS;
+    binscale = MAD_BUCKETS/(max - min);
+  }
 
-  // STEP 3 - Get the median of the deviances (MAD)
-  qsort(deviances, size, sizeof(ffadata), compare);
-  ffadata median_deviance = deviances[median_pos];
+  int* counts = (int*)calloc((size_t)nbins * threads, sizeof(int));
+  assert(counts != NULL);
+  for (t = 0; t < threads; t++) {
+    jobs[t].stage = MAD_COUNT;
+    jobs[t].low = min;
+    jobs[t].binscale = binscale;
+    jobs[t].nbins = nbins;
+    jobs[t].counts = &counts[(size_t)nbins * t];
+  }
+  runMadJobs(jobs, threads);
+
+  // walk the merged counts to the bin holding the rank
+  long below = 0;
+  int incount = 0;
+  for (b = 0; b < nbins; b++) {
+    incount = 0;
+    for (t = 0; t < threads; t++) {
+      incount = incount + jobs[t].counts[b];
+    }
+    if (below + incount > rank) {
+      break;
+    }
+    below = below + incount;
+  }
+  assert(b < nbins);
+
+  ffadata value;
+  if (integral == TRUE) {
+    value = min + b;
+  } else {
+    // collect the bin's values, each thread into its own part of the buffer, and select within them
+    ffadata* gathered = (ffadata*)malloc(sizeof(ffadata) * incount);
+    assert(gathered != NULL);
+    int offset = 0;
+    for (t = 0; t < threads; t++) {
+      jobs[t].stage = MAD_GATHER;
+      jobs[t].target = b;
+      jobs[t].gathered = &gathered[offset];
+      offset = offset + jobs[t].counts[b];
+    }
+    runMadJobs(jobs, threads);
+    value = selectRank(gathered, incount, rank - (int)below);
+    free(gathered);
+  }
 
-  //printf("Median deviance obtained = %f...\n", median_deviance);
+  free(counts);
 
-  // STEP 4 - Divide all elements by MAD * K
-  for (i = 0; i < size; i++) {
-    array[i] = array[i]/(median_deviance * K);
+  return value;
+}
+
+static void runMadJobs(madJob* jobs, int threads) {
+
+  if (threads == 1) {
+    madWorker(&jobs[0]);
+    return;
   }
 
-  free(sortedarray);
-  free(deviances);
+  pthread_t workers[threads];
+  int t;
+  for (t = 0; t < threads; t++) {
+    int error = pthread_create(&workers[t], NULL, madWorker, &jobs[t]);
+    assert(error == 0);
+  }
+  for (t = 0; t < threads; t++) {
+    pthread_join(workers[t], NULL);
+  }
 
-  //printf("MAD normalisation complete.\n");
   return;
 }
 
+static void* madWorker(void* arg) {
+
+  madJob* job = (madJob*)arg;
+  ffadata* array = job->array;
+  int i;
+
+  if (job->stage == MAD_SCALE) {
+    for (i = job->start; i < job->end; i++) {
+      array[i] = (array[i] - job->centre)/job->scale;
+    }
+    return NULL;
+  }
+
+  if (job->stage == MAD_RANGE) {
+    double min = HUGE_VAL;
+    double max = -HUGE_VAL;
+    int integral = TRUE;
+    for (i = job->start; i < job->end; i++) {
+      double value = (job->absolute == TRUE) ? fabs(array[i] - job->centre) : array[i];
+      if (value < min) {
+	min = value;
+      }
+      if (value > max) {
+	max = value;
+      }
+      if (value != floor(value)) {
+	integral = FALSE;
+      }
+    }
+    job->min = min;
+    job->max = max;
+    job->integral = integral;
+    return NULL;
+  }
+
+  // MAD_COUNT and MAD_GATHER place each value in a bin in the same way
+  int gathered = 0;
+  for (i = job->start; i < job->end; i++) {
+    double value = (job->absolute == TRUE) ? fabs(array[i] - job->centre) : array[i];
+    double position = (value - job->low) * job->binscale;
+    // NaNs (e.g. left by an earlier normalisation with a MAD of zero) have no place in the range, and are kept in the first bin
+    int bin;
+    if (!(position >= 0)) {
+      bin = 0;
+    } else if (position >= job->nbins) {
+      bin = job->nbins - 1;
+    } else {
+      bin = (int)position;
+    }
+    if (job->stage == MAD_COUNT) {
+      job->counts[bin]++;
+    } else if (bin == job->target) {
+      job->gathered[gathered] = value;
+      gathered++;
+    }
+  }
+
+  return NULL;
+}
+
+// quickselect - returns the value at position rank once sorted, reordering the array in the process
+static ffadata selectRank(ffadata* array, int size, int rank) {
+
+  assert(rank >= 0 && rank < size);
+
+  int low = 0;
+  int high = size - 1;
+  ffadata swap;
+
+  while (high > low) {
+
+    // median-of-three pivot
+    int middle = low + (high - low)/2;
+    if (array[middle] < array[low]) {
+      swap = array[middle]; array[middle] = array[low]; array[low] = swap;
+    }
+    if (array[high] < array[low]) {
+      swap = array[high]; array[high] = array[low]; array[low] = swap;
+    }
+    if (array[high] < array[middle]) {
+      swap = array[high]; array[high] = array[middle]; array[middle] = swap;
+    }
+    ffadata pivot = array[middle];
+
+    int i = low;
+    int j = high;
+    while (i <= j) {
+      while (array[i] < pivot) {
+	i++;
+      }
+      while (array[j] > pivot) {
+	j--;
+      }
+      if (i <= j) {
+	swap = array[i]; array[i] = array[j]; array[j] = swap;
+	i++;
+	j--;
+      }
+    }
+
+    if (rank <= j) {
+      high = j;
+    } else if (rank >= i) {
+      low = i;
+    } else {
+      return array[rank];
+    }
+  }
+
+  return array[rank];
+}
+
 ffadata* getDeviances(ffadata* array, int size) {
 
   assert(array != NULL);
@@ -2,6 +2,9 @@
 // Andrew Cameron, MPIFR, 29/04/2015
 
 // STILL IN PROTOTYPING STAGES - TESTED NEEDED BEFORE FULL IMPLEMENTATION
+// 19/10/2026 - The median and MAD are now found exactly without sorting: by counting for integer data (raw 8-bit samples and
+//              everything downsampled, since downsampling truncates to integers), otherwise by a bucket pass followed by a
+//              selection within the one bucket holding the median. parallelMad() spreads the passes over several threads.
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -12,11 +15,23 @@
 
 #define K 1.4826
 
+// arrays shorter than this (e.g. folded profiles) are copied and searched directly with a quickselect
+#define MAD_SELECT_SIZE 65536
+
+// integer data spanning at most this many values is counted exactly in a histogram
+#define MAD_HISTOGRAM_RANGE 1048576
+
+// number of buckets used to narrow down the median of non-integer data
+#define MAD_BUCKETS 65536
+
 // ***** FUNCTION PROTOTYPES *****
 
 // takes in an array of data and normalises it via the MAD technique
 void mad(ffadata* array, int size); //DONE
 
+// as mad(), with the passes over the array split between a number of threads - results are identical for any number of threads
+void parallelMad(ffadata* array, int size, int threads);
+
 ffadata* getDeviances(ffadata* array, int size);
 
 // a particular MAD variant for application to folded profiles from datasets already MAD normalised
@@ -1,8 +1,13 @@
 // Implementation of Metric 2 - Kondratiev Matched Filter Metric
 // Applies varying matched filters to a folded profile, then applies the Kondratiev Metric 
-// CAUTION - Refers to Metric 5 (the non matched filter version) as part of its operation - changing Metric 5 will change this metric. 
+// CAUTION - Reproduces the statistics of Metric 5 (the non matched filter version) inline as part of its operation - changing Metric 5 requires the same change here. 
 // Andrew Cameron, MPIFR, 08/04/2014
 
+// CHANGELOG
+// 19/10/2026 - Each matched-filter layer is now built and scored in a single fused sweep, instead of building the layer and then calling kondratievMetric()
+//              (which rescanned it twice). The layer sum, and the sum and sum of squares about a reference baseline, are accumulated while the layer is built.
+//              Only the exclusion window is revisited to remove its contribution, so the scoring cost per layer drops from ~3n to ~1.2n.
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -11,6 +16,11 @@
 #include "ffadata.h"
 
 #define MAX_FILTER_WIDTH 0.2
+#define KONDRATIEV_EXCLUSION_WIDTH 0.2
+
+// scores one matched-filter layer with the Kondratiev statistic, given the statistics gathered while the layer was built
+// I_total is the plain sum of the layer (summed in index order, as Metric 5 does), sum and sumsq are taken about the reference baseline
+static double kondratievLayerSNR(ffadata* layer, int subsize, ffadata I_max, int I_maxpos, double I_total, double baseline, double sum, double sumsq);
 
 ffadata kondratievMFMetric(ffadata* sourcearray, int startpos, int subsize) {
 
@@ -25,18 +35,45 @@ ffadata kondratievMFMetric(ffadata* sourcearray, int startpos, int subsize) {
   double max_SNR; // stores the maximum SNR detection from this profile across all matched filters
   double temp_SNR; // stores temporary SNR to save on repeated execution
 
+  // running statistics of the layer currently being built
+  ffadata I_max;
+  int I_maxpos;
+  double I_total;
+  double baseline;
+  double sum;
+  double sumsq;
+  double deviation;
+
   // loop counters
   int ii;
   int jj;
 
-  // create a copy of the array
+  // create a copy of the array, gathering the statistics of the unfiltered profile as we go
+  // the baseline used for the sums of squares is taken from the raw profile mean - each layer doubles the mean, so it stays well conditioned
   ffadata* copyarray = (ffadata*)malloc(sizeof(ffadata) * subsize);
+  I_max = sourcearray[startpos];
+  I_maxpos = 0;
+  I_total = 0;
   for (ii = 0; ii < subsize; ii++) {
     copyarray[ii] = sourcearray[ii + startpos];
+    if (copyarray[ii] > I_max) {
+      I_max = copyarray[ii];
+      I_maxpos = ii;
+    }
+    I_total = I_total + copyarray[ii];
+  }
+
+  baseline = I_total/((double)subsize);
+  sum = 0;
+  sumsq = 0;
+  for (ii = 0; ii < subsize; ii++) {
+    deviation = copyarray[ii] - baseline;
+    sum = sum + deviation;
+    sumsq = sumsq + deviation*deviation;
   }
 
-  // as a baseline, first perform a scan for a matched filter size of 1
-  max_SNR = kondratievMetric(copyarray, 0, subsize);
+  // as a baseline, first score the matched filter size of 1
+  max_SNR = kondratievLayerSNR(copyarray, subsize, I_max, I_maxpos, I_total, baseline, sum, sumsq);
 
   // now begin the metric proper - begin scanning through successive matched filters of power 2
   // build copy and temp arrays to use for optimised pointer swapping
@@ -46,14 +83,33 @@ ffadata kondratievMFMetric(ffadata* sourcearray, int startpos, int subsize) {
   for (ii = 0; ii < n_layers; ii++) {
     int shift = 1 << ii;
 
-    // convolve the matched filter and scan for max SNR simultaneously
+    // each boxcar layer doubles the sum of the one before it
+    baseline = 2*baseline;
+
+    // convolve the matched filter and gather the layer statistics simultaneously
+    I_max = copyarray[0] + copyarray[shift % subsize];
+    I_maxpos = 0;
+    I_total = 0;
+    sum = 0;
+    sumsq = 0;
+
     for (jj = 0; jj < subsize; jj++) {
       resultarray[jj] = copyarray[jj] + copyarray[(jj + shift + subsize)%subsize];
+
+      if (resultarray[jj] > I_max) {
+	I_max = resultarray[jj];
+	I_maxpos = jj;
+      }
+      I_total = I_total + resultarray[jj];
+
+      deviation = resultarray[jj] - baseline;
+      sum = sum + deviation;
+      sumsq = sumsq + deviation*deviation;
     }
     
     // convolved array is complete
-    // apply Kondratiev Metric and evaluate if the new SNR is higher
-    temp_SNR = kondratievMetric(resultarray, 0, subsize);
+    // evaluate if the new SNR is higher
+    temp_SNR = kondratievLayerSNR(resultarray, subsize, I_max, I_maxpos, I_total, baseline, sum, sumsq);
     if (temp_SNR > max_SNR) {
       max_SNR = temp_SNR;
     }
@@ -73,3 +129,43 @@ ffadata kondratievMFMetric(ffadata* sourcearray, int startpos, int subsize) {
   return max_SNR;
 
 }
+
+static double kondratievLayerSNR(ffadata* layer, int subsize, ffadata I_max, int I_maxpos, double I_total, double baseline, double sum, double sumsq) {
+
+  // The exclusion window follows Metric 5 exactly:
+  // - I_average excludes the full 20% window, wrapping around the end of the profile
+  // - the RMS only excludes the part of the window that does not wrap, but is still normalised by the remaining length
+  // Both are handled here by removing the window's contribution from the layer totals, which only needs the window to be revisited
+
+  int exclusion_halfwidth = (int)ceil(subsize*KONDRATIEV_EXCLUSION_WIDTH/(double)2); // half of the exclusion window in sample sizes
+  int exclusion_start = (I_maxpos - exclusion_halfwidth + subsize)%subsize; // have to add an extra subsize because % can't handle negative numbers properly
+  int rms_count = subsize;
+  double deviation;
+
+  int i;
+  for (i = exclusion_start; i < exclusion_start + 2*exclusion_halfwidth; i++) {
+    I_total = I_total - layer[i%subsize];
+
+    if (i < subsize) {
+      deviation = layer[i] - baseline;
+      sum = sum - deviation;
+      sumsq = sumsq - deviation*deviation;
+      rms_count--;
+    }
+  }
+
+  // Window excluded for I_average - finalise
+  int remaining_length = subsize - 2*exclusion_halfwidth;
+  double I_average = I_total/((double)remaining_length);
+
+  // expand sum((x - I_average)^2) about the baseline the sums were accumulated against
+  double offset = I_average - baseline;
+  double RMS = sumsq - 2*offset*sum + rms_count*offset*offset;
+
+  // finalise RMS
+  RMS = sqrt(RMS/((double)remaining_length));
+
+  // return metric
+  return (double)((I_max - I_average)/RMS);
+
+}
@@ -24,3 +24,34 @@ double basicMetric(ffadata* sourcearray, int startpos, int subsize) {
   return result;
 
 }
+
+void basicMetricInterleaved(ffadata* sourcearray, int subsize, int lanes, double* scores) {
+
+  // Return the highest value found in each lane of the group
+  assert(sourcearray != NULL);
+  assert(subsize > 0);
+  assert(scores != NULL);
+
+  ffadata result[lanes];
+
+  int i, l;
+  for (l = 0; l < lanes; l++) {
+    result[l] = 0;
+  }
+
+  // the lanes of each bin are contiguous, so the inner loop runs across all profiles at once
+  for (i = 0; i < subsize; i++) {
+    for (l = 0; l < lanes; l++) {
+      if (sourcearray[i*lanes + l] > result[l]) {
+	result[l] = sourcearray[i*lanes + l];
+      }
+    }
+  }
+
+  for (l = 0; l < lanes; l++) {
+    scores[l] = result[l];
+  }
+
+  return;
+
+}
@@ -47,3 +47,60 @@ double maxminMetric(ffadata* sourcearray, int startpos, int subsize) {
   return (max-min)/sigma;
 
 }
+
+void maxminMetricInterleaved(ffadata* sourcearray, int subsize, int lanes, double* scores) {
+
+  // as maxminMetric, but for each lane of a group of interleaved profiles
+  assert(subsize > 0);
+  assert(sourcearray != NULL);
+  assert(scores != NULL);
+
+  ffadata max[lanes];
+  ffadata min[lanes];
+  double mean[lanes];
+  double sigma[lanes];
+  double deviation;
+
+  int i, l;
+  for (l = 0; l < lanes; l++) {
+    max[l] = sourcearray[l];
+    min[l] = sourcearray[l];
+    mean[l] = 0;
+    sigma[l] = 0;
+  }
+
+  // the lanes of each bin are contiguous, so the inner loops run across all profiles at once
+  for (i = 0; i < subsize; i++) {
+    for (l = 0; l < lanes; l++) {
+      if (sourcearray[i*lanes + l] > max[l]) {
+	max[l] = sourcearray[i*lanes + l];
+      }
+      if (sourcearray[i*lanes + l] < min[l]) {
+	min[l] = sourcearray[i*lanes + l];
+      }
+      mean[l] = mean[l] + sourcearray[i*lanes + l];
+    }
+  }
+
+  // finalise mean
+  for (l = 0; l < lanes; l++) {
+    mean[l] = mean[l]/((double)subsize);
+  }
+
+  // calculate sigma
+  for (i = 0; i < subsize; i++) {
+    for (l = 0; l < lanes; l++) {
+      deviation = sourcearray[i*lanes + l] - mean[l];
+      sigma[l] = sigma[l] + deviation*deviation;
+    }
+  }
+
+  // finalise sigma and return results scaled by sigma
+  for (l = 0; l < lanes; l++) {
+    sigma[l] = sqrt(sigma[l]/((double)subsize));
+    scores[l] = (max[l]-min[l])/sigma[l];
+  }
+
+  return;
+
+}
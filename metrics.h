@@ -5,6 +5,7 @@
 // Changlog
 // 11/09/2016 - reconfigured numbering to fall in line with publication
 //            - Algorithms 6 & 7 now labelled 1 & 2, all other algorithms fall in sequentially as per original ordering
+// 19/10/2026 - added interleaved versions of metrics #3 and #4 for scoring groups of bin-major profiles
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -36,6 +37,16 @@ double integralMetric(ffadata* sourcearray, int startpos, int subsize);
 // #8 - Returns the total subarray average subtracted by the 80% off-peak average
 double averageMetric(ffadata* sourcearray, int startpos, int subsize);
 
+// INTERLEAVED METRICS
+// Score a group of `lanes` profiles stored bin by bin (bin b of lane l at sourcearray[b*lanes + l]), writing one score per lane into scores
+// Each lane gives exactly the same result as the profile-major version of the metric
+
+// #3 - interleaved version of basicMetric
+void basicMetricInterleaved(ffadata* sourcearray, int subsize, int lanes, double* scores);
+
+// #4 - interleaved version of maxminMetric
+void maxminMetricInterleaved(ffadata* sourcearray, int subsize, int lanes, double* scores);
+
 // PRIMARY METRICS
 
 // #1 - Uses multiple sliding top-hat functions, convolved with the profile, to determine and return SNR of pulses - Ewan's metric - returns max SNR of all trials
@@ -4,39 +4,102 @@
 #include <time.h>
 #include <math.h>
 #include <assert.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <sys/stat.h>
 
 // User defined libraries
 #include "metrics.h"
 #include "equalstrings.h"
+#include "profilebank.h"
 
 #define TRUE 1
 #define FALSE 0
 
+// profiles evaluated between writes to the score table
+#define SCORE_BLOCK 4096
+
 // Program to independently test the FFA metrics in isolation from the FFA
 // Written by Andrew Cameron
-// Version 1.1 - Last updated 11/09/2015
+// Version 1.2 - Last updated 19/10/2026
 
 /*
 
 CHANGELOG:
 13/11/2015 - v1.0 - Wrote and basic testing completed
 11/09/2016 - v1.1 - Updated help menu and reconfigured metric numbering for compatibility with publication
+19/10/2026 - v1.2 - Batch mode: any number of text profiles (-i, -dir) and PROGENY profile banks (see profilebank.h) can be evaluated with several
+                    algorithms at once (-a accepts a comma separated list and may be repeated), across threads, writing one row of scores per profile (-o)
+                  - Text profiles are now read in a single pass
+                  - A single text profile evaluated with a single algorithm and no -o still reports its score as before
 */
 
+// ***** DATA TYPES *****
+
+// a block of profiles waiting to be scored - profiles of any length are packed one after another into values
+typedef struct profileBlock {
+  int count;
+  long* offsets; // start of each profile in values
+  int* sizes;
+  int* sources; // input each profile came from
+  int* banked; // TRUE if the profile came from a profile bank and has a record
+  profileRecord* records;
+  double* values;
+  long valuecount;
+  long valuecapacity;
+  double* scores; // count x nmetrics
+} profileBlock;
+
+// everything the scoring threads share
+typedef struct scoreBatch {
+  profileBlock* block;
+  int nmetrics;
+  double (**metrics)(ffadata*, int, int);
+  int next;
+  pthread_mutex_t lock;
+} scoreBatch;
+
 // ***** FUNCTION PROTOTYPES *****
 
 // prints out an explanation of how to use the command line interface
 void metrictester_help();
 
+// returns the metric for an algorithm number, exiting on an invalid choice
+double (*selectMetric(int choice))(ffadata*, int, int);
+
+// adds the algorithms in a comma separated list to the end of the selection, and returns the new number selected
+int addMetrics(char* list, int* choices, int nchoices);
+
+// adds a name to a growing list of inputs, and returns the new number of inputs
+int addInput(char*** names, int* capacity, int ninputs, char* name);
+
+// adds every regular file in a directory to the inputs in name order, and returns the new number of inputs
+int addInputDirectory(char*** names, int* capacity, int ninputs, char* dirname);
+
+// reads a whole "%d %lf" text profile in a single pass - returns the values (heap allocated) and their number via size
+double* readTextProfile(FILE* inputfile, int* size);
+
+// makes room for another profile of size values at the end of a block, and returns its position in the block
+int addToBlock(profileBlock* block, int size, int source);
+
+// scores every profile of a block with every selected metric, across threads
+void scoreBlock(scoreBatch* batch, int threads);
+
+// writes a block's scores out as table rows and empties it
+void writeBlock(FILE* outputfile, profileBlock* block, char** names, int nmetrics);
+
 // ***** MAIN FUNCTION *****
 
 int main(int argc, char** argv) {
 
   // declare variables and initialise with defaults
-  int metric_choice = 0;
-  FILE *inputfile = NULL;
-
-  double (*metric)(ffadata*, int, int);
+  int choices[64];
+  int nchoices = 0;
+  char** names = NULL;
+  int capacity = 0;
+  int ninputs = 0;
+  FILE *outputfile = NULL;
+  int threads = 1;
 
   int i; // counter
 
@@ -52,13 +115,23 @@ int main(int argc, char** argv) {
     while (i < argc) {
       if (equal_strings(argv[i],"-a")) {
 	i++;
-	metric_choice = atoi(argv[i]);
+	nchoices = addMetrics(argv[i], choices, nchoices);
       } else if (equal_strings(argv[i], "-h") || equal_strings(argv[i], "--help")) {
 	metrictester_help();
 	exit(0);
       } else if (equal_strings(argv[i], "-i")) {
 	i++;
-	inputfile = fopen(argv[i], "r");
+	ninputs = addInput(&names, &capacity, ninputs, argv[i]);
+      } else if (equal_strings(argv[i], "-dir")) {
+	i++;
+	ninputs = addInputDirectory(&names, &capacity, ninputs, argv[i]);
+      } else if (equal_strings(argv[i], "-o")) {
+	i++;
+	outputfile = fopen(argv[i], "w+");
+	assert(outputfile != NULL);
+      } else if (equal_strings(argv[i], "-threads")) {
+	i++;
+	threads = atoi(argv[i]);
       } else {
 	printf("Unknown argument (%s) passed to Metric Tester.\nUse -h / --help to display help menu with acceptable arguments.\n",argv[i]);
 	exit(0);
@@ -68,89 +141,431 @@ int main(int argc, char** argv) {
   }
 
   // test for valid input
+  assert(ninputs > 0);
+  if (nchoices == 0) {
+    printf("Invalid algorithm choice!\n");
+    exit(0);
+  }
+  if (threads < 1) {
+    printf("Number of threads must be at least 1!\n");
+    exit(0);
+  }
+
+  // assign metrics
+  double (*metrics[64])(ffadata*, int, int);
+  for (i = 0; i < nchoices; i++) {
+    metrics[i] = selectMetric(choices[i]);
+  }
+
+  FILE *inputfile = fopen(names[0], "rb");
   assert(inputfile != NULL);
+  int nbins;
+
+  if ((ninputs == 1) && (nchoices == 1) && (outputfile == NULL) && (readProfileBankHeader(inputfile, &nbins) == FALSE)) {
+
+    // a single text profile and algorithm - report the score directly
+    int size = 0;
+    double* dataarray = readTextProfile(inputfile, &size);
+    printf("\nFile is %d lines long.\n", size);
+
+    // close input file
+    fclose(inputfile);
+    printf("\n*** FILE READ COMPLETE ***\n\n");
+
+    printf("Now applying Algorithm %d to profile...\n", choices[0]);
+
+    double score = metrics[0](dataarray, 0, size);
+
+    // report score to command line
+    printf("SCORE: %.10f\n", score);
+
+    // cleanup
+    free(dataarray);
+    free(names[0]);
+    free(names);
+    printf("\nMetric Tester complete.\n");
+
+    return 0;
+  }
+  fclose(inputfile);
+
+  // batch mode - scores go to the table, or stdout without -o
+  int tofile = (outputfile != NULL) ? TRUE : FALSE;
+  if (tofile == FALSE) {
+    outputfile = stdout;
+  }
+
+  fprintf(outputfile, "# Source | Index | Width | Height | Scatter | Sigma");
+  for (i = 0; i < nchoices; i++) {
+    fprintf(outputfile, " | Algorithm %d", choices[i]);
+  }
+  fprintf(outputfile, "\n");
+
+  profileBlock block;
+  block.count = 0;
+  block.offsets = (long*)malloc(sizeof(long) * SCORE_BLOCK);
+  block.sizes = (int*)malloc(sizeof(int) * SCORE_BLOCK);
+  block.sources = (int*)malloc(sizeof(int) * SCORE_BLOCK);
+  block.banked = (int*)malloc(sizeof(int) * SCORE_BLOCK);
+  block.records = (profileRecord*)malloc(sizeof(profileRecord) * SCORE_BLOCK);
+  block.scores = (double*)malloc(sizeof(double) * SCORE_BLOCK * nchoices);
+  block.values = NULL;
+  block.valuecount = 0;
+  block.valuecapacity = 0;
+  assert(block.offsets != NULL && block.sizes != NULL && block.sources != NULL && block.banked != NULL && block.records != NULL && block.scores != NULL);
+
+  scoreBatch batch;
+  batch.block = &block;
+  batch.nmetrics = nchoices;
+  batch.metrics = metrics;
+  pthread_mutex_init(&batch.lock, NULL);
+
+  long scored = 0;
+
+  for (i = 0; i < ninputs; i++) {
+
+    inputfile = fopen(names[i], "rb");
+    if (inputfile == NULL) {
+      printf("ERROR: Unable to open input profile %s.\n", names[i]);
+      exit(EXIT_FAILURE);
+    }
 
-  // assign metric
-  if (metric_choice == 3) {
-    metric = basicMetric;
-  } else if (metric_choice == 4) {
-    metric = maxminMetric;
-  } else if (metric_choice == 5) {
-    metric = kondratievMetric;
-  } else if (metric_choice == 6) {
+    if (readProfileBankHeader(inputfile, &nbins) == TRUE) {
+      // every record of a bank, a block at a time
+      while (TRUE) {
+	int slot = addToBlock(&block, nbins, i);
+	if (readProfileRecord(inputfile, &block.records[slot], &block.values[block.offsets[slot]], nbins) == FALSE) {
+	  // nothing more to read - give the slot back
+	  block.count--;
+	  block.valuecount = block.offsets[slot];
+	  break;
+	}
+	block.banked[slot] = TRUE;
+	if (block.count == SCORE_BLOCK) {
+	  scoreBlock(&batch, threads);
+	  scored = scored + block.count;
+	  writeBlock(outputfile, &block, names, nchoices);
+	}
+      }
+    } else {
+      int size = 0;
+      double* profile = readTextProfile(inputfile, &size);
+      if (size > 0) {
+	int slot = addToBlock(&block, size, i);
+	memcpy(&block.values[block.offsets[slot]], profile, sizeof(double) * size);
+	block.banked[slot] = FALSE;
+      } else {
+	printf("WARNING: %s contains no profile - skipped.\n", names[i]);
+      }
+      free(profile);
+      if (block.count == SCORE_BLOCK) {
+	scoreBlock(&batch, threads);
+	scored = scored + block.count;
+	writeBlock(outputfile, &block, names, nchoices);
+      }
+    }
+
+    fclose(inputfile);
+  }
+
+  if (block.count > 0) {
+    scoreBlock(&batch, threads);
+    scored = scored + block.count;
+    writeBlock(outputfile, &block, names, nchoices);
+  }
+
+  if (tofile == TRUE) {
+    fclose(outputfile);
+    printf("%ld profiles from %d input(s) scored with %d algorithm(s).\n", scored, ninputs, nchoices);
+  }
+
+  // cleanup
+  pthread_mutex_destroy(&batch.lock);
+  free(block.offsets);
+  free(block.sizes);
+  free(block.sources);
+  free(block.banked);
+  free(block.records);
+  free(block.scores);
+  free(block.values);
+  for (i = 0; i < ninputs; i++) {
+    free(names[i]);
+  }
+  free(names);
+
+  if (tofile == TRUE) {
+    printf("\nMetric Tester complete.\n");
+  }
+
+  return 0;
+
+}
+
+// ***** FUNCTION BODIES *****
+
+double (*selectMetric(int choice))(ffadata*, int, int) {
+
+  if (choice == 3) {
+    return basicMetric;
+  } else if (choice == 4) {
+    return maxminMetric;
+  } else if (choice == 5) {
+    return kondratievMetric;
+  } else if (choice == 6) {
     printf("Algorithm 6 has been permanently disabled. Please select a different metric.\n");
     exit(0);
-  } else if (metric_choice == 7) {
-    metric = integralMetric;
-  } else if (metric_choice == 8) {
-    metric = averageMetric;
-  } else if (metric_choice == 1) {
-    metric = postMadMatchedFilterMetric;
-  } else if (metric_choice == 2) {
-    metric = kondratievMFMetric;
-  } else {
-    printf("Invalid algorithm choice!\n");
-    exit(0);
+  } else if (choice == 7) {
+    return integralMetric;
+  } else if (choice == 8) {
+    return averageMetric;
+  } else if (choice == 1) {
+    return postMadMatchedFilterMetric;
+  } else if (choice == 2) {
+    return kondratievMFMetric;
+  }
+
+  printf("Invalid algorithm choice!\n");
+  exit(0);
+}
+
+int addMetrics(char* list, int* choices, int nchoices) {
+
+  assert(list != NULL);
+  assert(choices != NULL);
+
+  char* position = list;
+  while (*position != '\0') {
+    char* end;
+    long choice = strtol(position, &end, 10);
+    if (end == position) {
+      printf("Invalid algorithm choice!\n");
+      exit(0);
+    }
+    if (nchoices == 64) {
+      printf("Too many algorithms selected!\n");
+      exit(0);
+    }
+    choices[nchoices] = (int)choice;
+    nchoices++;
+    position = (*end == ',') ? end + 1 : end;
   }
 
-  // intialise array based on input selection
+  return nchoices;
+}
+
+int addInput(char*** names, int* capacity, int ninputs, char* name) {
+
+  assert(names != NULL);
+  assert(capacity != NULL);
+  assert(name != NULL);
+
+  if (ninputs == *capacity) {
+    *capacity = (*capacity == 0) ? 16 : 2*(*capacity);
+    *names = (char**)realloc(*names, sizeof(char*)*(*capacity));
+    assert(*names != NULL);
+  }
+  (*names)[ninputs] = strdup(name);
+
+  return ninputs + 1;
+}
+
+static int compareNames(const void* a, const void* b) {
+
+  return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+int addInputDirectory(char*** names, int* capacity, int ninputs, char* dirname) {
+
+  assert(dirname != NULL);
+
+  DIR* directory = opendir(dirname);
+  if (directory == NULL) {
+    printf("ERROR: Unable to open profile directory %s.\n", dirname);
+    exit(EXIT_FAILURE);
+  }
+
+  int first = ninputs;
+  struct dirent* entry;
+  while ((entry = readdir(directory)) != NULL) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    char path[strlen(dirname) + strlen(entry->d_name) + 2];
+    sprintf(path, "%s/%s", dirname, entry->d_name);
+    struct stat status;
+    if ((stat(path, &status) == 0) && S_ISREG(status.st_mode)) {
+      ninputs = addInput(names, capacity, ninputs, path);
+    }
+  }
+  closedir(directory);
+
+  // directory order is arbitrary - sort so that tables come out the same every time
+  qsort(&(*names)[first], ninputs - first, sizeof(char*), compareNames);
+
+  return ninputs;
+}
+
+double* readTextProfile(FILE* inputfile, int* size) {
+
+  assert(inputfile != NULL);
+  assert(size != NULL);
 
   int bin;
   double value;
-  int size = 0;  
+  int capacity = 1024;
+  int count = 0;
+  double* dataarray = (double*)malloc(sizeof(double) * capacity);
+  assert(dataarray != NULL);
+
+  while (fscanf(inputfile, "%d %lf", &bin, &value) == 2) {
+    if (count == capacity) {
+      capacity = 2*capacity;
+      dataarray = (double*)realloc(dataarray, sizeof(double) * capacity);
+      assert(dataarray != NULL);
+    }
+    dataarray[count] = value;
+    count++;
+  }
+
+  *size = count;
+
+  return dataarray;
+}
+
+int addToBlock(profileBlock* block, int size, int source) {
+
+  assert(block != NULL);
+  assert(block->count < SCORE_BLOCK);
 
-  // work out how big the file is
-  while(fscanf(inputfile, "%d %lf", &bin, &value) != EOF) {
-    size++;
+  if (block->valuecount + size > block->valuecapacity) {
+    block->valuecapacity = (block->valuecapacity == 0) ? (long)SCORE_BLOCK * size : 2*block->valuecapacity;
+    if (block->valuecapacity < block->valuecount + size) {
+      block->valuecapacity = block->valuecount + size;
+    }
+    block->values = (double*)realloc(block->values, sizeof(double) * block->valuecapacity);
+    assert(block->values != NULL);
   }
 
-  printf("\nFile is %d lines long.\n", size);
+  int slot = block->count;
+  block->offsets[slot] = block->valuecount;
+  block->sizes[slot] = size;
+  block->sources[slot] = source;
+  block->valuecount = block->valuecount + size;
+  block->count++;
+
+  return slot;
+}
+
+// scores profiles of the current block until there are none left
+static void* scoreWorker(void* arg) {
+
+  scoreBatch* batch = (scoreBatch*)arg;
+  profileBlock* block = batch->block;
 
-  // prepare for actual file read
-  rewind(inputfile);
+  // metrics may normalise profiles in place, so each one is given its own copy
+  int scratchsize = 0;
+  double* scratch = NULL;
 
-  // allocate sufficient memory
-  double* dataarray = (double*)malloc(sizeof(double) * size);
+  while (TRUE) {
 
-  // read data
-  i = 0;
-  while(fscanf(inputfile, "%d %lf", &bin, &value) != EOF) {
-    dataarray[i] = value;
-    i++;
+    pthread_mutex_lock(&batch->lock);
+    int job = batch->next;
+    batch->next++;
+    pthread_mutex_unlock(&batch->lock);
+
+    if (job >= block->count) {
+      break;
+    }
+
+    int size = block->sizes[job];
+    if (size > scratchsize) {
+      scratchsize = size;
+      scratch = (double*)realloc(scratch, sizeof(double) * scratchsize);
+      assert(scratch != NULL);
+    }
+
+    int m;
+    for (m = 0; m < batch->nmetrics; m++) {
+      memcpy(scratch, &block->values[block->offsets[job]], sizeof(double) * size);
+      block->scores[job * batch->nmetrics + m] = batch->metrics[m](scratch, 0, size);
+    }
   }
 
-  // close input file
-  fclose(inputfile);
-  printf("\n*** FILE READ COMPLETE ***\n\n");
+  free(scratch);
 
-  printf("Now applying Algorithm %d to profile...\n", metric_choice);
+  return NULL;
+}
 
-  double score = metric(dataarray, 0, size);
+void scoreBlock(scoreBatch* batch, int threads) {
 
-  // report score to command line
-  printf("SCORE: %.10f\n", score);
+  assert(batch != NULL);
+  assert(threads > 0);
 
-  // cleanup
-  free(dataarray);
-  printf("\nMetric Tester complete.\n"); 
+  int ii;
+  batch->next = 0;
 
-  return 0;
-  
+  if (threads == 1) {
+    scoreWorker(batch);
+  } else {
+    pthread_t workers[threads];
+    for (ii = 0; ii < threads; ii++) {
+      int error = pthread_create(&workers[ii], NULL, scoreWorker, batch);
+      assert(error == 0);
+    }
+    for (ii = 0; ii < threads; ii++) {
+      pthread_join(workers[ii], NULL);
+    }
+  }
+
+  return;
+}
+
+void writeBlock(FILE* outputfile, profileBlock* block, char** names, int nmetrics) {
+
+  assert(outputfile != NULL);
+  assert(block != NULL);
+
+  int ii, m;
+  for (ii = 0; ii < block->count; ii++) {
+    if (block->banked[ii] == TRUE) {
+      profileRecord* record = &block->records[ii];
+      fprintf(outputfile, "%s %ld %.6f %.6f %.6f %.6f", names[block->sources[ii]], (long)record->index, record->width, record->height, record->scatter, record->sigma);
+    } else {
+      // text profiles carry no generation parameters
+      fprintf(outputfile, "%s 0 nan nan nan nan", names[block->sources[ii]]);
+    }
+    for (m = 0; m < nmetrics; m++) {
+      fprintf(outputfile, " %.10f", block->scores[ii * nmetrics + m]);
+    }
+    fprintf(outputfile, "\n");
+  }
+
+  block->count = 0;
+  block->valuecount = 0;
+
+  return;
 }
 
 void metrictester_help() {
 
-  printf("\nMetric Tester - a program to evaluate algorithm (metric) performance on individual PROGENY profiles.\n");
-  printf("Version 1.1, last updated 11/09/2015.\n");
+  printf("\nMetric Tester - a program to evaluate algorithm (metric) performance on PROGENY profiles.\n");
+  printf("Version 1.2, last updated 19/10/2026.\n");
   printf("Written by Andrew Cameron, MPIFR IMPRS PhD Student.\n");
   printf("\n*****\n\n");
   printf("Input options:\n");
 
   printf("\n----- External Dataset Input ----- \n");
-  printf("-i [file]      Name of the PROGENY input profile.\n");
+  printf("-i [file]      Name of a PROGENY text profile or profile bank (progeny -bank). May be given any number of times.\n");
+  printf("-dir [dir]     Evaluates every file in a directory (text profiles and/or profile banks).\n");
+
+  printf("\n----- Output -----\n");
+  printf("-o [file]      Name of the score table, one row per profile: Source | Index | Width | Height | Scatter | Sigma | one score per algorithm.\n");
+  printf("               Index and generation parameters come from profile banks (text profiles show 0 and nan). Without -o the table goes to\n");
+  printf("               stdout, unless a single text profile is evaluated with a single algorithm, in which case only its score is reported.\n");
+  printf("-threads [int] Number of threads used to evaluate profiles (default = 1).\n");
 
   printf("\n----- Algorithm Selection -----\n");
-  printf("-a [int]       Algorithm choice for profile evaluation:\n\n");
+  printf("-a [int]       Algorithm choice for profile evaluation. Several may be chosen as a comma separated list (e.g. -a 1,2,5) or by repeating -a:\n\n");
   printf("               -* PRIMARY ALGORITHMS *-\n");
   printf("               1 = Boxcar matched-filter with Median Absolute Deviation (MAD) normalisation.\n");
   printf("               2 = Boxcar matched-filter with off-pulse window normalisation. Based on work by Kondratiev et al. 2009 ApJ.\n\n");
@@ -168,16 +583,3 @@ void metrictester_help() {
   return;
 
 }
-
-
-
-
-
-
-
-
-
-
-
-
-
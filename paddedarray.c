@@ -1,12 +1,16 @@
 // C file for the paddedArray data type
 // Andrew Cameron, MPIFR, 30/01/2015
-// Last modified 06/08/2015
+// Last modified 19/10/2026
+
+// Changelog
+// 19/10/2026 - The data array is now allocated through hugeAlloc(), so it is 64-byte aligned and can be backed by huge pages
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include "ffadata.h"
 #include "paddedarray.h"
+#include "hugealloc.h"
 
 // Allocates the memory for a padded array struct and returns a pointer. Internal values are uninitialised.
 paddedArray* createPaddedArray(int datasize, int fullsize) {
@@ -14,7 +18,8 @@ paddedArray* createPaddedArray(int datasize, int fullsize) {
   paddedArray* x = (paddedArray*)malloc(sizeof(paddedArray));
   assert(x != NULL);
 
-  x->dataarray = (ffadata*)malloc(sizeof(ffadata)*fullsize);
+  // pages are not touched here - whoever fills the array first decides its NUMA placement
+  x->dataarray = (ffadata*)hugeAlloc(sizeof(ffadata)*fullsize);
   assert(x->dataarray != NULL);
 
   x->datasize = datasize;
@@ -33,7 +38,7 @@ void deletePaddedArray(paddedArray* x) {
   assert(x != NULL);
 
   // delete memory-allocated contents
-  free(x->dataarray);
+  hugeFree(x->dataarray);
 
   // delete struct itself
   free(x);
@@ -1,10 +1,11 @@
 // Header for the paddedArray data type
 // Andrew Cameron, MPIFR, 30/01/2015
-// Last modified 06/08/2015
+// Last modified 19/10/2026
 
 // Changelog
 // 20/03/2015 - Added scalefactor as a part of the struct to make handling downsampling easier
 // 06/08/2015 - Also added de-reddening parameters inside the struct for ease of implementation
+// 19/10/2026 - dataarray is allocated with hugeAlloc() (see hugealloc.h) - it must not be released with free()
 
 #include <stdio.h>
 #include <stdlib.h>
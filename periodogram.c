@@ -0,0 +1,101 @@
+// C file for reading and writing FFA periodograms
+// Andrew Cameron, MPIFR, 19/10/2026
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include "periodogram.h"
+
+void writePeriodogramHeader(FILE* outputfile, int format) {
+
+  assert(outputfile != NULL);
+
+  if (format == PERIODOGRAM_BINARY) {
+    fwrite(PERIODOGRAM_MAGIC, 1, PERIODOGRAM_MAGIC_SIZE, outputfile);
+  } else {
+    fprintf(outputfile, "# Period (original samples) | Downsample factor | Period (downsampled samples) | Metric\n");
+  }
+
+  return;
+}
+
+void writePeriodogramRow(FILE* outputfile, int format, periodogramRow* row) {
+
+  assert(outputfile != NULL);
+  assert(row != NULL);
+
+  if (format == PERIODOGRAM_BINARY) {
+    int32_t scalefactor = row->scalefactor;
+    fwrite(&row->period, sizeof(double), 1, outputfile);
+    fwrite(&scalefactor, sizeof(int32_t), 1, outputfile);
+    fwrite(&row->dsperiod, sizeof(double), 1, outputfile);
+    fwrite(&row->metric, sizeof(double), 1, outputfile);
+  } else {
+    fprintf(outputfile, "%.10f %d %.10f %.10f\n", row->period, row->scalefactor, row->dsperiod, row->metric);
+  }
+
+  return;
+}
+
+int readPeriodogramHeader(FILE* inputfile) {
+
+  assert(inputfile != NULL);
+
+  int c = fgetc(inputfile);
+
+  if (c == PERIODOGRAM_MAGIC[0]) {
+    // should be a binary file - check the rest of the magic string
+    char magic[PERIODOGRAM_MAGIC_SIZE];
+    magic[0] = (char)c;
+    if ((fread(&magic[1], 1, PERIODOGRAM_MAGIC_SIZE - 1, inputfile) != PERIODOGRAM_MAGIC_SIZE - 1) || (memcmp(magic, PERIODOGRAM_MAGIC, PERIODOGRAM_MAGIC_SIZE) != 0)) {
+      printf("ERROR: Unrecognised periodogram format.\n");
+      exit(EXIT_FAILURE);
+    }
+    return PERIODOGRAM_BINARY;
+  } else if (c == '#') {
+    // text header line - skip the rest of it
+    while ((c != '\n') && (c != EOF)) {
+      c = fgetc(inputfile);
+    }
+  } else if (c != EOF) {
+    // headerless text file
+    ungetc(c, inputfile);
+  }
+
+  return PERIODOGRAM_TEXT;
+}
+
+int readPeriodogramRow(FILE* inputfile, int format, periodogramRow* row) {
+
+  assert(inputfile != NULL);
+  assert(row != NULL);
+
+  if (format == PERIODOGRAM_BINARY) {
+    // the whole row is read at once, so that a row cut short can be told apart from the end of the file
+    unsigned char record[PERIODOGRAM_ROW_SIZE];
+    size_t got = fread(record, 1, PERIODOGRAM_ROW_SIZE, inputfile);
+    if (got == 0) {
+      return FALSE;
+    } else if (got < PERIODOGRAM_ROW_SIZE) {
+      return PERIODOGRAM_BAD_ROW;
+    }
+    int32_t scalefactor;
+    memcpy(&row->period, &record[0], sizeof(double));
+    memcpy(&scalefactor, &record[sizeof(double)], sizeof(int32_t));
+    memcpy(&row->dsperiod, &record[sizeof(double) + sizeof(int32_t)], sizeof(double));
+    memcpy(&row->metric, &record[2*sizeof(double) + sizeof(int32_t)], sizeof(double));
+    row->scalefactor = scalefactor;
+  } else {
+    // fscanf only returns EOF when the file ends before the row starts
+    int fields = fscanf(inputfile, "%lf %d %lf %lf", &row->period, &row->scalefactor, &row->dsperiod, &row->metric);
+    if (fields == EOF) {
+      return FALSE;
+    } else if (fields != 4) {
+      return PERIODOGRAM_BAD_ROW;
+    }
+  }
+
+  return TRUE;
+}
@@ -0,0 +1,55 @@
+// Header for reading and writing FFA periodograms
+// Andrew Cameron, MPIFR, 19/10/2026
+
+// A periodogram is a header followed by one row per trial period, in one of two formats
+// PERIODOGRAM_TEXT - the original ASCII format: a '#' comment line, then "%.10f %d %.10f %.10f" rows of
+//                    Period (original samples) | Downsample factor | Period (downsampled samples) | Metric
+// PERIODOGRAM_BINARY - the 8 byte PERIODOGRAM_MAGIC string, then rows of period (double), scalefactor (int32), dsperiod (double), metric (double),
+//                      packed with no padding (28 bytes per row) in the native byte order of the machine that wrote them
+// Binary rows keep full double precision, so they are not rounded the way the text rows are
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef PERIODOGRAM_H
+#define PERIODOGRAM_H
+
+#define TRUE 1
+#define FALSE 0
+
+#define PERIODOGRAM_TEXT 0
+#define PERIODOGRAM_BINARY 1
+
+#define PERIODOGRAM_MAGIC "FFAPRDG1"
+#define PERIODOGRAM_MAGIC_SIZE 8
+#define PERIODOGRAM_ROW_SIZE 28
+
+// returned by readPeriodogramRow() for a row that cannot be read
+#define PERIODOGRAM_BAD_ROW -1
+
+// ***** DATA TYPES *****
+
+typedef struct periodogramRow {
+  double period;    // in original samples
+  int scalefactor;  // downsampling factor
+  double dsperiod;  // in downsampled samples
+  double metric;
+} periodogramRow;
+
+// ***** FUNCTION PROTOTYPES *****
+
+// writes the header that starts every periodogram of the given format
+void writePeriodogramHeader(FILE* outputfile, int format);
+
+// writes out a single periodogram row
+void writePeriodogramRow(FILE* outputfile, int format, periodogramRow* row);
+
+// reads a periodogram header and returns the format of the file
+// text periodograms without a header line are also accepted - only the first character is consumed to check for one
+int readPeriodogramHeader(FILE* inputfile);
+
+// reads the next row of a periodogram into row - returns TRUE for a row, FALSE once the end of the file has been reached,
+// or PERIODOGRAM_BAD_ROW if the next row cannot be read (text that is not a row, or a row cut short by the end of the file)
+int readPeriodogramRow(FILE* inputfile, int format, periodogramRow* row);
+
+#endif /* PERIODOGRAM_H */
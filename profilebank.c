@@ -0,0 +1,90 @@
+// C file for reading and writing profile banks
+// Andrew Cameron, MPIFR, 19/10/2026
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include "profilebank.h"
+
+void writeProfileBankHeader(FILE* outputfile, int nbins) {
+
+  assert(outputfile != NULL);
+  assert(nbins > 0);
+
+  int32_t bins = nbins;
+  fwrite(PROFILEBANK_MAGIC, 1, PROFILEBANK_MAGIC_SIZE, outputfile);
+  fwrite(&bins, sizeof(int32_t), 1, outputfile);
+
+  return;
+}
+
+void writeProfileRecord(FILE* outputfile, profileRecord* record, double* profile, int nbins) {
+
+  assert(outputfile != NULL);
+  assert(record != NULL);
+  assert(profile != NULL);
+
+  int32_t shape = record->shape;
+  int32_t center = record->center;
+  fwrite(&record->index, sizeof(int64_t), 1, outputfile);
+  fwrite(&shape, sizeof(int32_t), 1, outputfile);
+  fwrite(&center, sizeof(int32_t), 1, outputfile);
+  fwrite(&record->width, sizeof(double), 1, outputfile);
+  fwrite(&record->height, sizeof(double), 1, outputfile);
+  fwrite(&record->scatter, sizeof(double), 1, outputfile);
+  fwrite(&record->sigma, sizeof(double), 1, outputfile);
+  fwrite(&record->baseline, sizeof(double), 1, outputfile);
+  fwrite(profile, sizeof(double), nbins, outputfile);
+
+  return;
+}
+
+int readProfileBankHeader(FILE* inputfile, int* nbins) {
+
+  assert(inputfile != NULL);
+  assert(nbins != NULL);
+
+  int c = fgetc(inputfile);
+
+  if (c != PROFILEBANK_MAGIC[0]) {
+    // not a profile bank (text profiles start with a bin number)
+    if (c != EOF) {
+      ungetc(c, inputfile);
+    }
+    return FALSE;
+  }
+
+  char magic[PROFILEBANK_MAGIC_SIZE];
+  int32_t bins;
+  magic[0] = (char)c;
+  if ((fread(&magic[1], 1, PROFILEBANK_MAGIC_SIZE - 1, inputfile) != PROFILEBANK_MAGIC_SIZE - 1) || (memcmp(magic, PROFILEBANK_MAGIC, PROFILEBANK_MAGIC_SIZE) != 0) ||
+      (fread(&bins, sizeof(int32_t), 1, inputfile) != 1) || (bins <= 0)) {
+    printf("ERROR: Unrecognised profile bank format.\n");
+    exit(EXIT_FAILURE);
+  }
+  *nbins = bins;
+
+  return TRUE;
+}
+
+int readProfileRecord(FILE* inputfile, profileRecord* record, double* profile, int nbins) {
+
+  assert(inputfile != NULL);
+  assert(record != NULL);
+  assert(profile != NULL);
+
+  int32_t shape, center;
+  if ((fread(&record->index, sizeof(int64_t), 1, inputfile) != 1) || (fread(&shape, sizeof(int32_t), 1, inputfile) != 1) ||
+      (fread(&center, sizeof(int32_t), 1, inputfile) != 1) || (fread(&record->width, sizeof(double), 1, inputfile) != 1) ||
+      (fread(&record->height, sizeof(double), 1, inputfile) != 1) || (fread(&record->scatter, sizeof(double), 1, inputfile) != 1) ||
+      (fread(&record->sigma, sizeof(double), 1, inputfile) != 1) || (fread(&record->baseline, sizeof(double), 1, inputfile) != 1) ||
+      (fread(profile, sizeof(double), nbins, inputfile) != (size_t)nbins)) {
+    return FALSE;
+  }
+  record->shape = shape;
+  record->center = center;
+
+  return TRUE;
+}
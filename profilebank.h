@@ -0,0 +1,53 @@
+// Header for reading and writing profile banks - many PROGENY profiles stored in a single binary file
+// Andrew Cameron, MPIFR, 19/10/2026
+
+// A profile bank is the 8 byte PROFILEBANK_MAGIC string and the number of bins per profile (int32), followed by one record per profile:
+// index (int64), shape (int32), center (int32), width, height, scatter, sigma, baseline (doubles), then the nbins profile values (doubles)
+// Records are packed with no padding (PROFILEBANK_RECORD_SIZE + 8*nbins bytes each) in the native byte order of the machine that wrote them
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifndef PROFILEBANK_H
+#define PROFILEBANK_H
+
+#define TRUE 1
+#define FALSE 0
+
+#define PROFILEBANK_MAGIC "FFAPROF1"
+#define PROFILEBANK_MAGIC_SIZE 8
+
+// bytes of each record before the profile values
+#define PROFILEBANK_RECORD_SIZE 56
+
+// ***** DATA TYPES *****
+
+// the parameters a profile was generated with
+typedef struct profileRecord {
+  int64_t index; // position of the profile in the grid / random sequence it came from
+  int shape;
+  int center;
+  double width; // in bins
+  double height;
+  double scatter; // in samples
+  double sigma; // 0 if no noise was added
+  double baseline;
+} profileRecord;
+
+// ***** FUNCTION PROTOTYPES *****
+
+// writes the header that starts every profile bank
+void writeProfileBankHeader(FILE* outputfile, int nbins);
+
+// writes out a single profile and its parameters
+void writeProfileRecord(FILE* outputfile, profileRecord* record, double* profile, int nbins);
+
+// checks for a profile bank header - returns TRUE and sets nbins if one is found, otherwise returns FALSE with the file position unchanged
+// (so that text profiles can be read from the same file)
+int readProfileBankHeader(FILE* inputfile, int* nbins);
+
+// reads the next record of a profile bank into record and profile (nbins elements) - returns FALSE once the end of the file has been reached
+int readProfileRecord(FILE* inputfile, profileRecord* record, double* profile, int nbins);
+
+#endif /* PROFILEBANK_H */
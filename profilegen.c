@@ -0,0 +1,190 @@
+// C file for building artificial pulse profiles
+// Andrew Cameron, MPIFR, 19/10/2026
+// Pulse shape, scattering and folding functions moved here from progeny.c so that profiles can be built in bulk
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "profilegen.h"
+
+void pulseshape_tophat(double *profile, int size, double width, double height, int center) {
+
+  // check validity
+  assert(profile != NULL);
+  assert(size > 0);
+  assert(width > 0);
+
+  int i;
+  int sub_size = size/SIZE_FACTOR;
+
+  // determine pulse start and end positions
+  int pulsestart = center - (int)floor(width/((double)2));
+  int pulseend = pulsestart + (int)ceil(width);
+
+  for (i = pulsestart + SIZE_OFFSET*sub_size; i < pulseend + SIZE_OFFSET*sub_size; i++) {
+    profile[i] = profile[i] + height;
+  }
+  
+  return;
+}
+
+void pulseshape_gaussian(double *profile, int size, double width, double height, int center) {
+
+  // check validity
+  assert(profile != NULL);
+  assert(size > 0);
+  assert(width > 0);
+
+  int i;
+  int sub_size = size/SIZE_FACTOR;
+
+  // convert the FWHM width to the RMS width to use in the code
+  double RMSwidth = width/(2*sqrt(2*log(2)));
+
+  // only bins within GAUSSIAN_EXTENT RMS widths of the center are evaluated - exp() underflows to exactly zero beyond that
+  int first = (int)floor(sub_size*SIZE_OFFSET + center - GAUSSIAN_EXTENT*RMSwidth);
+  int last = (int)ceil(sub_size*SIZE_OFFSET + center + GAUSSIAN_EXTENT*RMSwidth);
+  if (first < 0) {
+    first = 0;
+  }
+  if (last > size - 1) {
+    last = size - 1;
+  }
+
+  // scroll through profile and add Gaussian component to the middle section of the profile
+  for (i = first; i <= last; i++) {
+    double offset = (i-sub_size*SIZE_OFFSET)-center;
+    profile[i] = profile[i] + height*exp(-(offset*offset)/(2*RMSwidth*RMSwidth));
+  }
+
+  return;
+}
+
+void convolve_exponential(double *profile, int size, double scatter_time, double *work) {
+
+  // check for valid input
+  assert(profile != NULL);
+  assert(size > 0);
+  assert(scatter_time >= 0);
+
+  // variable setup
+  int i;
+  int sub_size = size/SIZE_FACTOR;
+
+  // only proceed if scattering is actually needed
+  if (scatter_time > 0) {
+    
+    // integrate source profile for initial area - needed later for normalisation
+    double initial_profile_area = 0;
+    for (i = 0; i < size; i++) {
+      initial_profile_area = initial_profile_area + profile[i];
+    }
+
+    // the scattering kernel is exp(-t/scatter_time) for t = 0 to tail_size - 1, delayed by delay bins, and wraps around the profile
+    // the delayed convolution is therefore running[(n - delay) % size], where running[n] is the sum over k < tail_size of decay^k * profile[n - k]
+    // running obeys the first order recursion running[n] = profile[n] + decay * running[n - 1] - decay^tail_size * profile[n - tail_size]
+    // (the last term drops the sample that has just fallen off the end of the kernel), so the whole convolution is O(size)
+    int delay = SIZE_OFFSET*sub_size;
+    int tail_size = size - delay;
+    double decay = exp(-1/scatter_time);
+    double tail_decay = pow(decay, tail_size);
+
+    double* running = (work != NULL) ? work : (double*)malloc(sizeof(double) * size);
+
+    // first value summed directly, wrapping round the end of the profile
+    double weight = 1;
+    running[0] = 0;
+    for (i = 0; i < tail_size; i++) {
+      running[0] = running[0] + weight * profile[(size - i) % size];
+      weight = weight * decay;
+    }
+
+    for (i = 1; i < size; i++) {
+      running[i] = profile[i] + decay * running[i - 1] - tail_decay * profile[(i - tail_size + size) % size];
+    }
+
+    // then calculate area under convolved curve using rectangular approximation
+    double area_convolved = 0;
+    for (i = 0; i < size; i++) {
+      area_convolved = area_convolved + running[i];
+    }
+
+    // determine correction factor
+    double norm_factor = initial_profile_area / area_convolved; 
+
+    // and apply normalisation while copying the delayed result into the original profile
+    for (i = 0; i < size; i++) {
+      profile[i] = running[(i - delay + size) % size] * norm_factor;
+    }
+
+    // cleanup
+    if (work == NULL) {
+      free(running);
+    }
+  }
+
+  return;
+}
+
+void fold_profile(double *input_profile, double *output_profile, int input_size, int output_size) {
+
+  // check for valid input
+  assert(input_profile != NULL);
+  assert(output_profile != NULL);
+  assert(input_size > 0);
+  assert(output_size > 0);
+
+  // initialise output profile
+  int i;
+
+  for (i = 0; i < output_size; i++) {
+    output_profile[i] = 0;
+  }
+
+  // fold input profile
+
+  for (i = 0; i < input_size; i++) {
+    output_profile[i % output_size] = output_profile[i % output_size] + input_profile[i];
+  }
+
+  return;
+}
+
+void buildProfile(double *profile, int nbins, pulseComponent *components, int ncomponents, double scatter_time, double *work) {
+
+  // check for valid input
+  assert(profile != NULL);
+  assert(nbins > 0);
+  assert(components != NULL || ncomponents == 0);
+  assert(work != NULL);
+
+  int i;
+  int size = SIZE_FACTOR * nbins;
+  double* long_profile = work;
+
+  for (i = 0; i < size; i++) {
+    long_profile[i] = 0;
+  }
+
+  for (i = 0; i < ncomponents; i++) {
+    if (components[i].shape == TOP_HAT) {
+      pulseshape_tophat(long_profile, size, components[i].width, components[i].height, components[i].center);
+    } else {
+      assert(components[i].shape == GAUSSIAN);
+      pulseshape_gaussian(long_profile, size, components[i].width, components[i].height, components[i].center);
+    }
+  }
+
+  // apply scattering tail, using the second half of the workspace
+  convolve_exponential(long_profile, size, scatter_time, work + size);
+
+  fold_profile(long_profile, profile, size, nbins);
+
+  return;
+}
+
+long profileWorkSize(int nbins) {
+
+  return 2 * (long)SIZE_FACTOR * nbins;
+}
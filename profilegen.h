@@ -0,0 +1,54 @@
+// Header for building artificial pulse profiles (as used by PROGENY)
+// Andrew Cameron, MPIFR, 19/10/2026
+
+// Profiles are built SIZE_FACTOR times longer than needed, with the pulse placed in the segment starting at SIZE_OFFSET*nbins,
+// so that scattering tails and wide components can spread out before the long profile is folded back down to nbins
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef PROFILEGEN_H
+#define PROFILEGEN_H
+
+#define TOP_HAT 1
+#define GAUSSIAN 2
+
+#define SIZE_FACTOR 5
+#define SIZE_OFFSET 2
+
+// RMS widths either side of a Gaussian beyond which exp(-x^2/2) is exactly zero in double precision
+#define GAUSSIAN_EXTENT 39
+
+// ***** DATA TYPES *****
+
+// a single pulse component
+typedef struct pulseComponent {
+  int shape; // TOP_HAT or GAUSSIAN
+  double height;
+  double width; // in bins - FWHM for Gaussian components
+  int center; // bin position of the center of the pulse
+} pulseComponent;
+
+// ***** FUNCTION PROTOTYPES *****
+
+// adds a top hat function to a profile
+void pulseshape_tophat(double *profile, int size, double width, double height, int center);
+
+// adds a gaussian function to a profile
+void pulseshape_gaussian(double *profile, int size, double width, double height, int center);
+
+// convolves a scattering exponential with a provided profile
+// work must hold size elements (or be NULL, in which case it is allocated and freed internally)
+void convolve_exponential(double *profile, int size, double scatter_time, double *work);
+
+// folds a longer profile back to the expected size
+void fold_profile(double *input_profile, double *output_profile, int input_size, int output_size);
+
+// builds a noiseless nbins long profile from a set of components, scattered by scatter_time samples (0 for none)
+// work must hold profileWorkSize(nbins) elements, so that many profiles can be built without allocation
+void buildProfile(double *profile, int nbins, pulseComponent *components, int ncomponents, double scatter_time, double *work);
+
+// returns the number of elements of scratch space buildProfile() needs for nbins bins
+long profileWorkSize(int nbins);
+
+#endif /* PROFILEGEN_H */
@@ -4,23 +4,24 @@
 #include <time.h>
 #include <math.h>
 #include <assert.h>
+#include <stdint.h>
+#include <pthread.h>
 
 // User defined libraries
 #include "equalstrings.h"
 #include "whitenoise.h"
+#include "profilegen.h"
+#include "profilebank.h"
 
 #define TRUE 1
 #define FALSE 0
 
-#define TOP_HAT 1
-#define GAUSSIAN 2
-
-#define SIZE_FACTOR 5
-#define SIZE_OFFSET 2
+// profiles generated in memory between writes to a profile bank
+#define BATCH_BLOCK 4096
 
 // PROGENY - Program to build custom profiles for metric / normalisation standardised testing
 // Written by Andrew Cameron
-// Version 1.4.2 - Last updated 19/09/2015
+// Version 1.6.2 - Last updated 19/10/2026
 
 /*
 
@@ -38,24 +39,60 @@ CHANGELOG:
            - V1.4.0 - Rewrote pulse seeded algorithm to allow for scattering of any pulse shape combination
 11/09/2016 - v1.4.1 - Rewrote help menu to update for publication
 19/09/2016 - v1.4.2 - Modified noise generation code to reflect changes in whitenoise.c/h
+19/10/2026 - v1.5.0 - Scattering convolution now runs as a first order recursion with a wrap correction (O(n) rather than O(n^2))
+                    - Gaussian components are only evaluated where they are non-zero
+19/10/2026 - v1.6.0 - Added batch mode (-bank), generating a grid (-dcgrid, -heightgrid, -scattergrid) or random sample (-random) of profiles across threads
+                      into a single binary profile bank (see profilebank.h)
+                    - Pulse shape, scattering and folding functions moved to profilegen.c/h
+                    - Added -seed for repeatable noise
+19/10/2026 - v1.6.1 - Batch profiles now take consecutive streams split off one stream seeded with -seed, so banks made with neighbouring seeds no longer share noise
+19/10/2026 - v1.6.2 - A -dcgrid, -heightgrid or -scattergrid with 0 steps is rejected, rather than replaced by the single -dc, -height or -scatter value
 */
 
+// ***** DATA TYPES *****
+
+// one parameter of a batch - a single value, or a range covered by steps grid points (or sampled uniformly in random mode)
+typedef struct batchAxis {
+  double low;
+  double high;
+  int steps;
+} batchAxis;
+
+// everything the batch workers share
+typedef struct progenyBatch {
+  int nbins;
+  int shape;
+  int center;
+  int whitenoise_flag;
+  double sigma;
+  double base;
+  batchAxis dc; // duty cycle (percent)
+  batchAxis height;
+  batchAxis scatter;
+  int random_flag;
+  noiseStream streams; // parent stream, seeded once - each profile takes the next stream split off it
+  long total;
+  long blockstart; // index of the first profile of the current block
+  long blocksize;
+  long next; // next job within the block
+  double* profiles;
+  profileRecord* records;
+  pthread_mutex_t lock;
+} progenyBatch;
+
 // ***** FUNCTION PROTOTYPES *****
 
 // prints out an explanation of how to use the command line interface
 void progeny_help();
 
-// adds a top hat function to a profile
-void pulseshape_tophat(double *profile, int size, double width, double height, int center);
-
-// adds a gaussian function to a profile
-void pulseshape_gaussian(double *profile, int size, double width, double height, int center);
+// adds a pulse component to the end of a growing list, and returns the new component count
+int add_component(pulseComponent** components, int* capacity, int ncomponents, int shape, double height, double width, int center);
 
-// convolves a scattering exponential with a provided profile
-void convolve_exponential(double *profile, int size, double scatter_time);
+// returns the value of an axis at grid point step, or a uniform draw over its range in random mode
+double axis_value(batchAxis* axis, int step, int random_flag, noiseStream* stream);
 
-// folds a longer profile back to the expected size
-void fold_profile(double *input_profile, double *output_profile, int input_size, int output_size);
+// generates the profiles of a batch in blocks across threads, writing them to a profile bank
+void run_batch(progenyBatch* batch, FILE* outputfile, int threads);
 
 // ***** MAIN FUNCTION *****
 
@@ -74,13 +111,22 @@ int main(int argc, char** argv) {
   double dc = 0;
   FILE *inputfile = NULL;
   FILE *outputfile = NULL;
+  FILE *bankfile = NULL;
   double scatter_time = 0;
+  batchAxis dcgrid = {0, 0, 0};
+  batchAxis heightgrid = {0, 0, 0};
+  batchAxis scattergrid = {0, 0, 0};
+  int dcgrid_flag = FALSE;
+  int heightgrid_flag = FALSE;
+  int scattergrid_flag = FALSE;
+  long random_count = 0;
+  int threads = 1;
+  int seed_flag = FALSE;
+  uint64_t seed = 0;
 
   int format = 1;
 
   int i; // counter
-  // start the random number generator
-  startseed();
 
   // check that a valid number of arguments have been passed
   if (argc < 2) {
@@ -134,6 +180,36 @@ int main(int argc, char** argv) {
       } else if (equal_strings(argv[i], "-scatter")) {
 	i++;
 	scatter_time = atof(argv[i]);
+      } else if (equal_strings(argv[i], "-bank")) {
+	i++;
+	bankfile = fopen(argv[i], "wb");
+      } else if (equal_strings(argv[i], "-dcgrid") || equal_strings(argv[i], "-heightgrid") || equal_strings(argv[i], "-scattergrid")) {
+	batchAxis* axis = equal_strings(argv[i], "-dcgrid") ? &dcgrid : (equal_strings(argv[i], "-heightgrid") ? &heightgrid : &scattergrid);
+	if (i + 3 >= argc) {
+	  printf("%s needs a low value, a high value and a number of steps.\n", argv[i]);
+	  exit(0);
+	}
+	axis->low = atof(argv[i + 1]);
+	axis->high = atof(argv[i + 2]);
+	axis->steps = atoi(argv[i + 3]);
+	if (axis == &dcgrid) {
+	  dcgrid_flag = TRUE;
+	} else if (axis == &heightgrid) {
+	  heightgrid_flag = TRUE;
+	} else {
+	  scattergrid_flag = TRUE;
+	}
+	i = i + 3;
+      } else if (equal_strings(argv[i], "-random")) {
+	i++;
+	random_count = atol(argv[i]);
+      } else if (equal_strings(argv[i], "-threads")) {
+	i++;
+	threads = atoi(argv[i]);
+      } else if (equal_strings(argv[i], "-seed")) {
+	i++;
+	seed_flag = TRUE;
+	seed = strtoull(argv[i], NULL, 10);
       } else {
 	printf("Unknown argument (%s) passed to ffancy.\nUse -h / --help to display help menu with acceptable arguments.\n",argv[i]);
 	exit(0);
@@ -142,20 +218,86 @@ int main(int argc, char** argv) {
     }
   }
 
+  // start the random number generator
+  if (seed_flag == FALSE) {
+    seed = (uint64_t)time(NULL);
+  }
+  seedWhiteNoise(seed);
+
   // test for valid input
   assert(nbins > 0);
+  assert(sigma > 0);
+
+  if (bankfile != NULL) {
+
+    // batch mode - every axis without a grid option holds the single value given on the command line (a grid given with 0 steps is an error)
+    if (dcgrid_flag == FALSE) {
+      dcgrid.low = (dc_flag == TRUE) ? dc : 100 * pulsewidth / nbins;
+      dcgrid.high = dcgrid.low;
+      dcgrid.steps = 1;
+    }
+    if (heightgrid_flag == FALSE) {
+      heightgrid.low = pulseheight;
+      heightgrid.high = pulseheight;
+      heightgrid.steps = 1;
+    }
+    if (scattergrid_flag == FALSE) {
+      scattergrid.low = scatter_time;
+      scattergrid.high = scatter_time;
+      scattergrid.steps = 1;
+    }
+
+    if ((dcgrid.steps < 1) || (heightgrid.steps < 1) || (scattergrid.steps < 1) || (random_count < 0) || (threads < 1)) {
+      printf("Grid steps and thread counts must be at least 1!\n");
+      exit(0);
+    }
+    if ((fmin(dcgrid.low, dcgrid.high) <= 0) || (fmax(dcgrid.low, dcgrid.high) >= 100) || (fmin(heightgrid.low, heightgrid.high) < 0) || (fmin(scattergrid.low, scattergrid.high) < 0)) {
+      printf("Duty cycles must lie between 0 and 100 percent, and heights and scattering times cannot be negative!\n");
+      exit(0);
+    }
+    if ((pulseshape != TOP_HAT) && (pulseshape != GAUSSIAN)) {
+      printf("\nInvalid pulse shape chosen! Program aborting...\n");
+      exit(0);
+    }
+
+    progenyBatch batch;
+    batch.nbins = nbins;
+    batch.shape = pulseshape;
+    batch.center = ((pulsecenter % nbins) + nbins) % nbins;
+    batch.whitenoise_flag = whitenoise_flag;
+    batch.sigma = sigma;
+    batch.base = base;
+    batch.dc = dcgrid;
+    batch.height = heightgrid;
+    batch.scatter = scattergrid;
+    batch.random_flag = (random_count > 0) ? TRUE : FALSE;
+    seedNoiseStream(&batch.streams, seed);
+    batch.total = (random_count > 0) ? random_count : (long)dcgrid.steps * heightgrid.steps * scattergrid.steps;
+
+    printf("Generating %ld profiles with %d bins (%s) using %d thread(s)...\n", batch.total, nbins, (batch.random_flag == TRUE) ? "random sample" : "grid", threads);
+    run_batch(&batch, bankfile, threads);
+    fclose(bankfile);
+    if (outputfile != NULL) {
+      fclose(outputfile);
+    }
+    if (inputfile != NULL) {
+      fclose(inputfile);
+    }
+
+    printf("\nProfile generation complete.\n");
+
+    return 0;
+  }
+
   assert(outputfile != NULL);
   assert(format == 1 || format == 2);
 
   // now begin profile generation
-  // construct empty profile
+  // collect the pulse components - the profile itself is built once they are all known
 
-  printf("Creating empty profile with %d bins, baseline %.10f...\n", nbins, base);
-  double* profile = (double*)malloc(sizeof(double) * SIZE_FACTOR * nbins);
-  for (i = 0; i < SIZE_FACTOR * nbins; i++) {
-    profile[i] = 0;
-  }
-  printf("Empty profile created.\n");
+  pulseComponent* components = NULL;
+  int capacity = 0;
+  int ncomponents = 0;
 
   if (inputfile == NULL) {
     // create pulse based on command line
@@ -170,7 +312,6 @@ int main(int argc, char** argv) {
     assert(pulsewidth < nbins);
     assert(pulseheight >= 0);
     assert(pulsewidth > 0);
-    assert(sigma > 0);
     
     pulsecenter = pulsecenter % nbins;
     assert(pulsecenter >= 0 && pulsecenter < nbins);
@@ -179,14 +320,13 @@ int main(int argc, char** argv) {
 
     if (pulseshape == TOP_HAT) {
       printf("TOP HAT profile selected.\n");
-      pulseshape_tophat(profile, nbins * SIZE_FACTOR, pulsewidth, pulseheight, pulsecenter);
     } else if (pulseshape == GAUSSIAN) {
       printf("GAUSSIAN profile selected.\n");
-      pulseshape_gaussian(profile, nbins * SIZE_FACTOR, pulsewidth, pulseheight, pulsecenter);
     } else {
       printf("\nInvalid pulse shape chosen! Program aborting...\n");
       exit(0);
     }
+    ncomponents = add_component(&components, &capacity, ncomponents, pulseshape, pulseheight, pulsewidth, pulsecenter);
   } else {
     printf("Now creating pulse based on file input...\n");
     // scan the input file and process each profile in turn
@@ -208,21 +348,19 @@ int main(int argc, char** argv) {
       assert(pulsewidth < nbins);
       assert(pulseheight >= 0);
       assert(pulsewidth > 0);
-      assert(sigma > 0);
       pulsecenter = pulsecenter % nbins;
       assert(pulsecenter >= 0 && pulsecenter < nbins);
       printf("Profile %d parameters:\nNBINS = %d\nBASELINE = %.10f\nSIGMA = %.10f\nPULSE HEIGHT = %.10f\nPULSE WIDTH = %.10f bins\n\n", jj, nbins, base, sigma, pulseheight, pulsewidth);
       
       if (pulseshape == TOP_HAT) {
 	printf("TOP HAT profile selected.\n");
-	pulseshape_tophat(profile, nbins * SIZE_FACTOR, pulsewidth, pulseheight, pulsecenter);
       } else if (pulseshape == GAUSSIAN) {
 	printf("GAUSSIAN profile selected.\n");
-	pulseshape_gaussian(profile, nbins * SIZE_FACTOR, pulsewidth, pulseheight, pulsecenter);
       } else {
 	printf("\nInvalid pulse shape chosen! Program aborting...\n");
 	exit(0);
       }
+      ncomponents = add_component(&components, &capacity, ncomponents, pulseshape, pulseheight, pulsewidth, pulsecenter);
 
       jj++;
     }
@@ -232,13 +370,13 @@ int main(int argc, char** argv) {
 
   }
 
-  // apply scattering tail
-  convolve_exponential(profile, nbins * SIZE_FACTOR, scatter_time);
-
-  // fold profile
+  // build the profile, with any scattering tail, folded back down to nbins
+  double* work = (double*)malloc(sizeof(double) * profileWorkSize(nbins));
   double* folded_profile = (double*)malloc(sizeof(double) * nbins);
-  fold_profile(profile, folded_profile, nbins * SIZE_FACTOR, nbins);
-  free(profile);
+  assert(work != NULL && folded_profile != NULL);
+  buildProfile(folded_profile, nbins, components, ncomponents, scatter_time, work);
+  free(work);
+  free(components);
 
   // add whitenoise and baseline
   printf("Adding whitenoise and baseline...\n");
@@ -278,137 +416,163 @@ int main(int argc, char** argv) {
 
 // FUNCTION AREA
 
-void pulseshape_tophat(double *profile, int size, double width, double height, int center) {
+int add_component(pulseComponent** components, int* capacity, int ncomponents, int shape, double height, double width, int center) {
 
-  // check validity
-  assert(profile != NULL);
-  assert(size > 0);
-  assert(width > 0);
+  assert(components != NULL);
+  assert(capacity != NULL);
 
-  int i;
-  int sub_size = size/SIZE_FACTOR;
-
-  // determine pulse start and end positions
-  int pulsestart = center - (int)floor(width/((double)2));
-  int pulseend = pulsestart + (int)ceil(width);
-
-  for (i = pulsestart + SIZE_OFFSET*sub_size; i < pulseend + SIZE_OFFSET*sub_size; i++) {
-    profile[i] = profile[i] + height;
+  if (ncomponents == *capacity) {
+    *capacity = (*capacity == 0) ? 8 : 2*(*capacity);
+    *components = (pulseComponent*)realloc(*components, sizeof(pulseComponent)*(*capacity));
+    assert(*components != NULL);
   }
-  
-  return;
-}
 
-void pulseshape_gaussian(double *profile, int size, double width, double height, int center) {
+  (*components)[ncomponents].shape = shape;
+  (*components)[ncomponents].height = height;
+  (*components)[ncomponents].width = width;
+  (*components)[ncomponents].center = center;
 
-  // check validity
-  assert(profile != NULL);
-  assert(size > 0);
-  assert(width > 0);
+  return ncomponents + 1;
+}
 
-  int i;
-  int sub_size = size/SIZE_FACTOR;
+double axis_value(batchAxis* axis, int step, int random_flag, noiseStream* stream) {
 
-  // convert the FWHM width to the RMS width to use in the code
-  double RMSwidth = width/(2*sqrt(2*log(2)));
+  assert(axis != NULL);
 
-  // scroll through profile and add Gaussian component to the middle section of the profile
-  for (i = 0; i < size; i++) {
-    profile[i] = profile[i] + height*exp(-pow(((i-sub_size*SIZE_OFFSET)-center), 2)/(2*RMSwidth*RMSwidth));
+  if (random_flag == TRUE) {
+    return axis->low + (axis->high - axis->low) * noiseUniform(stream);
+  } else if (axis->steps == 1) {
+    return axis->low;
   }
 
-  return;
+  return axis->low + (axis->high - axis->low) * step / (axis->steps - 1);
 }
 
-void convolve_exponential(double *profile, int size, double scatter_time) {
+// builds profiles of the current block until there are none left
+static void* batch_worker(void* arg) {
 
-  // check for valid input
-  assert(profile != NULL);
-  assert(size > 0);
-  assert(scatter_time >= 0);
+  progenyBatch* batch = (progenyBatch*)arg;
+  int nbins = batch->nbins;
+  double* work = (double*)malloc(sizeof(double) * profileWorkSize(nbins));
+  assert(work != NULL);
 
-  // variable setup
-  int i;
-  int n;
-  int m;
-  int sub_size = size/SIZE_FACTOR;
+  while (TRUE) {
 
-  // only proceed if scattering is actually needed
-  if (scatter_time > 0) {
-    
-    // integrate source profile for initial area - needed later for normalisation
-    double initial_profile_area = 0;
-    for (i = 0; i < size; i++) {
-      initial_profile_area = initial_profile_area + profile[i];
+    // every profile has its own stream, split off the parent in profile order, so the bank is the same whatever the number of threads
+    // and the streams of different profiles (and of banks made with different seeds) never overlap
+    noiseStream stream;
+    pthread_mutex_lock(&batch->lock);
+    long job = batch->next;
+    batch->next++;
+    if (job < batch->blocksize) {
+      splitNoiseStream(&batch->streams, &stream);
     }
+    pthread_mutex_unlock(&batch->lock);
 
-    // build empty profile
-    double* exp_profile = (double*)malloc(sizeof(double) * size);
-
-    // insert scattered exponential profile - in reverse
-    for (i = 0; i < size; i++) {
-      int deltaT = (i-SIZE_OFFSET*sub_size);
+    if (job >= batch->blocksize) {
+      break;
+    }
 
-      if (deltaT >= 0) {
-	exp_profile[i] = exp(-deltaT/scatter_time);
-      } else {
-	exp_profile[i] = 0;
+    long index = batch->blockstart + job;
+    double* profile = &batch->profiles[job * nbins];
+    profileRecord* record = &batch->records[job];
+
+    long dcstep = index % batch->dc.steps;
+    long heightstep = (index / batch->dc.steps) % batch->height.steps;
+    long scatterstep = index / ((long)batch->dc.steps * batch->height.steps);
+
+    pulseComponent component;
+    component.shape = batch->shape;
+    component.center = batch->center;
+    component.width = nbins * (axis_value(&batch->dc, dcstep, batch->random_flag, &stream) / 100);
+    component.height = axis_value(&batch->height, heightstep, batch->random_flag, &stream);
+    double scatter_time = axis_value(&batch->scatter, scatterstep, batch->random_flag, &stream);
+
+    buildProfile(profile, nbins, &component, 1, scatter_time, work);
+
+    if (batch->whitenoise_flag == TRUE) {
+      // the noise goes through work, then onto the profile
+      fillGaussianNoise(&stream, work, nbins, batch->sigma, batch->base);
+      int ii;
+      for (ii = 0; ii < nbins; ii++) {
+	profile[ii] = profile[ii] + work[ii];
+      }
+    } else {
+      int ii;
+      for (ii = 0; ii < nbins; ii++) {
+	profile[ii] = profile[ii] + batch->base;
       }
     }
 
-    // profile constructed - now convolve using modulo techniques
-    double* convolved_profile = (double*)malloc(sizeof(double) * size);
-    
-    for (n = 0; n < size; n++) {
-      convolved_profile[n] = 0;
+    record->index = index;
+    record->shape = component.shape;
+    record->center = component.center;
+    record->width = component.width;
+    record->height = component.height;
+    record->scatter = scatter_time;
+    record->sigma = (batch->whitenoise_flag == TRUE) ? batch->sigma : 0;
+    record->baseline = batch->base;
+  }
 
-      for (m = 0; m < size; m++) {
-	convolved_profile[n] = convolved_profile[n] +  exp_profile[(n-m + size)%(size)] * profile[(m + size)%(size)];
-      }
-    }
+  free(work);
 
-    // then calculate area under convolved curve using rectangular approximation
-    double area_convolved = 0;
-    for (i = 0; i < size; i++) {
-      area_convolved = area_convolved + convolved_profile[i];
-    }
+  return NULL;
+}
 
-    // determine correction factor
-    double norm_factor = initial_profile_area / area_convolved; 
+void run_batch(progenyBatch* batch, FILE* outputfile, int threads) {
 
-    // and apply normalisation while copying the result into the original profile
-    for (i = 0; i < size; i++) {
-      profile[i] = convolved_profile[i] * norm_factor;
-    }
+  assert(batch != NULL);
+  assert(outputfile != NULL);
+  assert(threads > 0);
 
-    // cleanup
-    free(convolved_profile);
-  }
+  int nbins = batch->nbins;
+  long block = (batch->total < BATCH_BLOCK) ? batch->total : BATCH_BLOCK;
+  int ii;
 
-  return;
-}
+  batch->profiles = (double*)malloc(sizeof(double) * block * nbins);
+  batch->records = (profileRecord*)malloc(sizeof(profileRecord) * block);
+  assert(batch->profiles != NULL && batch->records != NULL);
+  pthread_mutex_init(&batch->lock, NULL);
 
-void fold_profile(double *input_profile, double *output_profile, int input_size, int output_size) {
+  writeProfileBankHeader(outputfile, nbins);
 
-  // check for valid input
-  assert(input_profile != NULL);
-  assert(output_profile != NULL);
-  assert(input_size > 0);
-  assert(output_size > 0);
+  // profiles are generated a block at a time, then written out in order
+  long reported = 0;
+  for (batch->blockstart = 0; batch->blockstart < batch->total; batch->blockstart = batch->blockstart + block) {
 
-  // initialise output profile
-  int i;
+    batch->blocksize = (batch->total - batch->blockstart < block) ? batch->total - batch->blockstart : block;
+    batch->next = 0;
 
-  for (i = 0; i < output_size; i++) {
-    output_profile[i] = 0;
-  }
+    if (threads == 1) {
+      batch_worker(batch);
+    } else {
+      pthread_t workers[threads];
+      for (ii = 0; ii < threads; ii++) {
+	int error = pthread_create(&workers[ii], NULL, batch_worker, batch);
+	assert(error == 0);
+      }
+      for (ii = 0; ii < threads; ii++) {
+	pthread_join(workers[ii], NULL);
+      }
+    }
 
-  // fold input profile
+    long jj;
+    for (jj = 0; jj < batch->blocksize; jj++) {
+      writeProfileRecord(outputfile, &batch->records[jj], &batch->profiles[jj * nbins], nbins);
+    }
 
-  for (i = 0; i < input_size; i++) {
-    output_profile[i % output_size] = output_profile[i % output_size] + input_profile[i];
+    // progress report every tenth of the way through
+    long done = batch->blockstart + batch->blocksize;
+    if ((done - reported) * 10 >= batch->total || done == batch->total) {
+      printf("%ld of %ld profiles written.\n", done, batch->total);
+      reported = done;
+    }
   }
 
+  pthread_mutex_destroy(&batch->lock);
+  free(batch->profiles);
+  free(batch->records);
+
   return;
 }
 
@@ -416,7 +580,7 @@ void progeny_help() {
 
   printf("\nPROGENY - a program to construct artificial pulsar profiles.\n");
   printf("To be used to generate standardised tests for FFANCY normalisation scheme and metrics.\n");
-  printf("Version 1.4.2, last updated 19/09/2016.\n");
+  printf("Version 1.6.2, last updated 19/10/2026.\n");
   printf("Written by Andrew Cameron, MPIFR IMPRS PhD Student.\n");
   printf("\n*****\n\n");
   printf("Input options:\n");
@@ -449,7 +613,18 @@ void progeny_help() {
   printf("                   1 - Writes data in PROFILE format, with two columns, one for bin number and one for the data point (DEFAULT).\n");
   printf("                   2 - Writes data in TIMESERIES format as a single continuous steam of integer values.\n");
 
+  printf("\n----- BATCH MODE -----\n");
+  printf("-bank [file]       Generates a batch of single component profiles into the named binary profile bank (replaces -o).\n");
+  printf("                   Uses -shape, -center, -whitenoise, -sigma and -baseline. Parameters without a grid take the value of\n");
+  printf("                   -dc / -width, -height and -scatter.\n");
+  printf("-dcgrid [lo] [hi] [n]       Grid of n duty cycles (percent) from lo to hi.\n");
+  printf("-heightgrid [lo] [hi] [n]   Grid of n pulse heights from lo to hi.\n");
+  printf("-scattergrid [lo] [hi] [n]  Grid of n scattering times (samples) from lo to hi.\n");
+  printf("-random [int]      Instead of the full grid, draws this many profiles with each parameter uniform over its grid range.\n");
+  printf("-threads [int]     Number of threads to generate profiles with (default = 1).\n");
+
   printf("\n----- MISCELLANEOUS -----\n");
+  printf("-seed [int]        Seed for noise generation and random sampling, for repeatable output (default = current time).\n");
   printf("-h / --help        Displays this useful and informative help menu.\n\n");
 
   return;
@@ -8,15 +8,20 @@
 // User defined libraries
 #include "stats.h"
 #include "equalstrings.h"
+#include "profilebank.h"
 
 #define TRUE 1
 #define FALSE 0
 
 #define STATS_OUT "stats.out"
 
+// input kinds
+#define INPUT_PROFILE 0 // PROGENY text profile or profile bank (told apart by the bank header)
+#define INPUT_PDUMP 1 // FFANCY -pdump / -npdump file, one profile per line
+
 // PROSTAT - Program to run statistical anaylsis on profiles
 // Written by Andrew Cameron
-// Version 1.1 - Last updated 25/03/2015
+// Version 1.3 - Last updated 19/10/2026
 
 /*
 
@@ -27,23 +32,65 @@ CHANGELOG:
 25/03/2015 - v1.1 - Implemented exclusion window for studying baseline statistics
                   - Impelemtned stats dump to file "stats.out"
 11/09/2016 - v1.2 - Updated help menu for publication
+19/10/2026 - v1.3 - Profiles are now read once, with all statistics gathered as the values arrive (Welford moments, min/max)
+                    and the median found by selection - the exclusion window is applied while reading rather than by copying
+                  - Multiple inputs per run (-i may be repeated), including profile banks and FFANCY profile dumps (-pdump),
+                    with one row of statistics per profile
+                  - Output destination chosen with -o (defaults to "stats.out" as before)
 */
 
+// ***** DATA TYPES *****
+
+// statistics of the profile currently being read
+typedef struct profileAccumulator {
+  streamStats stats;
+  double* kept; // values outside the exclusion window, for the median
+  int capacity;
+  int position; // bin number of the next value
+  int exclusion_flag;
+  int startbin;
+  int endbin;
+} profileAccumulator;
+
 // ***** FUNCTION PROTOTYPES *****
 
 // prints out an explanation of how to use the command line interface
 void prostat_help();
 
+// empties the accumulator ready for the next profile
+void startProfile(profileAccumulator* acc);
+
+// adds the next bin of the current profile, unless it falls inside the exclusion window
+void addProfileValue(profileAccumulator* acc, double value);
+
+// writes one row of the batch table - returns FALSE if the profile had no usable bins
+int writeStatsRow(FILE* outputfile, profileAccumulator* acc, char* source, long index, double period, int has_period);
+
+// reads every profile from a PROGENY text profile or profile bank, writing a row for each - returns the number of profiles
+long processProfileFile(FILE* outputfile, profileAccumulator* acc, char* name);
+
+// reads every profile from an FFANCY profile dump, writing a row for each - returns the number of profiles
+long processProfileDump(FILE* outputfile, profileAccumulator* acc, char* name);
+
 // ***** MAIN FUNCTION *****
 
 int main(int argc, char** argv) {
 
   // declare variables and initialise with defaults
-  FILE *inputfile = NULL;
-  FILE *outputfile = fopen(STATS_OUT, "w+");
-  int exclusion_flag = FALSE;
-  int startbin = 0;
-  int endbin = 1;
+  char* outputname = STATS_OUT;
+  int ninputs = 0;
+  int capacity = 16;
+  char** names = (char**)malloc(sizeof(char*) * capacity);
+  int* kinds = (int*)malloc(sizeof(int) * capacity);
+  assert(names != NULL && kinds != NULL);
+
+  profileAccumulator acc;
+  acc.exclusion_flag = FALSE;
+  acc.startbin = 0;
+  acc.endbin = 1;
+  acc.capacity = 1024;
+  acc.kept = (double*)malloc(sizeof(double) * acc.capacity);
+  assert(acc.kept != NULL);
 
   int i; // counter
 
@@ -57,15 +104,31 @@ int main(int argc, char** argv) {
   if (argc > 1) {
     i=1;
     while (i < argc) {
-      if (equal_strings(argv[i],"-i")) {
+      if (equal_strings(argv[i],"-i") || equal_strings(argv[i], "-pdump")) {
+	int kind = equal_strings(argv[i], "-i") ? INPUT_PROFILE : INPUT_PDUMP;
 	i++;
-	inputfile = fopen(argv[i], "r");
+	if (i >= argc) {
+	  printf("No file given for %s.\n", argv[i-1]);
+	  exit(0);
+	}
+	if (ninputs == capacity) {
+	  capacity = 2 * capacity;
+	  names = (char**)realloc(names, sizeof(char*) * capacity);
+	  kinds = (int*)realloc(kinds, sizeof(int) * capacity);
+	  assert(names != NULL && kinds != NULL);
+	}
+	names[ninputs] = argv[i];
+	kinds[ninputs] = kind;
+	ninputs++;
+      } else if (equal_strings(argv[i], "-o")) {
+	i++;
+	outputname = argv[i];
       } else if (equal_strings(argv[i], "-ew")) {
 	i++;
-	startbin = atoi(argv[i]);
+	acc.startbin = atoi(argv[i]);
 	i++;
-	endbin = atoi(argv[i]);
-	exclusion_flag = TRUE;
+	acc.endbin = atoi(argv[i]);
+	acc.exclusion_flag = TRUE;
       } else if (equal_strings(argv[i], "-h") || equal_strings(argv[i], "--help")) {
 	prostat_help();
 	exit(0);
@@ -78,106 +141,259 @@ int main(int argc, char** argv) {
   }
 
   // test for valid input
-  assert(inputfile != NULL);
-  assert(outputfile != NULL);
-  if (exclusion_flag == TRUE) {
-    assert(endbin >= startbin);
+  assert(ninputs > 0);
+  assert(outputname != NULL);
+  if (acc.exclusion_flag == TRUE) {
+    assert(acc.endbin >= acc.startbin);
   }
 
-  int bin;
-  double value;
-  int size = 0;  
+  FILE *inputfile = fopen(names[0], "rb");
+  assert(inputfile != NULL);
+  int nbins;
 
-  // work out how big the file is
-  while(fscanf(inputfile, "%d %lf", &bin, &value) != EOF) {
-    size++;
-  }
+  if ((ninputs == 1) && (kinds[0] == INPUT_PROFILE) && (readProfileBankHeader(inputfile, &nbins) == FALSE)) {
 
-  printf("\nFile is %d lines long.\n", size);
+    // a single text profile - report its statistics as a summary
+    FILE *outputfile = fopen(outputname, "w+");
+    assert(outputfile != NULL);
 
-  // prepare for actual file read
-  rewind(inputfile);
+    int bin;
+    double value;
+    startProfile(&acc);
+    while (fscanf(inputfile, "%d %lf", &bin, &value) == 2) {
+      addProfileValue(&acc, value);
+    }
 
-  // allocate sufficient memory
-  double* dataarray = (double*)malloc(sizeof(double) * size);
+    printf("\nFile is %d lines long.\n", acc.position);
 
-  // read data
-  i = 0;
-  while(fscanf(inputfile, "%d %lf", &bin, &value) != EOF) {
-    dataarray[i] = value;
-    i++;
-  }
+    // close input file
+    fclose(inputfile);
+    printf("\n*** FILE READ COMPLETE ***\n\n");
 
-  // close input file
-  fclose(inputfile);
-  printf("\n*** FILE READ COMPLETE ***\n\n");
-
-  // now need to handle an exclusion window, assuming that one has been specified
-  if (exclusion_flag == TRUE) {
-    printf("Applying exclusion window...");
-    // make a copy of the array with only the data outside the window
-    int windowsize = endbin - startbin + 1;
-    int newsize = size - windowsize;
-
-    double* smallarray = (double*)malloc(sizeof(double) * newsize);
-
-    int j = 0;
-    int k = 0;
-    while (j < size) {
-      if (j < startbin || j > endbin) {
-	smallarray[k] = dataarray[j];
-	k++;
-      }
-      j++;
+    if (acc.exclusion_flag == TRUE) {
+      // already applied as the file was read
+      printf("Applying exclusion window...");
+      printf("complete.\n\n");
     }
 
+    assert(acc.stats.count > 0);
+
+    double dmax = acc.stats.max;
+    double dmin = acc.stats.min;
+    double dmean = acc.stats.mean;
+    double dmedian = selectMedian(acc.kept, acc.stats.count);
+    double dsigma = streamStddev(&acc.stats);
+
+    // now perform stats and write out
+    printf("Statistics:\n\n");
+    printf("Max is: %f\n", dmax);
+    printf("Min is: %f\n", dmin);
+    printf("Mean is: %f\n", dmean);
+    printf("Median is: %f\n", dmedian);
+    printf("Std. dev is: %f\n", dsigma);
+
+    fprintf(outputfile, "Max %f\n", dmax);
+    fprintf(outputfile, "Min %f\n", dmin);
+    fprintf(outputfile, "Mean %f\n", dmean);
+    fprintf(outputfile, "Median %f\n", dmedian);
+    fprintf(outputfile, "Sigma %f\n", dsigma);
+
     // cleanup
-    free(dataarray);
-    dataarray = smallarray;
-    size = newsize;
-    printf("complete.\n\n");
+    free(acc.kept);
+    free(names);
+    free(kinds);
+    fclose(outputfile);
+    printf("\nPROSTAT complete.\n");
+
+    return 0;
   }
+  fclose(inputfile);
 
-  double dmax = max(dataarray, size);
-  double dmin = min(dataarray, size);
-  double dmean = mean(dataarray, size);
-  double dmedian = median(dataarray, size);
-  double dsigma = stddev(dataarray, size);
-
-  // now perform stats and write out
-  printf("Statistics:\n\n");
-  printf("Max is: %f\n", dmax);
-  printf("Min is: %f\n", dmin);
-  printf("Mean is: %f\n", dmean);
-  printf("Median is: %f\n", dmedian);
-  printf("Std. dev is: %f\n", dsigma);
-
-  fprintf(outputfile, "Max %f\n", dmax);
-  fprintf(outputfile, "Min %f\n", dmin);
-  fprintf(outputfile, "Mean %f\n", dmean);
-  fprintf(outputfile, "Median %f\n", dmedian);
-  fprintf(outputfile, "Sigma %f\n", dsigma);
+  // batch mode - one row per profile
+  FILE *outputfile = fopen(outputname, "w+");
+  assert(outputfile != NULL);
+  fprintf(outputfile, "# Source | Index | Period | Bins | Max | Min | Mean | Median | Sigma\n");
+
+  long total = 0;
+  for (i = 0; i < ninputs; i++) {
+    if (kinds[i] == INPUT_PDUMP) {
+      total = total + processProfileDump(outputfile, &acc, names[i]);
+    } else {
+      total = total + processProfileFile(outputfile, &acc, names[i]);
+    }
+  }
 
   // cleanup
-  free(dataarray);
+  free(acc.kept);
+  free(names);
+  free(kinds);
   fclose(outputfile);
-  printf("\nPROSTAT complete.\n");  
+  printf("\nStatistics of %ld profiles from %d inputs written to %s.\n", total, ninputs, outputname);
+  printf("\nPROSTAT complete.\n");
 
   return 0;
   
 }
 
+void startProfile(profileAccumulator* acc) {
+
+  assert(acc != NULL);
+
+  resetStreamStats(&acc->stats);
+  acc->position = 0;
+
+  return;
+}
+
+void addProfileValue(profileAccumulator* acc, double value) {
+
+  int bin = acc->position;
+  acc->position++;
+  if ((acc->exclusion_flag == TRUE) && (bin >= acc->startbin) && (bin <= acc->endbin)) {
+    return;
+  }
+
+  if (acc->stats.count == acc->capacity) {
+    acc->capacity = 2 * acc->capacity;
+    acc->kept = (double*)realloc(acc->kept, sizeof(double) * acc->capacity);
+    assert(acc->kept != NULL);
+  }
+  acc->kept[acc->stats.count] = value;
+  addStreamValue(&acc->stats, value);
+
+  return;
+}
+
+int writeStatsRow(FILE* outputfile, profileAccumulator* acc, char* source, long index, double period, int has_period) {
+
+  assert(outputfile != NULL);
+  assert(acc != NULL);
+
+  if (acc->stats.count == 0) {
+    printf("WARNING: profile %ld of %s has no bins outside the exclusion window - skipped.\n", index, source);
+    return FALSE;
+  }
+
+  fprintf(outputfile, "%s %ld ", source, index);
+  if (has_period == TRUE) {
+    fprintf(outputfile, "%.10f", period);
+  } else {
+    fprintf(outputfile, "-");
+  }
+  fprintf(outputfile, " %d %f %f %f %f %f\n", acc->position, acc->stats.max, acc->stats.min, acc->stats.mean, selectMedian(acc->kept, acc->stats.count), streamStddev(&acc->stats));
+
+  return TRUE;
+}
+
+long processProfileFile(FILE* outputfile, profileAccumulator* acc, char* name) {
+
+  FILE* inputfile = fopen(name, "rb");
+  if (inputfile == NULL) {
+    printf("ERROR: Unable to open input profile %s.\n", name);
+    exit(EXIT_FAILURE);
+  }
+
+  long count = 0;
+  int nbins;
+
+  if (readProfileBankHeader(inputfile, &nbins) == TRUE) {
+    profileRecord record;
+    double* profile = (double*)malloc(sizeof(double) * nbins);
+    assert(profile != NULL);
+    while (readProfileRecord(inputfile, &record, profile, nbins) == TRUE) {
+      startProfile(acc);
+      int j;
+      for (j = 0; j < nbins; j++) {
+	addProfileValue(acc, profile[j]);
+      }
+      count = count + writeStatsRow(outputfile, acc, name, (long)record.index, 0, FALSE);
+    }
+    free(profile);
+  } else {
+    int bin;
+    double value;
+    startProfile(acc);
+    while (fscanf(inputfile, "%d %lf", &bin, &value) == 2) {
+      addProfileValue(acc, value);
+    }
+    if (acc->position > 0) {
+      count = count + writeStatsRow(outputfile, acc, name, 0, 0, FALSE);
+    } else {
+      printf("WARNING: %s contains no profile - skipped.\n", name);
+    }
+  }
+
+  fclose(inputfile);
+
+  return count;
+}
+
+long processProfileDump(FILE* outputfile, profileAccumulator* acc, char* name) {
+
+  FILE* inputfile = fopen(name, "r");
+  if (inputfile == NULL) {
+    printf("ERROR: Unable to open profile dump %s.\n", name);
+    exit(EXIT_FAILURE);
+  }
+
+  long count = 0;
+  long line = 0;
+  char* buffer = NULL;
+  size_t buffersize = 0;
+
+  // each line is the period and scalefactor, followed by the profile bins
+  while (getline(&buffer, &buffersize, inputfile) != -1) {
+    char* cursor = buffer;
+    char* end;
+    double period = strtod(cursor, &end);
+    if (end == cursor) {
+      // blank or unreadable line
+      line++;
+      continue;
+    }
+    cursor = end;
+    strtol(cursor, &end, 10); // scalefactor - not needed
+    cursor = end;
+
+    startProfile(acc);
+    while (TRUE) {
+      double value = strtod(cursor, &end);
+      if (end == cursor) {
+	break;
+      }
+      addProfileValue(acc, value);
+      cursor = end;
+    }
+    if (acc->position > 0) {
+      count = count + writeStatsRow(outputfile, acc, name, line, period, TRUE);
+    }
+    line++;
+  }
+
+  free(buffer);
+  fclose(inputfile);
+
+  return count;
+}
+
 void prostat_help() {
 
   printf("\nPROSTAT - Program to run statistical anaylsis on profiles.\n");
-  printf("Writes statistics summary to file 'stats.out'\n");
-  printf("Version 1.2, last updated 11/09/2016.\n");
+  printf("Writes statistics summary to file 'stats.out', or the file given by -o\n");
+  printf("Version 1.3, last updated 19/10/2026.\n");
   printf("Written by Andrew Cameron, MPIFR IMPRS PhD Student.\n");
   printf("\n*****\n\n");
   printf("Input options:\n");
 
   printf("\n----- BASIC PARAMETERS -----\n");
-  printf("-i [file]        Name of the PROGENY format input file.\n");
+  printf("-i [file]        Name of the PROGENY format input file - either a text profile or a profile bank (progeny -bank).\n");
+  printf("                 May be given more than once.\n");
+  printf("-pdump [file]    Name of an FFANCY profile dump (-pdump / -npdump), with one profile per line. May be given more than once.\n");
+  printf("-o [file]        Name of the output file (default 'stats.out').\n");
+  printf("                 A single text profile gives the summary format (Max / Min / Mean / Median / Sigma, one per line).\n");
+  printf("                 Anything else gives a table with one row per profile:\n");
+  printf("                 Source | Index | Period | Bins | Max | Min | Mean | Median | Sigma\n");
+  printf("                 where Index is the bank index or dump line number, and Period is only given for profile dumps.\n");
 
   printf("\n----- DATA SELECTION -----\n");
   printf("-ew [int] [int]  Specifies an exclusion window using two integers - the first and last bins of data\n");
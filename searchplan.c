@@ -0,0 +1,260 @@
+// C file for planning FFA searches
+// Andrew Cameron, MPIFR, 19/10/2026
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include "ffadata.h"
+#include "paddedarray.h"
+#include "dataarray.h"
+#include "power2resizer.h"
+#include "ffa.h"
+#include "searchplan.h"
+
+// adds an octave to the end of a plan
+static void addOctave(searchPlan* plan, int downsamples, int scalefactor, int firstperiod, int trials, int trim);
+
+searchPlan* createSearchPlan(double tsamp, double minperiod, double maxperiod, double duty) {
+
+  assert(tsamp > 0);
+  assert(minperiod > 0);
+  assert(maxperiod > minperiod);
+  assert(duty > 0 && duty < 1);
+
+  searchPlan* plan = (searchPlan*)malloc(sizeof(searchPlan));
+  assert(plan != NULL);
+  plan->noctaves = 0;
+  plan->octaves = NULL;
+  plan->tsamp = tsamp;
+
+  // profiles of minbins to 2*minbins - 1 bins
+  int minbins = (int)ceil(PLAN_PULSE_BINS/duty);
+  if (minbins < 2) {
+    minbins = 2;
+  }
+  plan->minbins = minbins;
+
+  double lowsamples = minperiod/tsamp;
+  double highsamples = maxperiod/tsamp;
+
+  // downsample until the shortest period falls within [minbins, 2*minbins) - short periods may have fewer bins than minbins, but never more than they need
+  int downsamples = 0;
+  while (lowsamples/pow(2, downsamples + 1) >= minbins) {
+    downsamples++;
+  }
+  int firstperiod = (int)floor(lowsamples/pow(2, downsamples));
+  if (firstperiod < 2) {
+    // the smallest base period the FFA can run
+    firstperiod = 2;
+  }
+
+  while (TRUE) {
+    int scalefactor = 1 << downsamples;
+    // base periods run up to the one whose last trial reaches maxperiod
+    int endperiod = (int)ceil(highsamples/scalefactor);
+    if (endperiod <= firstperiod) {
+      endperiod = firstperiod + 1;
+    }
+    if (endperiod <= 2*minbins) {
+      addOctave(plan, downsamples, scalefactor, firstperiod, endperiod - firstperiod, FFA_TRIM_KEEP_END);
+      break;
+    }
+    // the last trial of this octave's final base period is the first trial of the next octave
+    addOctave(plan, downsamples, scalefactor, firstperiod, 2*minbins - firstperiod, FFA_TRIM_REPEATS);
+    downsamples++;
+    firstperiod = minbins;
+  }
+
+  return plan;
+}
+
+searchPlan* legacySearchPlan(int lowperiod, int highperiod, int prelim_ds, int scalefactor) {
+
+  assert(lowperiod >= 2);
+  assert(highperiod > lowperiod);
+  assert(prelim_ds >= 0);
+  assert(scalefactor >= 1);
+
+  if (fmod(lowperiod, scalefactor) != 0) {
+    printf("ERROR: Low search period (%d) must be integer multiple of initial downsampling factor (%d).\nPlease correct and try again.\n", lowperiod, scalefactor);
+    exit(EXIT_FAILURE);
+  }
+
+  searchPlan* plan = (searchPlan*)malloc(sizeof(searchPlan));
+  assert(plan != NULL);
+  plan->noctaves = 0;
+  plan->octaves = NULL;
+  plan->tsamp = 0;
+  plan->minbins = 0;
+
+  // step through the base periods as massFFA always has - i is in original samples, and a downsample happens whenever it reaches lowperiod*2^loops
+  int i = lowperiod;
+  int loops = 0;
+  int downsamples = prelim_ds;
+  while (i < highperiod) {
+
+    if (i == lowperiod*((int)pow(2, loops))) {
+      downsamples = prelim_ds + loops;
+      loops++;
+    }
+
+    int octavescale = scalefactor * (1 << downsamples);
+    int nextdownsample = lowperiod*((int)pow(2, loops));
+    int trials = 0;
+    int j;
+    for (j = i; (j < highperiod) && (j != nextdownsample); j = j + octavescale) {
+      trials++;
+    }
+
+    addOctave(plan, downsamples, octavescale, i/octavescale, trials, FFA_TRIM_NONE);
+    i = i + trials*octavescale;
+  }
+
+  return plan;
+}
+
+void deleteSearchPlan(searchPlan* plan) {
+
+  assert(plan != NULL);
+
+  free(plan->octaves);
+  free(plan);
+
+  return;
+}
+
+int searchPlanLowPeriod(searchPlan* plan) {
+
+  assert(plan != NULL && plan->noctaves > 0);
+
+  return plan->octaves[0].firstperiod * plan->octaves[0].scalefactor;
+}
+
+int searchPlanHighPeriod(searchPlan* plan) {
+
+  assert(plan != NULL && plan->noctaves > 0);
+
+  searchOctave* last = &plan->octaves[plan->noctaves - 1];
+  return (last->firstperiod + last->trials) * last->scalefactor;
+}
+
+int searchPlanFits(searchPlan* plan, paddedArray* sourcedata, int segments, int* misfit) {
+
+  assert(plan != NULL);
+  assert(sourcedata != NULL);
+  assert(segments >= 1);
+
+  int o;
+  for (o = 0; o < plan->noctaves; o++) {
+    searchOctave* octave = &plan->octaves[o];
+    int datasize, fullsize;
+    downsampledSizes(sourcedata, octave->downsamples, &datasize, &fullsize);
+    datasize = datasize/segments;
+    // a fold needs at least two branches, and a segmented search two whole periods in each segment
+    int lastperiod = octave->firstperiod + octave->trials - 1;
+    if ((datasize <= lastperiod) || ((segments > 1) && (datasize < 2*lastperiod))) {
+      if (misfit != NULL) {
+	*misfit = o;
+      }
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+long octaveTrials(searchOctave* octave, paddedArray* sourcedata, int segments, int oversample, long* skipped) {
+
+  assert(octave != NULL);
+  assert(sourcedata != NULL);
+  assert(segments >= 1);
+
+  int datasize, fullsize;
+  downsampledSizes(sourcedata, octave->downsamples, &datasize, &fullsize);
+  datasize = datasize/segments;
+
+  long count = 0;
+  long repeats = 0;
+  int lastperiod = octave->firstperiod + octave->trials - 1;
+  int baseperiod;
+  for (baseperiod = octave->firstperiod; baseperiod <= lastperiod; baseperiod++) {
+    int branches = power2Resizer(datasize, baseperiod)/baseperiod;
+    assert(branches >= 2);
+    if (oversample == 2) {
+      count = count + ffaHalfSteps(datasize, baseperiod);
+    }
+    if ((octave->trim == FFA_TRIM_REPEATS) || ((octave->trim == FFA_TRIM_KEEP_END) && (baseperiod != lastperiod))) {
+      branches--;
+      repeats++;
+    }
+    count = count + branches;
+  }
+
+  if (skipped != NULL) {
+    *skipped = repeats;
+  }
+
+  return count;
+}
+
+void printSearchPlan(searchPlan* plan, paddedArray* sourcedata, int segments, int oversample) {
+
+  assert(plan != NULL);
+  assert(sourcedata != NULL);
+
+  printf("\nSearch plan: %d octaves", plan->noctaves);
+  if (plan->minbins > 0) {
+    printf(", profiles of %d to %d bins", plan->minbins, 2*plan->minbins - 1);
+  }
+  printf("\n");
+  if (plan->tsamp > 0) {
+    printf("Octave | Downsample factor | Base periods (bins) | Periods (samples) | Periods (s) | Trials\n");
+  } else {
+    printf("Octave | Downsample factor | Base periods (bins) | Periods (samples) | Trials\n");
+  }
+
+  long total = 0;
+  long totalskipped = 0;
+  int o;
+  for (o = 0; o < plan->noctaves; o++) {
+    searchOctave* octave = &plan->octaves[o];
+    long skipped;
+    long trials = octaveTrials(octave, sourcedata, segments, oversample, &skipped);
+    int low = octave->firstperiod * octave->scalefactor;
+    int high = (octave->firstperiod + octave->trials) * octave->scalefactor;
+
+    printf("%d %d %d-%d %d-%d", o, octave->scalefactor, octave->firstperiod, octave->firstperiod + octave->trials - 1, low, high);
+    if (plan->tsamp > 0) {
+      printf(" %.6f-%.6f", low*plan->tsamp, high*plan->tsamp);
+    }
+    printf(" %ld\n", trials);
+
+    total = total + trials;
+    totalskipped = totalskipped + skipped;
+  }
+
+  printf("Total trials: %ld", total);
+  if (totalskipped > 0) {
+    printf(" (%ld repeated trials skipped)", totalskipped);
+  }
+  printf("\n");
+
+  return;
+}
+
+static void addOctave(searchPlan* plan, int downsamples, int scalefactor, int firstperiod, int trials, int trim) {
+
+  plan->octaves = (searchOctave*)realloc(plan->octaves, sizeof(searchOctave) * (plan->noctaves + 1));
+  assert(plan->octaves != NULL);
+
+  searchOctave* octave = &plan->octaves[plan->noctaves];
+  octave->downsamples = downsamples;
+  octave->scalefactor = scalefactor;
+  octave->firstperiod = firstperiod;
+  octave->trials = trials;
+  octave->trim = trim;
+  plan->noctaves++;
+
+  return;
+}
@@ -0,0 +1,80 @@
+// Header for planning FFA searches - which base periods to run at which downsampling
+// Andrew Cameron, MPIFR, 19/10/2026
+
+// A search plan is a list of octaves, each a run of consecutive base periods searched on the data downsampled a fixed number of times
+// massFFA() carries out a plan octave by octave, preparing the downsampled (and de-reddened) data once per octave
+//
+// createSearchPlan() works from physical units: the sample time, the range of periods to search in seconds, and the smallest duty cycle of interest
+// Every octave keeps its profiles between PLAN_PULSE_BINS/duty and twice that many bins, by downsampling once more each time the period doubles,
+// so that no profile has many more bins than needed to resolve the narrowest pulse. The last trial of each base period (which repeats the first
+// trial of the next base period, or of the next octave) is skipped, except at the very end of the search.
+//
+// legacySearchPlan() gives the plan that the -lp / -hp / -ds options have always produced, with every trial kept
+//
+// Neither knows the length of the data - check a plan against the data with searchPlanFits() before running or printing it
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "ffadata.h"
+#include "paddedarray.h"
+
+#ifndef SEARCHPLAN_H
+#define SEARCHPLAN_H
+
+#define TRUE 1
+#define FALSE 0
+
+// the narrowest pulse of interest should cover at least this many profile bins
+#define PLAN_PULSE_BINS 1.0
+
+// duty cycle used when none is given
+#define PLAN_DEFAULT_DUTY 0.01
+
+// ***** DATA TYPES *****
+
+// one run of consecutive base periods on the same downsampled data
+typedef struct searchOctave {
+  int downsamples; // number of times the source data is downsampled by 2
+  int scalefactor; // original samples per downsampled sample
+  int firstperiod; // first base period, in downsampled samples
+  int trials; // number of base periods
+  int trim; // which repeated trials are skipped (FFA_TRIM_* in ffa.h)
+} searchOctave;
+
+typedef struct searchPlan {
+  int noctaves;
+  searchOctave* octaves;
+  double tsamp; // sample time in seconds, or 0 if the plan was made in samples
+  int minbins; // smallest profile the plan aims for (0 for a legacy plan)
+} searchPlan;
+
+// ***** FUNCTION PROTOTYPES *****
+
+// plans a search of periods [minperiod, maxperiod] seconds on data sampled every tsamp seconds, for pulses with a duty cycle of at least duty
+// the data must have a scalefactor of 1 (i.e. tsamp is its sample time)
+searchPlan* createSearchPlan(double tsamp, double minperiod, double maxperiod, double duty);
+
+// the plan produced by searching base periods from lowperiod up to highperiod original samples, after prelim_ds preliminary downsamples,
+// and downsampling again each time the period doubles - scalefactor is that of the source data
+// exits if lowperiod is not a multiple of scalefactor
+searchPlan* legacySearchPlan(int lowperiod, int highperiod, int prelim_ds, int scalefactor);
+
+// cleans up a search plan
+void deleteSearchPlan(searchPlan* plan);
+
+// the first and last (exclusive) periods of the plan, in original samples
+int searchPlanLowPeriod(searchPlan* plan);
+int searchPlanHighPeriod(searchPlan* plan);
+
+// returns TRUE if sourcedata, split into segments, is long enough to fold every base period of the plan, or FALSE if not
+// (if misfit is not NULL, it then receives the first octave that does not fit)
+int searchPlanFits(searchPlan* plan, paddedArray* sourcedata, int segments, int* misfit);
+
+// returns the number of trial periods one octave will produce on sourcedata, split into segments and with oversample FFA passes per base period
+// if skipped is not NULL, it receives the number of repeated trials the octave leaves out
+long octaveTrials(searchOctave* octave, paddedArray* sourcedata, int segments, int oversample, long* skipped);
+
+// prints out the octaves of a plan with their trial counts
+void printSearchPlan(searchPlan* plan, paddedArray* sourcedata, int segments, int oversample);
+
+#endif /* SEARCHPLAN_H */
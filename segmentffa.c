@@ -0,0 +1,388 @@
+// C file for the segmented (incoherent) FFA search
+// Andrew Cameron, MPIFR, 19/10/2026
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include "ffadata.h"
+#include "paddedarray.h"
+#include "power2resizer.h"
+#include "ffa.h"
+#include "periodogram.h"
+#include "hugealloc.h"
+#include "segmentffa.h"
+
+// the passes folded for each base period - the standard FFA, then the half-step folds of baseperiod - 1 and baseperiod
+#define SEGMENT_PASS_STANDARD 0
+#define SEGMENT_PASS_LOWER 1
+#define SEGMENT_PASS_UPPER 2
+
+// state shared by all of the threads of a segmented search
+// results are added into the accumulators one segment at a time, in order - turn is the next segment due, and step counts the (base period, pass) combinations completed
+// with half-step trials, the sums hold the standard and half-step trials of a base period, so that they can be written in period order once every pass is in
+typedef struct segmentSearch {
+  FILE* outputfile;
+  FILE* profilefile;
+  FILE* normprofilefile;
+  paddedArray* sourcedata;
+  int segments;
+  int segmentsize;
+  int segmode;
+  int firstperiod;
+  int trials;
+  double (*metric)(ffadata*, int, int);
+  int mfsize;
+  int layout;
+  int format;
+  int oversample;
+  int threads;
+  int trim;
+  ffadata* profilesum;   // summed profiles, profile-major (SEGMENT_SUM_PROFILES)
+  double* metricsum;     // summed metrics (SEGMENT_SUM_METRICS)
+  ffadata* smootharray;  // matched filter scratch space for evaluating the summed profiles
+  long step;
+  int turn;
+  pthread_mutex_t lock;
+  pthread_cond_t turnchange;
+} segmentSearch;
+
+typedef struct segmentWorker {
+  segmentSearch* search;
+  int worker;
+} segmentWorker;
+
+// folds the segments assigned to one thread and adds them into the shared sums in turn
+static void* runSegmentWorker(void* arg);
+
+// writes out the combined result of every segment and pass for one base period, then clears the sums
+// only the trials the plan evaluates are written (see ffaEvaluatedBranches())
+static void emitSegmentSums(segmentSearch* search, ffaPlan* plan, int baseperiod, int branches);
+
+// the rows of a pass that are added into the sums for a base period - the fold of foldperiod with source rows rowshift samples further apart,
+// of which rows firstrow to lastrow - 1 are added, row k into slot k + slotoffset - returns FALSE if the pass adds nothing
+static int segmentPassRows(segmentSearch* search, ffaPlan* plan, int baseperiod, int pass, int* foldperiod, double* rowshift, int* firstrow, int* lastrow, int* slotoffset);
+
+// returns the trial period held in a slot of the sums for a base period, and the number of bins of its profile via bins
+// slots below branches hold the standard trials, and the slots from branches onwards the half-step trials, in period order (see FFA_HALFSTEP_SHIFT)
+static double segmentSlot(int slot, int baseperiod, int segmentsize, int* bins);
+
+void segmentedFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, int segments, int segmode, int firstperiod, int trials, double (*metric)(ffadata*, int, int), int mfsize, int layout, int format, int oversample, int threads, int trim) {
+
+  // validity checks
+  assert(outputfile != NULL);
+  assert(sourcedata != NULL);
+  assert(segments >= 1);
+  assert(segmode == SEGMENT_SUM_PROFILES || segmode == SEGMENT_SUM_METRICS);
+  assert((segmode == SEGMENT_SUM_PROFILES) || ((profilefile == NULL) && (normprofilefile == NULL)));
+  assert(threads >= 1);
+
+  if (trials <= 0) {
+    return;
+  }
+
+  segmentSearch search;
+  search.outputfile = outputfile;
+  search.profilefile = profilefile;
+  search.normprofilefile = normprofilefile;
+  search.sourcedata = sourcedata;
+  search.segments = segments;
+  search.segmentsize = getPaddedArrayDataSize(sourcedata)/segments;
+  search.segmode = segmode;
+  search.firstperiod = firstperiod;
+  search.trials = trials;
+  search.metric = metric;
+  search.mfsize = mfsize;
+  search.layout = layout;
+  search.format = format;
+  search.oversample = oversample;
+  search.trim = trim;
+  search.threads = (threads > segments) ? segments : threads;
+  search.step = 0;
+  search.turn = 0;
+
+  printf("Segmented search: %d segments of %d samples, base periods %d to %d.\n", segments, search.segmentsize, firstperiod, firstperiod + trials - 1);
+  // every segment needs at least two rows of the longest base period for the FFA to produce a range of trial periods
+  if (search.segmentsize < 2*(firstperiod + trials - 1)) {
+    printf("ERROR: Segments of %d samples are too short for a base period of %d samples.\nPlease use fewer segments and try again.\n", search.segmentsize, firstperiod + trials - 1);
+    exit(EXIT_FAILURE);
+  }
+
+  // the sums only ever need to hold the profiles (or metrics) of one segment
+  int maxbranches = 0;
+  int maxsize = 0;
+  int baseperiod, branches;
+  for (baseperiod = firstperiod; baseperiod < firstperiod + trials; baseperiod++) {
+    branches = power2Resizer(search.segmentsize, baseperiod)/baseperiod;
+    if (oversample == 2) {
+      branches = branches + ffaHalfSteps(search.segmentsize, baseperiod);
+    }
+    if (branches > maxbranches) {
+      maxbranches = branches;
+    }
+    if (branches*baseperiod > maxsize) {
+      maxsize = branches*baseperiod;
+    }
+  }
+
+  search.profilesum = ffaPlanBuffer(maxsize);
+  search.metricsum = (double*)calloc(maxbranches, sizeof(double));
+  search.smootharray = ffaPlanBuffer(firstperiod + trials);
+  assert(search.metricsum != NULL);
+
+  pthread_mutex_init(&search.lock, NULL);
+  pthread_cond_init(&search.turnchange, NULL);
+
+  segmentWorker jobs[search.threads];
+  pthread_t workers[search.threads];
+  int t;
+
+  for (t = 0; t < search.threads; t++) {
+    jobs[t].search = &search;
+    jobs[t].worker = t;
+  }
+
+  if (search.threads == 1) {
+    runSegmentWorker(&jobs[0]);
+  } else {
+    for (t = 0; t < search.threads; t++) {
+      int error = pthread_create(&workers[t], NULL, runSegmentWorker, &jobs[t]);
+      assert(error == 0);
+    }
+    for (t = 0; t < search.threads; t++) {
+      pthread_join(workers[t], NULL);
+    }
+  }
+
+  // cleanup
+  pthread_mutex_destroy(&search.lock);
+  pthread_cond_destroy(&search.turnchange);
+  hugeFree(search.profilesum);
+  hugeFree(search.smootharray);
+  free(search.metricsum);
+
+  return;
+}
+
+int segmentPhaseShift(long offset, double period, int baseperiod) {
+
+  // bin j of the segment's profile holds the samples at offset + j (+ whole periods), which sit at phase (offset + j) mod period of the full data
+  int shift = (int)lround(fmod((double)offset, period) * baseperiod / period);
+
+  return shift % baseperiod;
+}
+
+static void* runSegmentWorker(void* arg) {
+
+  segmentWorker* job = (segmentWorker*)arg;
+  segmentSearch* search = job->search;
+
+  int layout = search->layout;
+  int segmentsize = search->segmentsize;
+  int i, j, k, pass, segment, branches, bins;
+  int foldperiod, firstrow, lastrow, slotoffset;
+  double rowshift;
+
+  // each segment is presented to the FFA as a paddedArray that starts partway into the full data
+  // rows past the end of a segment are always read as zeroes, so the FFA never reads into the next segment
+  paddedArray view = *search->sourcedata;
+  view.datasize = segmentsize;
+
+  // the plan is built (and its buffers first touched) by the thread that uses it, and is only big enough for one segment
+  // the half-step trials of firstperiod come partly from a fold of firstperiod - 1
+  int lowperiod = ((search->oversample == 2) && (search->firstperiod > 1)) ? search->firstperiod - 1 : search->firstperiod;
+  ffaPlan* plan = createFFAPlan(segmentsize, lowperiod, search->firstperiod + search->trials, layout, PERIODOGRAM_TEXT, 1);
+  trimFFAPlan(plan, search->trim, search->firstperiod + search->trials - 1);
+  double* metrics = (double*)malloc(sizeof(double)*(power2Resizer(segmentsize, lowperiod)/lowperiod + 1));
+  assert(metrics != NULL);
+
+  long step = 0;
+  for (i = 0; i < search->trials; i++) {
+
+    int baseperiod = search->firstperiod + i;
+    // every segment has the same length, so every thread folds the same passes for each base period
+    int lastpass = SEGMENT_PASS_UPPER;
+    while (segmentPassRows(search, plan, baseperiod, lastpass, &foldperiod, &rowshift, &firstrow, &lastrow, &slotoffset) == FALSE) {
+      lastpass--;
+    }
+
+    for (pass = SEGMENT_PASS_STANDARD; pass <= lastpass; pass++) {
+
+      if (segmentPassRows(search, plan, baseperiod, pass, &foldperiod, &rowshift, &firstrow, &lastrow, &slotoffset) == FALSE) {
+	continue;
+      }
+
+      for (segment = job->worker; segment < search->segments; segment = segment + search->threads) {
+
+	long offset = (long)segment*segmentsize;
+	view.dataarray = getPaddedArrayDataArray(search->sourcedata) + offset;
+	view.fullsize = getPaddedArrayFullSize(search->sourcedata) - offset;
+
+	ffadata* finalarray = foldFFAPlan(plan, &view, foldperiod, rowshift, &branches);
+
+	// evaluate this segment's profiles on their own if the metrics are being summed - done before waiting for our turn
+	if (search->segmode == SEGMENT_SUM_METRICS) {
+	  for (k = firstrow; k < lastrow; k++) {
+	    ffadata* row = ffaRow(finalarray, layout, k, foldperiod);
+	    for (j = 0; j < foldperiod; j++) {
+	      plan->profile[j] = row[j*ffaStride(layout)];
+	    }
+	    if (search->mfsize > 0) {
+	      mfsmootherWork(plan->profile, 0, foldperiod, search->mfsize, plan->smootharray);
+	    }
+	    metrics[k] = search->metric(plan->profile, 0, foldperiod);
+	  }
+	}
+
+	// add this segment into the sums once every earlier segment has been added
+	pthread_mutex_lock(&search->lock);
+	while ((search->step != step) || (search->turn != segment)) {
+	  pthread_cond_wait(&search->turnchange, &search->lock);
+	}
+
+	if (search->segmode == SEGMENT_SUM_METRICS) {
+	  for (k = firstrow; k < lastrow; k++) {
+	    search->metricsum[k + slotoffset] = search->metricsum[k + slotoffset] + metrics[k];
+	  }
+	} else {
+	  for (k = firstrow; k < lastrow; k++) {
+	    ffadata* row = ffaRow(finalarray, layout, k, foldperiod);
+	    ffadata* sum = &search->profilesum[(k + slotoffset)*baseperiod];
+	    int shift = segmentPhaseShift(offset, segmentSlot(k + slotoffset, baseperiod, segmentsize, &bins), foldperiod);
+	    for (j = 0; j < foldperiod; j++) {
+	      sum[(j + shift) % foldperiod] = add(sum[(j + shift) % foldperiod], row[j*ffaStride(layout)]);
+	    }
+	  }
+	}
+
+	search->turn++;
+	if (search->turn == search->segments) {
+	  // every segment is in - once the last pass is in, write out this base period and move on to the next
+	  if (pass == lastpass) {
+	    emitSegmentSums(search, plan, baseperiod, power2Resizer(segmentsize, baseperiod)/baseperiod);
+	  }
+	  search->turn = 0;
+	  search->step++;
+	}
+
+	pthread_cond_broadcast(&search->turnchange);
+	pthread_mutex_unlock(&search->lock);
+      }
+
+      step++;
+    }
+  }
+
+  free(metrics);
+  deleteFFAPlan(plan);
+
+  return NULL;
+}
+
+static int segmentPassRows(segmentSearch* search, ffaPlan* plan, int baseperiod, int pass, int* foldperiod, double* rowshift, int* firstrow, int* lastrow, int* slotoffset) {
+
+  int branches = power2Resizer(search->segmentsize, baseperiod)/baseperiod;
+
+  if (pass == SEGMENT_PASS_STANDARD) {
+    *foldperiod = baseperiod;
+    *rowshift = 0;
+    *firstrow = 0;
+    *lastrow = ffaEvaluatedBranches(plan, baseperiod, branches);
+    *slotoffset = 0;
+    return TRUE;
+  }
+
+  if (search->oversample != 2) {
+    return FALSE;
+  }
+
+  // the half-step slots start with the upper rows of the half-step fold of baseperiod - 1
+  int lowfirst = 0;
+  int lowlast = 0;
+  if (baseperiod > 1) {
+    ffaHalfStepRows(power2Resizer(search->segmentsize, baseperiod - 1)/(baseperiod - 1), TRUE, &lowfirst, &lowlast);
+  }
+
+  *rowshift = FFA_HALFSTEP_SHIFT;
+  if (pass == SEGMENT_PASS_LOWER) {
+    *foldperiod = baseperiod - 1;
+    *firstrow = lowfirst;
+    *lastrow = lowlast;
+    *slotoffset = branches - lowfirst;
+  } else {
+    *foldperiod = baseperiod;
+    ffaHalfStepRows(branches, FALSE, firstrow, lastrow);
+    *slotoffset = branches + lowlast - lowfirst;
+  }
+
+  return (*lastrow > *firstrow) ? TRUE : FALSE;
+}
+
+static double segmentSlot(int slot, int baseperiod, int segmentsize, int* bins) {
+
+  int branches = power2Resizer(segmentsize, baseperiod)/baseperiod;
+  double period_increment = (double)1/((double)(branches - 1));
+
+  *bins = baseperiod;
+  if (slot < branches) {
+    return slot * period_increment + baseperiod;
+  }
+
+  int lowfirst = 0;
+  int lowlast = 0;
+  int lowbranches = 0;
+  if (baseperiod > 1) {
+    lowbranches = power2Resizer(segmentsize, baseperiod - 1)/(baseperiod - 1);
+    ffaHalfStepRows(lowbranches, TRUE, &lowfirst, &lowlast);
+  }
+
+  int row = slot - branches + lowfirst;
+  if (row < lowlast) {
+    *bins = baseperiod - 1;
+    return row * ((double)1/((double)(lowbranches - 1))) + (baseperiod - 1) + FFA_HALFSTEP_SHIFT;
+  }
+
+  row = row - lowlast;
+  return row * period_increment + baseperiod + FFA_HALFSTEP_SHIFT;
+}
+
+static void emitSegmentSums(segmentSearch* search, ffaPlan* plan, int baseperiod, int branches) {
+
+  int k, h, slot, bins;
+  int scalefactor = getPaddedArrayScaleFactor(search->sourcedata);
+  int evaluated = ffaEvaluatedBranches(plan, baseperiod, branches);
+  int halfsteps = (search->oversample == 2) ? ffaHalfSteps(search->segmentsize, baseperiod) : 0;
+
+  // the standard and half-step trials are each in period order - merge them, so that the periodogram is too
+  k = 0;
+  h = 0;
+  while ((k < evaluated) || (h < halfsteps)) {
+
+    if ((h < halfsteps) && ((k == evaluated) || (segmentSlot(branches + h, baseperiod, search->segmentsize, &bins) < segmentSlot(k, baseperiod, search->segmentsize, &bins)))) {
+      slot = branches + h;
+      h++;
+    } else {
+      slot = k;
+      k++;
+    }
+
+    double period = segmentSlot(slot, baseperiod, search->segmentsize, &bins);
+
+    if (search->segmode == SEGMENT_SUM_METRICS) {
+      periodogramRow row;
+      row.period = period*scalefactor;
+      row.scalefactor = scalefactor;
+      row.dsperiod = period;
+      row.metric = search->metricsum[slot];
+      writePeriodogramRow(search->outputfile, search->format, &row);
+      search->metricsum[slot] = 0;
+    } else {
+      ffadata* profile = &search->profilesum[slot*baseperiod];
+      evaluateProfile(search->outputfile, search->profilefile, search->normprofilefile, profile, bins, period, scalefactor, search->metric, search->mfsize, NULL, search->smootharray, search->format);
+      hugeTouch(profile, sizeof(ffadata)*baseperiod);
+    }
+  }
+
+  return;
+}
@@ -0,0 +1,35 @@
+// Header for the segmented (incoherent) FFA search
+// Andrew Cameron, MPIFR, 19/10/2026
+
+// A long time series is split into equal length segments, which are folded independently by the FFA
+// Because every segment has the same length, every segment tests exactly the same trial periods for a given base period, and the results are combined trial by trial:
+// SEGMENT_SUM_PROFILES - the folded profiles are rotated to a common phase reference (the start of the first segment) and summed, then evaluated (semi-coherent)
+// SEGMENT_SUM_METRICS - each segment's profiles are evaluated separately and the metrics are summed (fully incoherent)
+// Segments are shared out between threads, each with its own FFA plan sized for one segment, so memory per thread shrinks with the number of segments
+// Segment results are always added together in segment order, so the output does not depend on the number of threads
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "ffadata.h"
+#include "paddedarray.h"
+
+#ifndef SEGMENTFFA_H
+#define SEGMENTFFA_H
+
+#define TRUE 1
+#define FALSE 0
+
+#define SEGMENT_SUM_PROFILES 1
+#define SEGMENT_SUM_METRICS 2
+
+// ***** FUNCTION PROTOTYPES *****
+
+// Runs the segmented FFA for base periods firstperiod to firstperiod + trials - 1, with sourcedata split into the given number of segments
+// Takes the same remaining options as rangeFFA(), including the FFA_TRIM_* mode - profile dumps are only available when summing profiles
+void segmentedFFA(FILE* outputfile, FILE* profilefile, FILE* normprofilefile, paddedArray* sourcedata, int segments, int segmode, int firstperiod, int trials, double (*metric)(ffadata*, int, int), int mfsize, int layout, int format, int oversample, int threads, int trim);
+
+// returns the number of bins by which a profile folded from a segment starting offset samples into the data must be rotated to line up with
+// profiles folded from the start of the data, for a trial period of period samples and a profile of baseperiod bins
+int segmentPhaseShift(long offset, double period, int baseperiod);
+
+#endif /* SEGMENTFFA_H */
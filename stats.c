@@ -1,6 +1,7 @@
 // Impelemtation of array statistics package
 // Andrew Cameron, MPIFR, 20/03/2015
-// Last modified 20/03/2015
+// Last modified 19/10/2026
+// 19/10/2026 - median() finds the middle element by quickselect rather than sorting, and streaming statistics have been added
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -35,19 +36,17 @@ double median(double* array, int size) {
   assert(array != NULL);
   assert(size > 0);
 
-  double* sortedarray = (double*)malloc(sizeof(double)*size);
+  double* copyarray = (double*)malloc(sizeof(double)*size);
+  assert(copyarray != NULL);
   
   int i;
   for (i = 0; i < size; i++) {
-    sortedarray[i] = array[i];
+    copyarray[i] = array[i];
   }
 
-  qsort(sortedarray, size, sizeof(double), compare);
-  
-  int halfpos = (int)floor(size/((double)2));
-  double median = sortedarray[halfpos];
+  double median = selectMedian(copyarray, size);
 
-  free(sortedarray);
+  free(copyarray);
 
   return median;
 
@@ -123,3 +122,99 @@ int compare(const void * a, const void * b) {
   return 0;
 }
 
+
+double selectMedian(double* array, int size) {
+
+  assert(array != NULL);
+  assert(size > 0);
+
+  int target = size/2;
+  int low = 0;
+  int high = size - 1;
+  double swap;
+
+  // Hoare partitioning around a median-of-three pivot, keeping only the side holding the target
+  while (high > low) {
+
+    int middle = low + (high - low)/2;
+    if (array[middle] < array[low]) {
+      swap = array[middle]; array[middle] = array[low]; array[low] = swap;
+    }
+    if (array[high] < array[low]) {
+      swap = array[high]; array[high] = array[low]; array[low] = swap;
+    }
+    if (array[high] < array[middle]) {
+      swap = array[high]; array[high] = array[middle]; array[middle] = swap;
+    }
+    double pivot = array[middle];
+
+    int i = low;
+    int j = high;
+    while (i <= j) {
+      while (array[i] < pivot) {
+	i++;
+      }
+      while (array[j] > pivot) {
+	j--;
+      }
+      if (i <= j) {
+	swap = array[i]; array[i] = array[j]; array[j] = swap;
+	i++;
+	j--;
+      }
+    }
+
+    // everything in [low, j] is <= pivot, everything in [i, high] is >= pivot, and anything between equals the pivot
+    if (target <= j) {
+      high = j;
+    } else if (target >= i) {
+      low = i;
+    } else {
+      return array[target];
+    }
+  }
+
+  return array[target];
+
+}
+
+void resetStreamStats(streamStats* stats) {
+
+  assert(stats != NULL);
+
+  stats->count = 0;
+  stats->mean = 0;
+  stats->m2 = 0;
+  stats->min = HUGE_VAL;
+  stats->max = -HUGE_VAL;
+
+  return;
+
+}
+
+void addStreamValue(streamStats* stats, double value) {
+
+  stats->count++;
+  double delta = value - stats->mean;
+  stats->mean = stats->mean + delta/stats->count;
+  stats->m2 = stats->m2 + delta*(value - stats->mean);
+
+  if (value < stats->min) {
+    stats->min = value;
+  }
+  if (value > stats->max) {
+    stats->max = value;
+  }
+
+  return;
+
+}
+
+double streamStddev(streamStats* stats) {
+
+  assert(stats != NULL);
+  assert(stats->count > 0);
+
+  return sqrt(stats->m2/((double)stats->count));
+
+}
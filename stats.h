@@ -1,8 +1,9 @@
 // Header for array statistics package
 // Andrew Cameron, MPIFR, 20/03/2015
-// Last modified 20/03/2015
+// Last modified 19/10/2026
 
 // Changelog
+// 19/10/2026 - Added streamStats for single pass (Welford) statistics, and selectMedian() - median() now uses selection rather than a full sort
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -10,6 +11,17 @@
 #ifndef STATS_H
 #define STATS_H
 
+// ***** DATA TYPES *****
+
+// running statistics of a stream of values, updated one value at a time (Welford's method for the variance)
+typedef struct streamStats {
+  long count;
+  double mean;
+  double m2; // sum of squared differences from the running mean
+  double min;
+  double max;
+} streamStats;
+
 // ***** FUNCTION PROTOTYPES *****
 
 // return the mean of an array
@@ -30,4 +42,17 @@ double min(double* array, int size);
 // for use in qsort
 int compare(const void * a, const void * b);
 
+// returns the median of an array as median() does (the element at size/2, rounded down, once sorted), by quickselect in O(size)
+// WARNING: reorders the array in place - pass a copy if the order matters
+double selectMedian(double* array, int size);
+
+// empties a set of running statistics
+void resetStreamStats(streamStats* stats);
+
+// adds a value to a set of running statistics
+void addStreamValue(streamStats* stats, double value);
+
+// returns the standard deviation of the values added so far (normalised by the count, as stddev() is)
+double streamStddev(streamStats* stats);
+
 #endif /* STATS_H */
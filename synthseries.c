@@ -0,0 +1,345 @@
+// C file for generating synthetic time series in chunks
+// Andrew Cameron, MPIFR, 19/10/2026
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <assert.h>
+#include "synthseries.h"
+#include "profilegen.h"
+
+// samples generated at a time within a chunk - the red noise innovations for them are drawn into a buffer this size
+#define SYNTH_BLOCK 4096
+
+// longest line accepted from a spec file
+#define SPEC_LINE_SIZE 1024
+
+synthSeries* createSynthSeries(void) {
+
+  synthSeries* series = (synthSeries*)malloc(sizeof(synthSeries));
+  assert(series != NULL);
+
+  series->samples = 1L << 20;
+  series->position = 0;
+  series->seed_flag = FALSE;
+  series->seed = 0;
+  series->mean = 0;
+  series->white = 1;
+  series->red = 0;
+  series->redindex = 1;
+  series->redcutoff = 0;
+  series->npulsars = 0;
+  series->capacity = 0;
+  series->pulsars = NULL;
+  series->npoles = 0;
+  series->poles = NULL;
+  series->gains = NULL;
+  series->redstate = NULL;
+
+  return series;
+}
+
+void deleteSynthSeries(synthSeries* series) {
+
+  assert(series != NULL);
+
+  int i;
+  for (i = 0; i < series->npulsars; i++) {
+    free(series->pulsars[i].cumulative);
+  }
+  free(series->pulsars);
+  free(series->poles);
+  free(series->gains);
+  free(series->redstate);
+  free(series);
+
+  return;
+}
+
+void readSynthSpec(synthSeries* series, FILE* specfile) {
+
+  assert(series != NULL);
+  assert(specfile != NULL);
+
+  char line[SPEC_LINE_SIZE];
+  char keyword[SPEC_LINE_SIZE];
+  int linenumber = 0;
+
+  while (fgets(line, SPEC_LINE_SIZE, specfile) != NULL) {
+
+    linenumber++;
+    if ((sscanf(line, "%s", keyword) != 1) || (keyword[0] == '#')) {
+      continue;
+    }
+
+    int valid = TRUE;
+    if (strcmp(keyword, "samples") == 0) {
+      valid = (sscanf(line, "%*s %ld", &series->samples) == 1) && (series->samples > 0);
+    } else if (strcmp(keyword, "seed") == 0) {
+      unsigned long long seed;
+      valid = (sscanf(line, "%*s %llu", &seed) == 1);
+      series->seed = seed;
+      series->seed_flag = TRUE;
+    } else if (strcmp(keyword, "mean") == 0) {
+      valid = (sscanf(line, "%*s %lf", &series->mean) == 1);
+    } else if (strcmp(keyword, "white") == 0) {
+      valid = (sscanf(line, "%*s %lf", &series->white) == 1) && (series->white >= 0);
+    } else if (strcmp(keyword, "red") == 0) {
+      int fields = sscanf(line, "%*s %lf %lf %lf", &series->red, &series->redindex, &series->redcutoff);
+      valid = (fields >= 2) && (series->red >= 0) && (series->redindex > 0) && (series->redindex < 2) && (series->redcutoff >= 0);
+    } else if (strcmp(keyword, "pulsar") == 0) {
+      double period, dc, height;
+      int shape = TOP_HAT;
+      double scatter = 0;
+      double phase = 0;
+      int fields = sscanf(line, "%*s %lf %lf %lf %d %lf %lf", &period, &dc, &height, &shape, &scatter, &phase);
+      valid = (fields >= 3) && (period >= 2) && (dc > 0) && (dc < 100) && ((shape == TOP_HAT) || (shape == GAUSSIAN)) && (scatter >= 0);
+      if (valid == TRUE) {
+	addSynthPulsar(series, period, dc, height, shape, scatter, phase);
+      }
+    } else {
+      printf("ERROR: Unknown directive (%s) on line %d of the series spec.\n", keyword, linenumber);
+      exit(0);
+    }
+
+    if (valid == FALSE) {
+      printf("ERROR: Invalid %s directive on line %d of the series spec.\n", keyword, linenumber);
+      exit(0);
+    }
+  }
+
+  return;
+}
+
+void addSynthPulsar(synthSeries* series, double period, double dc, double height, int shape, double scatter, double phase) {
+
+  assert(series != NULL);
+  assert(period >= 2);
+  assert(dc > 0 && dc < 100);
+  assert(scatter >= 0);
+
+  if (series->npulsars == series->capacity) {
+    series->capacity = (series->capacity == 0) ? 4 : 2*series->capacity;
+    series->pulsars = (synthPulsar*)realloc(series->pulsars, sizeof(synthPulsar)*series->capacity);
+    assert(series->pulsars != NULL);
+  }
+
+  synthPulsar* pulsar = &series->pulsars[series->npulsars];
+  pulsar->period = period;
+  pulsar->dc = dc;
+  pulsar->height = height;
+  pulsar->shape = shape;
+  pulsar->scatter = scatter;
+  pulsar->phase = phase - floor(phase);
+  pulsar->bins = 0;
+  pulsar->cumulative = NULL;
+  series->npulsars++;
+
+  return;
+}
+
+// builds the template of a pulsar - its PROGENY profile at a few bins per sample, stored as a running integral so that
+// each time series sample can take the average of the profile across the phase range it covers
+static void buildSynthTemplate(synthPulsar* pulsar) {
+
+  int bins = 4*(int)ceil(pulsar->period);
+  if (bins < SYNTH_TEMPLATE_MIN) {
+    bins = SYNTH_TEMPLATE_MIN;
+  } else if (bins > SYNTH_TEMPLATE_MAX) {
+    bins = SYNTH_TEMPLATE_MAX;
+  }
+
+  double* template = (double*)malloc(sizeof(double) * bins);
+  double* work = (double*)malloc(sizeof(double) * profileWorkSize(bins));
+  assert(template != NULL && work != NULL);
+
+  pulseComponent component;
+  component.shape = pulsar->shape;
+  component.height = pulsar->height;
+  component.width = bins * (pulsar->dc / 100);
+  component.center = 0;
+  buildProfile(template, bins, &component, 1, pulsar->scatter * bins / pulsar->period, work);
+
+  free(pulsar->cumulative);
+  pulsar->cumulative = (double*)malloc(sizeof(double) * (bins + 1));
+  assert(pulsar->cumulative != NULL);
+
+  int i;
+  pulsar->cumulative[0] = 0;
+  for (i = 0; i < bins; i++) {
+    pulsar->cumulative[i + 1] = pulsar->cumulative[i] + template[i] / bins;
+  }
+  pulsar->bins = bins;
+
+  free(template);
+  free(work);
+
+  return;
+}
+
+// integral of a pulsar's template from phase 0 to phase (0 <= phase <= 1)
+static inline double templateIntegral(synthPulsar* pulsar, double phase) {
+
+  double x = phase * pulsar->bins;
+  int bin = (int)x;
+  if (bin >= pulsar->bins) {
+    bin = pulsar->bins - 1;
+  }
+
+  return pulsar->cumulative[bin] + (x - bin) * (pulsar->cumulative[bin + 1] - pulsar->cumulative[bin]);
+}
+
+// sets up the red noise filter bank
+// a first order filter with time constant tau has a Lorentzian power spectrum, flat below 1 / (2 pi tau) and falling as f^-2 above it
+// driving filters with time constants spaced evenly in log from 1 sample to the cutoff from the same white noise, with low frequency
+// gains proportional to tau^(index/2), gives an amplitude spectrum ~ f^(-index/2) between the two, i.e. power ~ f^-index
+// the gains are finally scaled so that the red noise has the requested RMS
+static void buildRedBank(synthSeries* series) {
+
+  double cutoff = (series->redcutoff > 0) ? series->redcutoff : (double)series->samples;
+  if (cutoff < 1) {
+    cutoff = 1;
+  }
+
+  series->npoles = (int)ceil(log10(cutoff) * RED_POLES_PER_DECADE) + 1;
+  free(series->poles);
+  free(series->gains);
+  free(series->redstate);
+  series->poles = (double*)malloc(sizeof(double) * series->npoles);
+  series->gains = (double*)malloc(sizeof(double) * series->npoles);
+  series->redstate = (double*)malloc(sizeof(double) * series->npoles);
+  assert(series->poles != NULL && series->gains != NULL && series->redstate != NULL);
+
+  int i, j;
+  for (i = 0; i < series->npoles; i++) {
+    double tau = pow(10, (double)i / RED_POLES_PER_DECADE);
+    series->poles[i] = exp(-1/tau);
+    series->gains[i] = pow(tau, series->redindex / 2) * (1 - series->poles[i]);
+  }
+
+  // variance of the summed filter outputs, including the correlation between filters sharing the same input
+  double variance = 0;
+  for (i = 0; i < series->npoles; i++) {
+    for (j = 0; j < series->npoles; j++) {
+      variance = variance + series->gains[i] * series->gains[j] / (1 - series->poles[i] * series->poles[j]);
+    }
+  }
+
+  double scale = series->red / sqrt(variance);
+  for (i = 0; i < series->npoles; i++) {
+    series->gains[i] = series->gains[i] * scale;
+  }
+
+  return;
+}
+
+void startSynthSeries(synthSeries* series) {
+
+  assert(series != NULL);
+
+  int i;
+
+  if (series->seed_flag == FALSE) {
+    series->seed = (uint64_t)time(NULL);
+    series->seed_flag = TRUE;
+  }
+
+  // white and red noise come from separate streams, so each is drawn in sample order however the series is split into chunks
+  seedNoiseStream(&series->whitestream, series->seed);
+  splitNoiseStream(&series->whitestream, &series->redstream);
+
+  for (i = 0; i < series->npulsars; i++) {
+    buildSynthTemplate(&series->pulsars[i]);
+  }
+
+  if (series->red > 0) {
+    buildRedBank(series);
+
+    // start the filters from their long term spread rather than from zero, so there is no settling at the start of the series
+    // the filters share their input and so are close to fully correlated - they are started from a single draw
+    double draw = noiseGaussian(&series->redstream);
+    for (i = 0; i < series->npoles; i++) {
+      series->redstate[i] = draw * series->gains[i] / sqrt(1 - series->poles[i] * series->poles[i]);
+    }
+  } else {
+    series->npoles = 0;
+  }
+
+  series->position = 0;
+
+  return;
+}
+
+long nextSynthChunk(synthSeries* series, double* buffer, long size) {
+
+  assert(series != NULL);
+  assert(buffer != NULL);
+  assert(size >= 0);
+
+  if (size > series->samples - series->position) {
+    size = series->samples - series->position;
+  }
+
+  double innovations[SYNTH_BLOCK];
+  long done = 0;
+  long i;
+  int k;
+
+  while (done < size) {
+
+    long count = (size - done < SYNTH_BLOCK) ? size - done : SYNTH_BLOCK;
+    double* block = &buffer[done];
+    long first = series->position + done;
+
+    // white noise and mean
+    if (series->white > 0) {
+      fillGaussianNoise(&series->whitestream, block, count, series->white, series->mean);
+    } else {
+      for (i = 0; i < count; i++) {
+	block[i] = series->mean;
+      }
+    }
+
+    // red noise - each filter runs across the whole block in turn
+    if (series->npoles > 0) {
+      fillGaussianNoise(&series->redstream, innovations, count, 1, 0);
+      for (k = 0; k < series->npoles; k++) {
+	double state = series->redstate[k];
+	double pole = series->poles[k];
+	double gain = series->gains[k];
+	for (i = 0; i < count; i++) {
+	  state = pole * state + gain * innovations[i];
+	  block[i] = block[i] + state;
+	}
+	series->redstate[k] = state;
+      }
+    }
+
+    // pulsars - each sample is the average of the template over the phase range it covers
+    for (k = 0; k < series->npulsars; k++) {
+      synthPulsar* pulsar = &series->pulsars[k];
+      double step = 1 / pulsar->period;
+      double whole = pulsar->cumulative[pulsar->bins];
+      for (i = 0; i < count; i++) {
+	double start = (double)(first + i) / pulsar->period + pulsar->phase;
+	start = start - floor(start);
+	double end = start + step;
+	double integral;
+	if (end < 1) {
+	  integral = templateIntegral(pulsar, end) - templateIntegral(pulsar, start);
+	} else {
+	  integral = whole + templateIntegral(pulsar, end - 1) - templateIntegral(pulsar, start);
+	}
+	block[i] = block[i] + integral * pulsar->period;
+      }
+    }
+
+    done = done + count;
+  }
+
+  series->position = series->position + size;
+
+  return size;
+}
@@ -0,0 +1,92 @@
+// Header for generating synthetic time series in chunks
+// Andrew Cameron, MPIFR, 19/10/2026
+
+// A synthSeries describes a time series of white noise, power-law red noise and any number of pulsars, and generates it a chunk at a time,
+// so that series of any length can be written out or handed to the FFA without ever being held in full
+// The same description and seed always give the same series, whatever the chunk sizes used to generate it
+
+// Descriptions can be read from a spec file of one directive per line (blank lines and lines starting with '#' are ignored):
+//   samples [long]                                       length of the series (default 2^20)
+//   seed [int]                                           seed for all noise (default = current time)
+//   mean [double]                                        constant offset of the series (default 0)
+//   white [double]                                       RMS of the white noise (default 1)
+//   red [rms] [index] (cutoff)                           red noise with power spectrum ~ f^-index (0 < index < 2), flattening below
+//                                                        1 / cutoff samples (default cutoff = series length)
+//   pulsar [period] [dc] [height] (shape) (scatter) (phase)
+//                                                        pulsar with a period of any (fractional) number of samples, duty cycle in percent
+//                                                        and peak height, using the PROGENY pulse shapes (1 = top hat (default), 2 = Gaussian),
+//                                                        scattering time in samples (default 0) and pulse phase at the first sample (default 0)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "whitenoise.h"
+
+#ifndef SYNTHSERIES_H
+#define SYNTHSERIES_H
+
+#define TRUE 1
+#define FALSE 0
+
+// red noise filter bank - first order filters with time constants from 1 sample to the cutoff, this many per decade
+#define RED_POLES_PER_DECADE 4
+
+// limits on the number of bins per period in a pulsar's template profile
+#define SYNTH_TEMPLATE_MIN 256
+#define SYNTH_TEMPLATE_MAX 65536
+
+// ***** DATA TYPES *****
+
+typedef struct synthPulsar {
+  double period; // in samples
+  double dc; // duty cycle (percent)
+  double height;
+  int shape;
+  double scatter; // in samples
+  double phase;
+  int bins; // resolution of the template
+  double* cumulative; // bins + 1 elements - integral of the template profile from phase 0, with the whole period summing to cumulative[bins]
+} synthPulsar;
+
+typedef struct synthSeries {
+  long samples;
+  long position; // next sample to be generated
+  int seed_flag; // FALSE until a seed is set, in which case the current time is used
+  uint64_t seed;
+  double mean;
+  double white;
+  double red;
+  double redindex;
+  double redcutoff; // 0 = series length
+  int npulsars;
+  int capacity;
+  synthPulsar* pulsars;
+  int npoles;
+  double* poles; // per sample decay of each red noise filter
+  double* gains; // gain of each filter
+  double* redstate;
+  noiseStream whitestream;
+  noiseStream redstream;
+} synthSeries;
+
+// ***** FUNCTION PROTOTYPES *****
+
+// creates a series description with the defaults above (white noise only) - free with deleteSynthSeries()
+synthSeries* createSynthSeries(void);
+
+// cleans up a series and everything it owns
+void deleteSynthSeries(synthSeries* series);
+
+// reads a spec file (see above) into a series description - exits on an invalid spec
+void readSynthSpec(synthSeries* series, FILE* specfile);
+
+// adds a pulsar to a series
+void addSynthPulsar(synthSeries* series, double period, double dc, double height, int shape, double scatter, double phase);
+
+// prepares a series for generation (or starts it again from the beginning) - call after the description is complete
+void startSynthSeries(synthSeries* series);
+
+// generates the next samples of a series into buffer, up to size of them, and returns the number generated (0 once the series is complete)
+long nextSynthChunk(synthSeries* series, double* buffer, long size);
+
+#endif /* SYNTHSERIES_H */
@@ -2,44 +2,218 @@
 // Andrew Cameron, MPIFR, 19/12/2014
 // Last updated - 19/09/2016 - Removed unauthorised code and replaced with code released under Wikipedia Creative Commons
 // http://creativecommons.org/licenses/by-sa/3.0/ (applies to generateWhiteNoise)
+// Last updated - 19/10/2026 - Replaced rand() and Box-Muller with xoshiro256** streams (Blackman & Vigna) and a 128 layer ziggurat (Marsaglia & Tsang 2000)
+//                           - The Box-Muller code referred to above is no longer used
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
 #include <time.h>
+#include <pthread.h>
 #include "whitenoise.h"
-#include <float.h>
-#include <stdbool.h>
 
-#define MY_PI 3.14159265358979323846264
+// ziggurat tables - layer boundaries (kn), widths (wn) and density values (fn) for 128 layers of the standard normal
+#define ZIGGURAT_LAYERS 128
+#define ZIGGURAT_R 3.442619855899
+#define ZIGGURAT_AREA 9.91256303526217e-3
+
+static uint32_t kn[ZIGGURAT_LAYERS];
+static double wn[ZIGGURAT_LAYERS];
+static double fn[ZIGGURAT_LAYERS];
+static pthread_once_t ziggurat_once = PTHREAD_ONCE_INIT;
+
+// the stream behind startseed() and generateWhiteNoise() - seeded with 1 until told otherwise, as rand() was
+static noiseStream defaultstream;
+static int defaultseeded = 0;
+
+static inline uint64_t rotl(const uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+// splitmix64 - spreads a single seed across the stream state
+static uint64_t splitmix64(uint64_t* x) {
+
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+  return z ^ (z >> 31);
+}
+
+static void buildZiggurat(void) {
+
+  double dn = ZIGGURAT_R;
+  double tn = dn;
+  double q = ZIGGURAT_AREA/exp(-0.5*dn*dn);
+  const double m1 = 2147483648.0;
+  int i;
+
+  kn[0] = (uint32_t)((dn/q)*m1);
+  kn[1] = 0;
+  wn[0] = q/m1;
+  wn[ZIGGURAT_LAYERS - 1] = dn/m1;
+  fn[0] = 1.0;
+  fn[ZIGGURAT_LAYERS - 1] = exp(-0.5*dn*dn);
+
+  for (i = ZIGGURAT_LAYERS - 2; i >= 1; i--) {
+    dn = sqrt(-2.0*log(ZIGGURAT_AREA/dn + exp(-0.5*dn*dn)));
+    kn[i + 1] = (uint32_t)((dn/tn)*m1);
+    tn = dn;
+    fn[i] = exp(-0.5*dn*dn);
+    wn[i] = dn/m1;
+  }
+
+  return;
+}
+
+void seedNoiseStream(noiseStream* stream, uint64_t seed) {
+
+  assert(stream != NULL);
+
+  int i;
+  for (i = 0; i < 4; i++) {
+    stream->state[i] = splitmix64(&seed);
+  }
+
+  pthread_once(&ziggurat_once, buildZiggurat);
+
+  return;
+}
+
+uint64_t noiseBits(noiseStream* stream) {
+
+  uint64_t* s = stream->state;
+  const uint64_t result = rotl(s[1] * 5, 7) * 9;
+  const uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+
+  return result;
+}
+
+void jumpNoiseStream(noiseStream* stream) {
+
+  assert(stream != NULL);
+
+  static const uint64_t jump[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+  uint64_t s[4] = {0, 0, 0, 0};
+  int i, b;
+
+  for (i = 0; i < 4; i++) {
+    for (b = 0; b < 64; b++) {
+      if (jump[i] & ((uint64_t)1 << b)) {
+	s[0] ^= stream->state[0];
+	s[1] ^= stream->state[1];
+	s[2] ^= stream->state[2];
+	s[3] ^= stream->state[3];
+      }
+      noiseBits(stream);
+    }
+  }
+
+  for (i = 0; i < 4; i++) {
+    stream->state[i] = s[i];
+  }
+
+  return;
+}
+
+void splitNoiseStream(noiseStream* parent, noiseStream* child) {
+
+  assert(parent != NULL);
+  assert(child != NULL);
+
+  *child = *parent;
+  jumpNoiseStream(parent);
+
+  return;
+}
+
+double noiseUniform(noiseStream* stream) {
+
+  // the top 53 bits, offset by half a step so that neither 0 nor 1 can be returned
+  return ((double)(noiseBits(stream) >> 11) + 0.5) * (1.0/9007199254740992.0);
+}
+
+// the slow path of the ziggurat, taken for about 1 draw in 100 - hz is the signed 32 bit draw that landed outside the rectangle of its layer iz
+static double zigguratTail(noiseStream* stream, int32_t hz, int iz) {
+
+  double x, y;
+
+  while (1) {
+    x = hz*wn[iz];
+    if (iz == 0) {
+      // base layer - sample the tail beyond ZIGGURAT_R directly
+      do {
+	x = -log(noiseUniform(stream))/ZIGGURAT_R;
+	y = -log(noiseUniform(stream));
+      } while (y + y < x*x);
+      return (hz > 0) ? ZIGGURAT_R + x : -ZIGGURAT_R - x;
+    }
+    if (fn[iz] + noiseUniform(stream)*(fn[iz - 1] - fn[iz]) < exp(-0.5*x*x)) {
+      return x;
+    }
+    // rejected - start again with a fresh draw
+    hz = (int32_t)(noiseBits(stream) >> 32);
+    iz = hz & (ZIGGURAT_LAYERS - 1);
+    if ((uint32_t)llabs((long long)hz) < kn[iz]) {
+      return hz*wn[iz];
+    }
+  }
+}
+
+double noiseGaussian(noiseStream* stream) {
+
+  int32_t hz = (int32_t)(noiseBits(stream) >> 32);
+  int iz = hz & (ZIGGURAT_LAYERS - 1);
+
+  if ((uint32_t)llabs((long long)hz) < kn[iz]) {
+    return hz*wn[iz];
+  }
+
+  return zigguratTail(stream, hz, iz);
+}
+
+void fillGaussianNoise(noiseStream* stream, double* buffer, long size, double sigma, double mu) {
+
+  assert(stream != NULL);
+  assert(buffer != NULL);
+
+  long i;
+  for (i = 0; i < size; i++) {
+    buffer[i] = noiseGaussian(stream)*sigma + mu;
+  }
+
+  return;
+}
 
 void startseed(void) {
 
-  // simply seed using current time and srand
-  srand(time(NULL));
+  // seed using the current time, as srand(time(NULL)) used to
+  seedWhiteNoise((uint64_t)time(NULL));
 
   return; 
 }
 
+void seedWhiteNoise(uint64_t seed) {
+
+  seedNoiseStream(&defaultstream, seed);
+  defaultseeded = 1;
+
+  return;
+}
+
 double generateWhiteNoise(double sigma, double mu) {
-  
-  static double z0, z1;
-  static bool generate;
-  generate = !generate;
-
-  if (!generate)
-    return z1 * sigma + mu;
-  
-  double u1, u2;
-  do
-    {
-      u1 = rand() * (1.0 / RAND_MAX);
-      u2 = rand() * (1.0 / RAND_MAX);
-    }
-  while ( u1 <= DBL_MIN );
-  
-  z0 = sqrt(-2.0 * log(u1)) * cos(MY_PI*2 * u2);
-  z1 = sqrt(-2.0 * log(u1)) * sin(MY_PI*2 * u2);
-  return z0 * sigma + mu; 
+
+  if (!defaultseeded) {
+    seedWhiteNoise(1);
+  }
+
+  return noiseGaussian(&defaultstream)*sigma + mu;
 }
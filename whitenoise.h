@@ -1,17 +1,54 @@
 // White noise generation package
 // Andrew Cameron, MPIFR, 19/12/2014
+// Last updated - 19/10/2026 - Added independent random number streams (xoshiro256**) and a ziggurat normal sampler
+//                             startseed() and generateWhiteNoise() now draw from a shared default stream
 
+#include <stdint.h>
 
 #ifndef WHITENOISE_H
 #define WHITENOISE_H
 
+// ***** DATA TYPES *****
+
+// A noiseStream is one independent sequence of random numbers (xoshiro256**, period 2^256 - 1)
+// Streams are cheap to copy and are never shared behind the scenes, so each thread can draw from its own without locking
+// For reproducible parallel runs, seed one stream and hand each thread a stream split off from it with splitNoiseStream()
+typedef struct noiseStream {
+  uint64_t state[4];
+} noiseStream;
+
 // ***** FUNCTION PROTOTYPES *****
 
-// seed random number generation process
+// seeds a stream - the same seed always gives the same sequence
+void seedNoiseStream(noiseStream* stream, uint64_t seed);
+
+// advances a stream by 2^128 draws - streams a jump apart never overlap in practice
+void jumpNoiseStream(noiseStream* stream);
+
+// makes child a copy of parent, then jumps parent on, so that repeated splits give a series of non-overlapping streams
+void splitNoiseStream(noiseStream* parent, noiseStream* child);
+
+// returns the next 64 random bits of a stream
+uint64_t noiseBits(noiseStream* stream);
+
+// returns a uniform deviate in the open interval (0, 1)
+double noiseUniform(noiseStream* stream);
+
+// returns a standard normal deviate (ziggurat method, Marsaglia & Tsang 2000)
+double noiseGaussian(noiseStream* stream);
+
+// fills size elements of buffer with normal deviates of the given standard deviation (sigma) and mean (mu)
+void fillGaussianNoise(noiseStream* stream, double* buffer, long size, double sigma, double mu);
+
+// seed random number generation process (the default stream) from the current time
 void startseed(void);
 
+// seed the default stream with a fixed value, for repeatable runs
+void seedWhiteNoise(uint64_t seed);
+
 // WRAPPER FUNCTIONS
 
+// returns a normal deviate from the default stream - not for use by several threads at once (give each thread its own noiseStream instead)
 double generateWhiteNoise(double sigma, double mu);
 
 #endif /* WHITENOISE_H */